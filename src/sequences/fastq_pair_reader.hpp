@@ -0,0 +1,293 @@
+#ifndef FASTQ_PAIR_READER_HPP
+#define FASTQ_PAIR_READER_HPP
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "sequences/gttl_fastq_generator.hpp"
+
+/* A batch of consecutive FASTQ entries. To avoid an allocation per
+   entry, the headers, sequences and qualities are stored in
+   three strings and accessed via their end positions. */
+
+class GttlFastQBatch
+{
+  std::string headers, sequences, qualities;
+  std::vector<size_t> header_ends, sequence_ends, quality_ends;
+
+  static std::string_view component(const std::string &concatenated,
+                                    const std::vector<size_t> &ends,
+                                    size_t idx)
+  {
+    assert(idx < ends.size());
+    const size_t start = idx == 0 ? 0 : ends[idx - 1];
+    return std::string_view(concatenated).substr(start, ends[idx] - start);
+  }
+
+  public:
+  GttlFastQBatch(void) = default;
+
+  void clear(void) noexcept
+  {
+    headers.clear();
+    sequences.clear();
+    qualities.clear();
+    header_ends.clear();
+    sequence_ends.clear();
+    quality_ends.clear();
+  }
+
+  void append(std::string_view header, std::string_view sequence,
+              std::string_view quality)
+  {
+    headers += header;
+    header_ends.push_back(headers.size());
+    sequences += sequence;
+    sequence_ends.push_back(sequences.size());
+    qualities += quality;
+    quality_ends.push_back(qualities.size());
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return header_ends.size();
+  }
+
+  [[nodiscard]] std::string_view header_get(size_t idx) const noexcept
+  {
+    return component(headers, header_ends, idx);
+  }
+
+  [[nodiscard]] std::string_view sequence_get(size_t idx) const noexcept
+  {
+    return component(sequences, sequence_ends, idx);
+  }
+
+  [[nodiscard]] std::string_view quality_get(size_t idx) const noexcept
+  {
+    return component(qualities, quality_ends, idx);
+  }
+};
+
+/* A bounded channel of batches from one producer thread parsing a
+   FASTQ file to one consumer thread. Processed batches are handed back
+   to the producer, so that the memory of the batches is reused. */
+
+class GttlFastQBatchChannel
+{
+  std::mutex channel_mutex;
+  std::condition_variable cv_filled, cv_free;
+  std::deque<GttlFastQBatch> filled, free_batches;
+  size_t capacity;
+  size_t in_use; /* number of batches filled or being filled */
+  bool closed, aborted;
+  std::exception_ptr error;
+
+  public:
+  explicit GttlFastQBatchChannel(size_t _capacity)
+    : capacity(_capacity)
+    , in_use(0)
+    , closed(false)
+    , aborted(false)
+    , error(nullptr)
+  {
+    assert(capacity > 0);
+  }
+
+  /* waits until a batch may be filled. Returns false if the consumer
+     has aborted */
+  bool get_free(GttlFastQBatch *batch)
+  {
+    std::unique_lock<std::mutex> lock(channel_mutex);
+    cv_free.wait(lock, [this] { return aborted or in_use < capacity; });
+    if (aborted)
+    {
+      return false;
+    }
+    in_use++;
+    if (free_batches.empty())
+    {
+      batch->clear();
+    } else
+    {
+      *batch = std::move(free_batches.front());
+      free_batches.pop_front();
+      batch->clear();
+    }
+    return true;
+  }
+
+  void push(GttlFastQBatch &&batch)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(channel_mutex);
+      filled.push_back(std::move(batch));
+    }
+    cv_filled.notify_one();
+  }
+
+  /* called by the producer when the file is exhausted or an error
+     occurred; the latter is rethrown by pop */
+  void close(std::exception_ptr _error = nullptr)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(channel_mutex);
+      closed = true;
+      error = _error;
+    }
+    cv_filled.notify_one();
+  }
+
+  /* waits for the next batch. Returns false if there is no more batch. */
+  bool pop(GttlFastQBatch *batch)
+  {
+    std::unique_lock<std::mutex> lock(channel_mutex);
+    cv_filled.wait(lock, [this] { return closed or not filled.empty(); });
+    if (not filled.empty())
+    {
+      *batch = std::move(filled.front());
+      filled.pop_front();
+      return true;
+    }
+    if (error != nullptr)
+    {
+      std::rethrow_exception(error);
+    }
+    return false;
+  }
+
+  void recycle(GttlFastQBatch &&batch)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(channel_mutex);
+      free_batches.push_back(std::move(batch));
+      assert(in_use > 0);
+      in_use--;
+    }
+    cv_free.notify_one();
+  }
+
+  void abort(void)
+  {
+    {
+      const std::lock_guard<std::mutex> lock(channel_mutex);
+      aborted = true;
+    }
+    cv_free.notify_all();
+  }
+};
+
+/* Reads two FASTQ files of read pairs concurrently: each file is parsed
+   by its own thread into batches of batch_size entries, while the
+   calling thread receives pairs of corresponding batches and calls
+   process_pair(entry_idx, batch0, batch1) for each pair of
+   entries, in the order of the files. At most queue_capacity batches
+   per file are buffered. If one file contains more entries than the
+   other, a std::runtime_error is thrown after all pairs have been
+   processed, like for reading the files in lockstep.
+   Errors occurring when parsing a file are rethrown in the calling
+   thread. */
+
+template<size_t buf_size,bool store_quality,class PairProcessor>
+static void gttl_fastq_pairs_read(const std::string &inputfile0,
+                                  const std::string &inputfile1,
+                                  PairProcessor process_pair,
+                                  size_t batch_size = size_t(1) << 12,
+                                  size_t queue_capacity = 4)
+{
+  assert(batch_size > 0);
+  GttlFastQBatchChannel channel0(queue_capacity), channel1(queue_capacity);
+  auto produce = [batch_size](const std::string &inputfile,
+                              GttlFastQBatchChannel *channel)
+  {
+    try
+    {
+      GttlFastQGenerator<buf_size,store_quality> fastq_it(inputfile.c_str());
+      auto it = fastq_it.begin();
+      while (it != fastq_it.end())
+      {
+        GttlFastQBatch batch{};
+        if (not channel->get_free(&batch))
+        {
+          return;
+        }
+        for (size_t idx = 0; idx < batch_size and it != fastq_it.end();
+             idx++, ++it)
+        {
+          batch.append((*it)->header_get(), (*it)->sequence_get(),
+                       (*it)->quality_get());
+        }
+        channel->push(std::move(batch));
+      }
+      channel->close();
+    }
+    catch (...)
+    {
+      channel->close(std::current_exception());
+    }
+  };
+  std::thread reader0(produce, std::cref(inputfile0), &channel0);
+  std::thread reader1(produce, std::cref(inputfile1), &channel1);
+  bool fst_more = false, snd_more = false;
+  std::exception_ptr error = nullptr;
+  try
+  {
+    GttlFastQBatch batch0{}, batch1{};
+    while (true)
+    {
+      const bool has0 = channel0.pop(&batch0);
+      const bool has1 = channel1.pop(&batch1);
+      if (not has0 or not has1)
+      {
+        fst_more = has0;
+        snd_more = has1;
+        break;
+      }
+      const size_t common = std::min(batch0.size(), batch1.size());
+      for (size_t idx = 0; idx < common; idx++)
+      {
+        process_pair(idx, batch0, batch1);
+      }
+      if (batch0.size() != batch1.size())
+      {
+        fst_more = batch0.size() > batch1.size();
+        snd_more = not fst_more;
+        break;
+      }
+      channel0.recycle(std::move(batch0));
+      channel1.recycle(std::move(batch1));
+    }
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+  channel0.abort();
+  channel1.abort();
+  reader0.join();
+  reader1.join();
+  if (error != nullptr)
+  {
+    std::rethrow_exception(error);
+  }
+  if (fst_more or snd_more)
+  {
+    throw std::runtime_error(
+            std::format("processing readpair files {} and {}: {} file"
+                        " contains more sequences than {} file",
+                        inputfile0,
+                        inputfile1,
+                        fst_more ? "first" : "second",
+                        fst_more ? "second" : "first"));
+  }
+}
+#endif
@@ -39,7 +39,13 @@ struct GttlFastQEntry
   }
 };
 
-template <const size_t buf_size = (size_t{1} << size_t{14})>
+/* If store_quality is false, the quality lines are skipped without
+   copying them, so that quality_get() of the entries delivers an empty
+   string. This is appropriate for all applications which only process
+   the headers and sequences. */
+
+template <const size_t buf_size = (size_t{1} << size_t{14}),
+          bool store_quality = true>
 class GttlFastQGenerator
 {
   private:
@@ -76,7 +82,7 @@ class GttlFastQGenerator
                               bool _is_end = false)
     : out(_out)
     , is_end(_is_end)
-    , lg(gttl_fp_type_open(file_name, "rb"), _out->header, _is_end)
+    , lg(gttl_fp_type_open(file_name, "rb"), &_out->header, _is_end)
   { }
 
   explicit GttlFastQGenerator(GttlFpType fp,
@@ -84,7 +90,7 @@ class GttlFastQGenerator
                               bool _is_end = false)
     : out(_out)
     , is_end(_is_end)
-    , lg(fp, _out->header, _is_end)
+    , lg(fp, &_out->header, _is_end)
   { }
 
   explicit GttlFastQGenerator(const char* _input_string,
@@ -149,7 +155,10 @@ class GttlFastQGenerator
     lg.advance();
     lg.set_line_buffer(nullptr);
     lg.advance();
-    lg.set_line_buffer(&out->quality);
+    if constexpr (store_quality)
+    {
+      lg.set_line_buffer(&out->quality);
+    }
     return std::get<0>(lg.advance());
   }
 
@@ -22,6 +22,8 @@
 
 #include "sequences/gttl_fasta_generator.hpp"
 #include "sequences/gttl_fastq_generator.hpp"
+#include "sequences/fastq_pair_reader.hpp"
+#include "sequences/quality_store.hpp"
 #include "utilities/cycle_of_numbers.hpp"
 #include "sequences/complement_plain.hpp"
 
@@ -48,6 +50,8 @@ class GttlMultiseq
   const bool has_reverse_complement;
   std::map<size_t, size_t> length_dist_map;
   std::vector<std::pair<uint16_t, uint16_t>> short_header_cache;
+  bool has_quality_store{false};
+  GttlQualityStore quality_store{};
 
   void append_padding_char(uint8_t this_padding_char)
   {
@@ -68,6 +72,11 @@ class GttlMultiseq
            sequence_offsets.size() * sizeof(size_t));
     printf("Multiseq_size.concatenated_sequences=%zu\n",
            concatenated_sequences.size() * sizeof(char));
+    if (has_quality_store)
+    {
+      printf("Multiseq_size.quality_store=%zu\n",
+             quality_store.size_in_bytes());
+    }
   }
 
   [[nodiscard]] size_t size_in_bytes_extra(void) const noexcept
@@ -75,7 +84,8 @@ class GttlMultiseq
     return sizeof(GttlMultiseq) +
            sizeof(std::string) * header_vector.size() +
            header_total_length * sizeof(char) +
-           length_dist_map.size() * 2 * sizeof(size_t);
+           length_dist_map.size() * 2 * sizeof(size_t) +
+           (has_quality_store ? quality_store.size_in_bytes() : 0);
   }
 
   [[nodiscard]] size_t size_in_bytes_sequence(void) const noexcept
@@ -148,6 +158,34 @@ class GttlMultiseq
     return rc_seq;
   }
 
+  /* reads two FASTQ files in zipped order. Both files are parsed
+     concurrently by separate threads, while the entries are appended
+     in the order of the pairs. The quality lines are only copied if
+     the qualities are stored. */
+  template<int buf_size,bool store_quality>
+  void readpairs_reader(const std::vector<std::string> &inputfiles,
+                        bool store_header,
+                        bool store_sequence)
+  {
+    assert(inputfiles.size() == 2 and not has_reverse_complement);
+    gttl_fastq_pairs_read<buf_size,store_quality>(
+      inputfiles[0],
+      inputfiles[1],
+      [&](size_t idx,const GttlFastQBatch &batch0,
+          const GttlFastQBatch &batch1)
+      {
+        append(batch0.header_get(idx), batch0.sequence_get(idx),
+               store_header, store_sequence, padding_char);
+        append(batch1.header_get(idx), batch1.sequence_get(idx),
+               store_header, store_sequence, padding_char);
+        if constexpr (store_quality)
+        {
+          quality_store.append(batch0.quality_get(idx));
+          quality_store.append(batch1.quality_get(idx));
+        }
+      });
+  }
+
   /* This method is used for all constructors for which the inputfiles or the
      file pointer is provided with the constructor. */
   void multiseq_reader(const std::vector<std::string> &inputfiles,
@@ -162,33 +200,14 @@ class GttlMultiseq
     static constexpr const int buf_size = 1 << 14;
     if (zip_readpair_files)
     {
-      assert(inputfiles.size() == 2 and not has_reverse_complement);
-      GttlFastQGenerator<buf_size> fastq_it0(inputfiles[0].c_str());
-      GttlFastQGenerator<buf_size> fastq_it1(inputfiles[1].c_str());
-
-      GttlFastQGenerator<buf_size>::Iterator it0 = fastq_it0.begin();
-      GttlFastQGenerator<buf_size>::Iterator it1 = fastq_it1.begin();
-
-      while (it0 != fastq_it0.end() and it1 != fastq_it1.end())
+      if (has_quality_store)
       {
-        append((*it0)->header_get(), (*it0)->sequence_get(),
-               store_header, store_sequence, padding_char);
-        append((*it1)->header_get(), (*it1)->sequence_get(),
-               store_header, store_sequence, padding_char);
-        ++it0;
-        ++it1;
-      }
-      const bool fst_more = (it0 != fastq_it0.end() and it1 == fastq_it1.end());
-      const bool snd_more = (it0 == fastq_it0.end() and it1 != fastq_it1.end());
-      if (fst_more or snd_more)
+        readpairs_reader<buf_size,true>(inputfiles, store_header,
+                                        store_sequence);
+      } else
       {
-        throw std::runtime_error(
-                std::format("processing readpair files {} and {}: {} file"
-                            " contains more sequences than {} file",
-                            inputfiles[0],
-                            inputfiles[1],
-                            fst_more ? "first" : "second",
-                            fst_more ? "second" : "fist"));
+        readpairs_reader<buf_size,false>(inputfiles, store_header,
+                                         store_sequence);
       }
     } else
     {
@@ -294,15 +313,22 @@ class GttlMultiseq
                     zip_readpair_files);
   }
 
+  /* If store_quality is true, the qualities of the reads are kept
+     in a binned and run length encoded form, see GttlQualityStore,
+     which is accessible via quality_store_get(). */
   GttlMultiseq(const std::string &readpair_file1,
                const std::string &readpair_file2,
                bool store_header,
                bool store_sequence,
-               uint8_t _padding_char)
+               uint8_t _padding_char,
+               bool store_quality = false,
+               uint8_t phred_offset = 33)
     : padding_char(_padding_char)
     , has_constant_padding_char(true)
     , has_read_pairs(true)
     , has_reverse_complement(false) /* no reverse complement for read pairs */
+    , has_quality_store(store_quality)
+    , quality_store(phred_offset)
   {
     const std::vector<std::string> inputfiles{readpair_file1, readpair_file2};
     constexpr const bool zip_readpair_files = true;
@@ -517,6 +543,13 @@ class GttlMultiseq
                           static_cast<size_t>(sh_len));
   }
 
+  /* the store of the binned qualities, or nullptr if no qualities
+     are stored */
+  [[nodiscard]] const GttlQualityStore *quality_store_get(void) const noexcept
+  {
+    return has_quality_store ? &quality_store : nullptr;
+  }
+
   [[nodiscard]] std::vector<std::string> statistics() const noexcept
   {
     std::vector<std::string> log_vector;
@@ -532,6 +565,11 @@ class GttlMultiseq
                           std::to_string(sequences_length_bits_get()));
     log_vector.push_back(std::string("sequences_total_length\t") +
                           std::to_string(sequences_total_length_get()));
+    if (has_quality_store)
+    {
+      log_vector.push_back(std::string("quality_store_bytes\t") +
+                            std::to_string(quality_store.size_in_bytes()));
+    }
     return log_vector;
   }
 
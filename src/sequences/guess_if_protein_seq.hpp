@@ -23,6 +23,7 @@
 #include <ios>
 #include <vector>
 #include <string>
+#include <string_view>
 #include "sequences/gttl_fasta_generator.hpp"
 #include "utilities/gttl_file_open.hpp"
 
@@ -53,18 +54,11 @@ inline bool guess_if_protein_sequence(const char *sequence,size_t seqlen)
 }
 
 template<class ReaderClass>
-bool guess_if_protein_file_generic(const char *filename)
+bool guess_if_protein_reader(ReaderClass *reader)
 {
-  const GttlFpType in_fp = gttl_fp_type_open(filename, "rb");
-
-  if (in_fp == nullptr)
-  {
-    throw std::ios_base::failure(": cannot open file");
-  }
-  ReaderClass reader(in_fp);
   size_t total_length = 0;
   bool decided_if_protein = false;
-  for (auto &&si : reader)
+  for (auto &&si : *reader)
   {
     auto sequence = si->sequence_get();
     if (guess_if_protein_sequence(sequence.data(),sequence.size()))
@@ -81,6 +75,30 @@ bool guess_if_protein_file_generic(const char *filename)
   return decided_if_protein;
 }
 
+template<class ReaderClass>
+bool guess_if_protein_file_generic(const char *filename)
+{
+  const GttlFpType in_fp = gttl_fp_type_open(filename, "rb");
+
+  if (in_fp == nullptr)
+  {
+    throw std::ios_base::failure(": cannot open file");
+  }
+  ReaderClass reader(in_fp);
+  return guess_if_protein_reader<ReaderClass>(&reader);
+}
+
+/* for input which can only be read once, e.g. the standard input, the
+   guess is based on the beginning of the input in FASTA format, as
+   delivered by GttlSequencesChunkReader::pending_get. The last
+   sequence may be incomplete. */
+inline bool guess_if_protein_fasta_prefix(std::string_view fasta_prefix)
+{
+  constexpr const int buf_size = 1 << 14;
+  GttlFastAGenerator<buf_size> reader(fasta_prefix);
+  return guess_if_protein_reader<GttlFastAGenerator<buf_size>>(&reader);
+}
+
 inline bool guess_if_protein_file(const char *filename)
 {
   constexpr const int buf_size = 1 << 14;
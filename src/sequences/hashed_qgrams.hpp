@@ -1,6 +1,8 @@
 #ifndef HASHED_QGRAMS_HPP
 #define HASHED_QGRAMS_HPP
+#include <array>
 #include <atomic>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <cassert>
@@ -12,13 +14,14 @@
 #include <string>
 #include <cstring> /* for cache input/output */
 #include <fstream> /* for cache input/output */
+#include <functional>
 #include <utility>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 #include <algorithm>
 #include <cmath>
 #include <format>
-#include <deque>
 
 #include "utilities/bitpacker.hpp"
 #include "utilities/buckets.hpp"
@@ -31,10 +34,50 @@
 #include "sequences/char_range.hpp"
 #include "sequences/char_finder.hpp"
 #include "sequences/gttl_multiseq.hpp"
+#include "sequences/minimizer_queue.hpp"
 
 template<int sizeof_unit>
 using HashedQgramVector = std::vector<BytesUnit<sizeof_unit,3>>;
 
+/* Instead of a HashedQgramVector the append functions below can
+   deliver the hashed qgrams to one of the following classes, which
+   count them or store them in preallocated memory. */
+template<int sizeof_unit>
+class HashedQgramCounter
+{
+  size_t count;
+  public:
+  HashedQgramCounter(void)
+    : count(0)
+  {}
+  void emplace_back(const BytesUnit<sizeof_unit,3> &) noexcept
+  {
+    count++;
+  }
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return count;
+  }
+};
+
+template<int sizeof_unit>
+class HashedQgramWriter
+{
+  BytesUnit<sizeof_unit,3> *next_free;
+  public:
+  HashedQgramWriter(BytesUnit<sizeof_unit,3> *_next_free)
+    : next_free(_next_free)
+  {}
+  void emplace_back(const BytesUnit<sizeof_unit,3> &hashed_qgram) noexcept
+  {
+    *next_free++ = hashed_qgram;
+  }
+  [[nodiscard]] const BytesUnit<sizeof_unit,3> *end(void) const noexcept
+  {
+    return next_free;
+  }
+};
+
 /* Header for cache of reference index,
    so the load-method can identify it */
 struct HashedQgramsCacheHeader
@@ -46,7 +89,8 @@ struct HashedQgramsCacheHeader
   uint8_t possible_false_positive;
   uint8_t at_constant_distance;
   uint8_t has_wildcards;
-  uint8_t reserved[3];
+  uint8_t sampling; /* cache_id of the sampling policy */
+  uint8_t reserved[2];
   uint64_t qgram_length;
   int64_t hashbits;
   uint64_t count_all_qgrams;
@@ -112,15 +156,15 @@ using NucleotideRanger = GttlCharRange<char_finder::NucleotideFinder,
                                        unw_nucleotide_finder,
                                        true, false>;
 
-template<int sizeof_unit,class HashIterator>
+template<int sizeof_unit,class HashIterator,
+         class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
 static std::pair<size_t,bool> append_minimizers(
                                        size_t qgram_length,
                                        size_t window_size,
                                        uint64_t hash_mask,
                                        const GttlBitPacker<sizeof_unit,3>
                                          &hashed_qgram_packer,
-                                       HashedQgramVector<sizeof_unit>
-                                         *minimizer_vector,
+                                       HashedQgramOutput *minimizer_vector,
                                        const char *sequence,
                                        size_t seqlen,
                                        size_t seqnum)
@@ -135,12 +179,36 @@ static std::pair<size_t,bool> append_minimizers(
     }
   }
   const size_t minseqlen_to_process = window_size + qgram_length - 1;
-  std::deque<BytesUnit<sizeof_unit,3>> window_deque{};
+  /* The monotone queue of the q-grams of the current window stores the
+     hash values and the positions. Packing them into a BytesUnit is
+     only necessary if a q-gram is delivered as minimizer. */
+  GttlMinimizerQueue window_queue(window_size);
+  static constexpr const uint64_t minimizer_rc_flag = uint64_t(1) << 63;
+  auto minimizer_unit = [&](uint64_t hash_value, uint64_t payload)
+  {
+    const uint64_t pos = payload & ~minimizer_rc_flag;
+    if ((payload & minimizer_rc_flag) != 0)
+    {
+      return BytesUnit<sizeof_unit,3>(hashed_qgram_packer,
+                                      {hash_value,
+                                       static_cast<uint64_t>(seqnum + 1),
+                                       static_cast<uint64_t>(seqlen
+                                                             - (pos +
+                                                                qgram_length))
+                                      });
+    }
+    return BytesUnit<sizeof_unit,3>(hashed_qgram_packer,
+                                    {hash_value,
+                                     static_cast<uint64_t>(seqnum),
+                                     pos});
+  };
   size_t count_all_qgrams = 0;
   bool has_wildcards = false;
   const NucleotideRanger ranger(sequence, seqlen);
   HashedQgramVector<sizeof_unit>  //NOLINT(misc-const-correctness)
     palindromic_vector{};
+  /* the hash values are obtained in blocks from the iterator */
+  std::array<uint64_t,256> fwd_hash_values, rc_hash_values;
   for (auto const &&range : ranger)
   {
     const size_t this_length = std::get<1>(range);
@@ -152,113 +220,91 @@ static std::pair<size_t,bool> append_minimizers(
     size_t seqpos = std::get<0>(range);
     const char *const seqptr = sequence + seqpos;
     HashIterator qgiter(qgram_length, seqptr, this_length);
-    count_all_qgrams += (this_length - qgram_length - 1);
+    count_all_qgrams += (this_length - qgram_length + 1);
 
 #ifdef VALIDATE_MINIMIZER
     HashedQgramVector<sizeof_unit> all_hashed_qgrams;
     size_t search_start = 0;
 #endif
     bool front_was_moved = false;
-    for (auto const &&code_pair : qgiter)
+    size_t block_idx = 0, block_size = 0;
+    while (true)
     {
+      if (block_idx == block_size)
+      {
+        if constexpr (HashIterator::handle_both_strands)
+        {
+          block_size = qgiter.fill(fwd_hash_values.data(),
+                                   rc_hash_values.data(),
+                                   fwd_hash_values.size());
+        } else
+        {
+          block_size = qgiter.fill(fwd_hash_values.data(),
+                                   fwd_hash_values.size());
+        }
+        if (block_size == 0)
+        {
+          break;
+        }
+        block_idx = 0;
+      }
       uint64_t this_hash = // NOLINT(misc-const-correctness)
-        std::get<0>(code_pair) & hash_mask;
-      size_t stored_seqnum;
-      size_t stored_seqpos;
+        fwd_hash_values[block_idx] & hash_mask;
+      uint64_t this_payload = seqpos; // NOLINT(misc-const-correctness)
       if constexpr (HashIterator::handle_both_strands)
       {
-        const uint64_t rc_hash = std::get<1>(code_pair) & hash_mask;
+        const uint64_t rc_hash = rc_hash_values[block_idx] & hash_mask;
         if (rc_hash < this_hash)
         {
           this_hash = rc_hash;
-          stored_seqnum = seqnum + 1;
           assert(seqlen >= seqpos + qgram_length);
-          stored_seqpos = seqlen - (seqpos + qgram_length);
+          this_payload |= minimizer_rc_flag;
         } else
         {
           if (rc_hash == this_hash)
           {
             /* also add the coordinates for the reverse complement
                as it would otherwise be neglected */
-            const BytesUnit<sizeof_unit, 3> palindromic_hashed_qgram_rc(
-                                         hashed_qgram_packer,
-                                         {this_hash,
-                                          static_cast<uint64_t>(seqnum + 1),
-                                          static_cast<uint64_t>(
-                                                             seqlen
-                                                             - (seqpos
-                                                             + qgram_length))});
-            palindromic_vector.emplace_back(palindromic_hashed_qgram_rc);
-            const BytesUnit<sizeof_unit, 3> palindromic_hashed_qgram_fwd(
-                                         hashed_qgram_packer,
-                                         {this_hash,
-                                          static_cast<uint64_t>(seqnum),
-                                          static_cast<uint64_t>(seqpos)});
-            palindromic_vector.emplace_back(palindromic_hashed_qgram_fwd);
+            palindromic_vector.emplace_back(
+              minimizer_unit(this_hash, seqpos | minimizer_rc_flag));
+            palindromic_vector.emplace_back(minimizer_unit(this_hash,
+                                                           seqpos));
           }
-          stored_seqnum = seqnum;
-          stored_seqpos = seqpos;
-        }
-      } else
-      {
-        stored_seqnum = seqnum;
-        stored_seqpos = seqpos;
-      }
-      while (true)
-      {
-        if (window_deque.empty())
-        {
-          front_was_moved = false; /* as next element becomes new front
-                                      which has not been moved before */
-          break;
-        }
-        if (window_deque.back().template decode_at<0>(hashed_qgram_packer)
-            <= this_hash)
-        {
-          break;
         }
-        window_deque.pop_back();
       }
-      const BytesUnit<sizeof_unit, 3> current_hashed_qgram(
-                                   hashed_qgram_packer,
-                                   {this_hash,
-                                    static_cast<uint64_t>(stored_seqnum),
-                                    static_cast<uint64_t>(stored_seqpos)});
 #ifdef VALIDATE_MINIMIZER
-      all_hashed_qgrams.emplace_back(current_hashed_qgram);
+      all_hashed_qgrams.emplace_back(minimizer_unit(this_hash,
+                                                    this_payload));
 #endif
-      window_deque.emplace_back(current_hashed_qgram);
+      if (window_queue.push_back(this_hash, this_payload))
+      {
+        front_was_moved = false; /* as the new element is the new front
+                                    which has not been moved before */
+      }
 
       // After the minimizer of the first window was found
       // At this point we are only looking if
       // the current minimizer drops out of the window
       if (seqpos >= window_size)
       {
-        uint64_t min_pos_in_window = //NOLINT(misc-const-correctness)
-          window_deque.front().template decode_at<2>
-          (hashed_qgram_packer);
-        if constexpr (HashIterator::handle_both_strands)
-        {
-          if (window_deque.front().template decode_at<1>(hashed_qgram_packer) ==
-              seqnum + 1)
-          {
-            min_pos_in_window = seqlen - (min_pos_in_window + qgram_length);
-          }
-        }
+        const uint64_t min_pos_in_window
+          = window_queue.front_payload_get() & ~minimizer_rc_flag;
         // check if current minimizer drops out of the window
         if (min_pos_in_window <= seqpos - window_size)
         {
-          window_deque.pop_front();
+          window_queue.pop_front();
           front_was_moved = false; /* queue is still not empty and
                                       now front element was not moved yet */
         }
-        assert(!window_deque.empty()); /* because we added
-                                          current_hashed_qgram */
+        assert(not window_queue.empty()); /* because we added
+                                             the current hashed qgram */
         /* check if new minimizer was found (i.e. front element which was
            not moved yet */
-        if (!front_was_moved)
+        if (not front_was_moved)
         {
-          minimizer_vector->emplace_back(window_deque.front());
+          minimizer_vector->emplace_back(
+            minimizer_unit(window_queue.front_hash_value_get(),
+                           window_queue.front_payload_get()));
           front_was_moved = true; /* we moved front element and do not
                                      want to do it again */
         }
@@ -267,20 +313,27 @@ static std::pair<size_t,bool> append_minimizers(
         // add minimizer of first window
         if (seqpos == window_size - 1)
         {
-          minimizer_vector->emplace_back(window_deque.front());
+          minimizer_vector->emplace_back(
+            minimizer_unit(window_queue.front_hash_value_get(),
+                           window_queue.front_payload_get()));
           front_was_moved = true;
         }
       }
+      block_idx++;
       seqpos++;
     }
 #ifdef VALIDATE_MINIMIZER
-    validate_minimizers<sizeof_unit>(window_size,
-                                     all_hashed_qgrams,
-                                     minimizer_vector,
-                                     hashed_qgram_packer,
-                                     search_start);
+    if constexpr (std::is_same_v<HashedQgramOutput,
+                                 HashedQgramVector<sizeof_unit>>)
+    {
+      validate_minimizers<sizeof_unit>(window_size,
+                                       all_hashed_qgrams,
+                                       minimizer_vector,
+                                       hashed_qgram_packer,
+                                       search_start);
+    }
 #endif
-    window_deque.clear();
+    window_queue.clear();
   }
   if constexpr (HashIterator::handle_both_strands)
   {
@@ -292,14 +345,15 @@ static std::pair<size_t,bool> append_minimizers(
   return std::make_pair(count_all_qgrams, has_wildcards);
 }
 
-template<int sizeof_unit,class HashIterator>
+template<int sizeof_unit,class HashIterator,
+         class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
 static std::pair<size_t,bool> append_constant_distance_hashed_qgrams(
                                        size_t qgram_length,
                                        size_t window_size,
                                        uint64_t hash_mask,
                                        const GttlBitPacker<sizeof_unit,3>
                                          &hashed_qgram_packer,
-                                       HashedQgramVector<sizeof_unit>
+                                       HashedQgramOutput
                                          *hashed_qgrams_vector,
                                        const char *sequence,
                                        size_t seqlen,
@@ -329,7 +383,7 @@ static std::pair<size_t,bool> append_constant_distance_hashed_qgrams(
     size_t seqpos = std::get<0>(range);
     const char *const seqptr = sequence + seqpos;
     HashIterator qgiter(qgram_length, seqptr, this_length);
-    count_all_qgrams += (this_length - qgram_length - 1);
+    count_all_qgrams += (this_length - qgram_length + 1);
     size_t steps = 0;
     for (auto const &&code_pair : qgiter)
     {
@@ -374,51 +428,403 @@ static std::pair<size_t,bool> append_constant_distance_hashed_qgrams(
   return std::make_pair(count_all_qgrams, has_wildcards);
 }
 
-template<int sizeof_unit>
-struct HashedQgramVectorTable
+/* delivers the hash values of the q-grams of a sequence one after the
+   other, while obtaining them in blocks from the HashIterator. If the
+   HashIterator handles both strands, the hash values of the reverse
+   complements are delivered, too. */
+template<class HashIterator>
+class HashValueBlockReader
 {
-  /* common data */
-  std::vector<size_t> count_all_qgrams;
-  std::vector<std::atomic<bool>> has_wildcards;
-  std::vector<HashedQgramVector<sizeof_unit>> table;
-  HashedQgramVectorTable(size_t number_of_threads)
-    : count_all_qgrams(number_of_threads,0)
-    , table(number_of_threads,HashedQgramVector<sizeof_unit>{})
+  HashIterator qgiter;
+  std::array<uint64_t,256> fwd_hash_values, rc_hash_values;
+  size_t block_idx, block_size;
+  public:
+  HashValueBlockReader(size_t qgram_length, const char *sequence,
+                       size_t seqlen)
+    : qgiter(qgram_length, sequence, seqlen)
+    , block_idx(0)
+    , block_size(0)
+  {}
+  /* returns false if all hash values have been delivered */
+  bool next(uint64_t *fwd_hash_value, uint64_t *rc_hash_value)
   {
-    has_wildcards = std::vector<std::atomic<bool>>(number_of_threads);
-    for(auto &b : has_wildcards) b.store(false, std::memory_order_relaxed);
+    if (block_idx == block_size)
+    {
+      if constexpr (HashIterator::handle_both_strands)
+      {
+        block_size = qgiter.fill(fwd_hash_values.data(),
+                                 rc_hash_values.data(),
+                                 fwd_hash_values.size());
+      } else
+      {
+        block_size = qgiter.fill(fwd_hash_values.data(),
+                                 fwd_hash_values.size());
+      }
+      if (block_size == 0)
+      {
+        return false;
+      }
+      block_idx = 0;
+    }
+    *fwd_hash_value = fwd_hash_values[block_idx];
+    if constexpr (HashIterator::handle_both_strands)
+    {
+      *rc_hash_value = rc_hash_values[block_idx];
+    }
+    block_idx++;
+    return true;
+  }
+};
+
+/* the hashed qgram at position seqpos of the sequence with number seqnum.
+   If the HashIterator handles both strands, the smaller of both hash
+   values is used, and if it is the one of the reverse complement, so
+   are the sequence number and the position. */
+template<int sizeof_unit,class HashIterator>
+static BytesUnit<sizeof_unit,3> canonical_hashed_qgram(
+                                  uint64_t fwd_hash_value,
+                                  uint64_t rc_hash_value,
+                                  uint64_t hash_mask,
+                                  const GttlBitPacker<sizeof_unit,3>
+                                    &hashed_qgram_packer,
+                                  size_t qgram_length,
+                                  size_t seqlen,
+                                  size_t seqnum,
+                                  size_t seqpos)
+{
+  uint64_t this_hash = fwd_hash_value & hash_mask;
+  size_t stored_seqnum = seqnum;
+  size_t stored_seqpos = seqpos;
+  if constexpr (HashIterator::handle_both_strands)
+  {
+    const uint64_t rc_hash = rc_hash_value & hash_mask;
+    if (rc_hash < this_hash)
+    {
+      this_hash = rc_hash;
+      stored_seqnum = seqnum + 1;
+      assert(seqlen >= seqpos + qgram_length);
+      stored_seqpos = seqlen - (seqpos + qgram_length);
+    }
+  } else
+  {
+    (void) rc_hash_value;
+    (void) qgram_length;
+    (void) seqlen;
+  }
+  return BytesUnit<sizeof_unit,3>(hashed_qgram_packer,
+                                  {this_hash,
+                                   static_cast<uint64_t>(stored_seqnum),
+                                   static_cast<uint64_t>(stored_seqpos)});
+}
+
+/* Syncmers are sampled by looking at the s-mers of a k-mer only, so
+   that the decision whether to select a k-mer does not depend on its
+   context. Here the window size w is the number of s-mers of a k-mer,
+   i.e. s = k - w + 1. A k-mer is a closed syncmer if its smallest s-mer
+   occurs at its first or its last position. It is an open syncmer if
+   its smallest s-mer occurs at the middle position (w - 1)/2. The
+   density of closed syncmers is about 2/(w+1) like for minimizers, that
+   of open syncmers is about 1/w. If the HashIterator handles both
+   strands, the s-mers are compared by their canonical hash values,
+   which makes the selection independent of the strand. */
+template<int sizeof_unit,class HashIterator,bool closed,
+         class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+static std::pair<size_t,bool> append_syncmers(
+                                       size_t qgram_length,
+                                       size_t window_size,
+                                       uint64_t hash_mask,
+                                       const GttlBitPacker<sizeof_unit,3>
+                                         &hashed_qgram_packer,
+                                       HashedQgramOutput
+                                         *hashed_qgrams_vector,
+                                       const char *sequence,
+                                       size_t seqlen,
+                                       size_t seqnum)
+{
+  if constexpr (HashIterator::handle_both_strands)
+  {
+    if (seqnum % 2 == 1) /* for processing the reverse complement
+                            we skip every second sequence, as the
+                            syncmers come from the original sequence */
+    {
+      return std::make_pair(0, false);
+    }
   }
-  void concat_hashed_qgram_vectors(HashedQgramVector<sizeof_unit>
-                                     *hashed_qgrams_vector) noexcept
+  assert(window_size >= 1 and window_size <= qgram_length);
+  const size_t smer_length = qgram_length - window_size + 1;
+  const size_t open_offset = (window_size - 1)/2;
+  GttlMinimizerQueue smer_queue(window_size);
+  std::vector<uint64_t> smer_hash_ring(std::bit_ceil(window_size));
+  const size_t ring_mask = smer_hash_ring.size() - 1;
+  size_t count_all_qgrams = 0;
+  bool has_wildcards = false;
+  const NucleotideRanger ranger(sequence, seqlen);
+  for (auto const &&range : ranger)
   {
-    size_t current_idx = 0;
-    size_t max_size_idx = 0;
-    size_t max_size = 0;
-    size_t total_number_of_hashed_qgrams = 0;
-    for (auto const &mv : table)
+    const size_t this_length = std::get<1>(range);
+    has_wildcards = has_wildcards || this_length < seqlen;
+    if (this_length < qgram_length)
+    {
+      continue;
+    }
+    const size_t range_start = std::get<0>(range);
+    const char *const seqptr = sequence + range_start;
+    count_all_qgrams += (this_length - qgram_length + 1);
+    HashValueBlockReader<HashIterator> smer_reader(smer_length, seqptr,
+                                                   this_length);
+    HashValueBlockReader<HashIterator> kmer_reader(qgram_length, seqptr,
+                                                   this_length);
+    uint64_t fwd_hash = 0, rc_hash = 0;
+    for (size_t smer_pos = 0; smer_reader.next(&fwd_hash, &rc_hash);
+         smer_pos++)
     {
-      total_number_of_hashed_qgrams += mv.size();
-      if (max_size < mv.size())
+      const uint64_t smer_hash
+        = HashIterator::handle_both_strands ? std::min(fwd_hash, rc_hash)
+                                            : fwd_hash;
+      smer_hash_ring[smer_pos & ring_mask] = smer_hash;
+      (void) smer_queue.push_back(smer_hash, smer_pos);
+      if (smer_pos + 1 < window_size)
       {
-        max_size = mv.size();
-        max_size_idx = current_idx;
+        continue;
+      }
+      /* the s-mers at smer_pos - window_size + 1 ... smer_pos are those
+         of the k-mer at position kmer_pos */
+      const size_t kmer_pos = smer_pos + 1 - window_size;
+      if (smer_queue.front_payload_get() < kmer_pos)
+      {
+        smer_queue.pop_front();
+      }
+      [[maybe_unused]] const bool kmer_available
+        = kmer_reader.next(&fwd_hash, &rc_hash);
+      assert(kmer_available);
+      const uint64_t min_hash = smer_queue.front_hash_value_get();
+      bool selected;
+      if constexpr (closed)
+      {
+        selected = smer_hash_ring[kmer_pos & ring_mask] == min_hash or
+                   smer_hash == min_hash;
+      } else
+      {
+        selected = smer_hash_ring[(kmer_pos + open_offset) & ring_mask]
+                   == min_hash;
+      }
+      if (selected)
+      {
+        hashed_qgrams_vector->emplace_back(
+          canonical_hashed_qgram<sizeof_unit,HashIterator>(
+            fwd_hash, rc_hash, hash_mask, hashed_qgram_packer,
+            qgram_length, seqlen, seqnum, range_start + kmer_pos));
       }
-      current_idx++;
     }
-    if (table.size() > 1)
+    smer_queue.clear();
+  }
+  return std::make_pair(count_all_qgrams, has_wildcards);
+}
+
+/* The mod-minimizers of Groot Koerkamp and Pibiri (2024) have a lower
+   density than minimizers if the window size w is not much larger than
+   the k-mer length. For each window of w consecutive k-mers, the position
+   x of the smallest t-mer with t = r + ((k - r) mod w) in the window is
+   determined and the k-mer at position x mod w of the window is
+   selected. As for minimizers, a k-mer selected for consecutive windows
+   is stored only once. If the HashIterator handles both strands, the
+   t-mers are compared by their canonical hash values. */
+template<int sizeof_unit,class HashIterator,
+         class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+static std::pair<size_t,bool> append_mod_minimizers(
+                                       size_t qgram_length,
+                                       size_t window_size,
+                                       uint64_t hash_mask,
+                                       const GttlBitPacker<sizeof_unit,3>
+                                         &hashed_qgram_packer,
+                                       HashedQgramOutput
+                                         *hashed_qgrams_vector,
+                                       const char *sequence,
+                                       size_t seqlen,
+                                       size_t seqnum)
+{
+  if constexpr (HashIterator::handle_both_strands)
+  {
+    if (seqnum % 2 == 1) /* for processing the reverse complement
+                            we skip every second sequence, as the
+                            minimizers come from the original sequence */
+    {
+      return std::make_pair(0, false);
+    }
+  }
+  assert(window_size >= 1);
+  static constexpr const size_t small_tmer_length = 4;
+  const size_t tmer_length
+    = qgram_length <= small_tmer_length
+        ? qgram_length
+        : small_tmer_length + (qgram_length - small_tmer_length) % window_size;
+  /* number of t-mers in a window of w k-mers */
+  const size_t tmer_window_size = window_size + qgram_length - tmer_length;
+  const size_t minseqlen_to_process = window_size + qgram_length - 1;
+  GttlMinimizerQueue tmer_queue(tmer_window_size);
+  std::vector<uint64_t> fwd_kmer_ring(std::bit_ceil(window_size)),
+                        rc_kmer_ring(fwd_kmer_ring.size());
+  const size_t ring_mask = fwd_kmer_ring.size() - 1;
+  size_t count_all_qgrams = 0;
+  bool has_wildcards = false;
+  const NucleotideRanger ranger(sequence, seqlen);
+  for (auto const &&range : ranger)
+  {
+    const size_t this_length = std::get<1>(range);
+    has_wildcards = has_wildcards || this_length < seqlen;
+    if (this_length < minseqlen_to_process)
     {
-      table[max_size_idx].reserve(total_number_of_hashed_qgrams);
-      for (size_t idx = 0; idx < table.size(); idx++)
+      continue;
+    }
+    const size_t range_start = std::get<0>(range);
+    const char *const seqptr = sequence + range_start;
+    count_all_qgrams += (this_length - qgram_length + 1);
+    HashValueBlockReader<HashIterator> tmer_reader(tmer_length, seqptr,
+                                                   this_length);
+    HashValueBlockReader<HashIterator> kmer_reader(qgram_length, seqptr,
+                                                   this_length);
+    size_t kmers_read = 0;
+    size_t previous_selected = SIZE_MAX;
+    uint64_t fwd_hash = 0, rc_hash = 0;
+    for (size_t tmer_pos = 0; tmer_reader.next(&fwd_hash, &rc_hash);
+         tmer_pos++)
+    {
+      const uint64_t tmer_hash
+        = HashIterator::handle_both_strands ? std::min(fwd_hash, rc_hash)
+                                            : fwd_hash;
+      (void) tmer_queue.push_back(tmer_hash, tmer_pos);
+      if (tmer_pos + 1 < tmer_window_size)
       {
-        if (idx != max_size_idx)
-        {
-          table[max_size_idx].insert(table[max_size_idx].end(),
-                                     table[idx].begin(),
-                                     table[idx].end());
-        }
+        continue;
+      }
+      /* the window of k-mers starting at window_start consists of the
+         t-mers at tmer_pos - tmer_window_size + 1 ... tmer_pos */
+      const size_t window_start = tmer_pos + 1 - tmer_window_size;
+      if (tmer_queue.front_payload_get() < window_start)
+      {
+        tmer_queue.pop_front();
+      }
+      while (kmers_read < window_start + window_size)
+      {
+        [[maybe_unused]] const bool kmer_available
+          = kmer_reader.next(&fwd_kmer_ring[kmers_read & ring_mask],
+                             &rc_kmer_ring[kmers_read & ring_mask]);
+        assert(kmer_available);
+        kmers_read++;
+      }
+      const size_t selected
+        = window_start
+          + (tmer_queue.front_payload_get() - window_start) % window_size;
+      if (selected != previous_selected)
+      {
+        hashed_qgrams_vector->emplace_back(
+          canonical_hashed_qgram<sizeof_unit,HashIterator>(
+            fwd_kmer_ring[selected & ring_mask],
+            rc_kmer_ring[selected & ring_mask],
+            hash_mask, hashed_qgram_packer,
+            qgram_length, seqlen, seqnum, range_start + selected));
+        previous_selected = selected;
       }
     }
-    *hashed_qgrams_vector = std::move(table[max_size_idx]);
+    tmer_queue.clear();
+  }
+  return std::make_pair(count_all_qgrams, has_wildcards);
+}
+
+/* The sampling policies for HashedQgramsGeneric. Each one provides the
+   function used to append the sampled hashed qgrams of a sequence, a
+   name for the log and an identifier stored in the cache header. */
+struct MinimizerSampling
+{
+  static constexpr const char *name = "minimizer";
+  static constexpr const uint8_t cache_id = 0;
+  template<int sizeof_unit,class HashIterator,
+           class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+  static constexpr auto append
+    = append_minimizers<sizeof_unit,HashIterator,HashedQgramOutput>;
+  static void parameters_check(size_t, size_t) {}
+};
+
+template<bool closed>
+struct SyncmerSampling
+{
+  static constexpr const char *name = closed ? "closed_syncmer"
+                                             : "open_syncmer";
+  static constexpr const uint8_t cache_id = closed ? 1 : 2;
+  template<int sizeof_unit,class HashIterator,
+           class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+  static constexpr auto append
+    = append_syncmers<sizeof_unit,HashIterator,closed,HashedQgramOutput>;
+  static void parameters_check(size_t qgram_length, size_t window_size)
+  {
+    if (window_size > qgram_length)
+    {
+      throw std::runtime_error(std::format(": for {}s the window size {} "
+                                           "must not be larger than the "
+                                           "kmer length {}",
+                                           name, window_size, qgram_length));
+    }
+  }
+};
+
+using ClosedSyncmerSampling = SyncmerSampling<true>;
+using OpenSyncmerSampling = SyncmerSampling<false>;
+
+struct ModMinimizerSampling
+{
+  static constexpr const char *name = "mod_minimizer";
+  static constexpr const uint8_t cache_id = 3;
+  template<int sizeof_unit,class HashIterator,
+           class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+  static constexpr auto append
+    = append_mod_minimizers<sizeof_unit,HashIterator,HashedQgramOutput>;
+  static void parameters_check(size_t, size_t) {}
+};
+
+/* Not selectable as template parameter of HashedQgramsGeneric, but
+   chosen at run time via the flag at_constant_distance. */
+struct ConstantDistanceSampling
+{
+  static constexpr const char *name = "constant_distance";
+  template<int sizeof_unit,class HashIterator,
+           class HashedQgramOutput = HashedQgramVector<sizeof_unit>>
+  static constexpr auto append
+    = append_constant_distance_hashed_qgrams<sizeof_unit,HashIterator,
+                                             HashedQgramOutput>;
+  static void parameters_check(size_t, size_t) {}
+};
+
+/* The data shared by the threads collecting the hashed qgrams in two
+   passes over the sequences: the first pass counts the hashed qgrams
+   of each sequence, the second pass writes them to their final
+   position in a single vector, determined by the prefix sums of the
+   counts. So no thread local vectors need to be concatenated. */
+template<int sizeof_unit>
+struct HashedQgramCollector
+{
+  std::vector<size_t> count_all_qgrams;
+  std::vector<std::atomic<bool>> has_wildcards;
+  /* after the first pass, element seqnum + 1 is the number of hashed
+     qgrams of sequence seqnum; after prefix_sums it is the end of the
+     hashed qgrams of this sequence in the final vector */
+  std::vector<size_t> sequence_ends;
+  BytesUnit<sizeof_unit,3> *hashed_qgrams;
+  HashedQgramCollector(size_t number_of_threads, size_t number_of_sequences)
+    : count_all_qgrams(number_of_threads,0)
+    , sequence_ends(number_of_sequences + 1,0)
+    , hashed_qgrams(nullptr)
+  {
+    has_wildcards = std::vector<std::atomic<bool>>(number_of_threads);
+    for(auto &b : has_wildcards) b.store(false, std::memory_order_relaxed);
+  }
+  /* returns the total number of hashed qgrams */
+  size_t prefix_sums(void) noexcept
+  {
+    for (size_t idx = 1; idx < sequence_ends.size(); idx++)
+    {
+      sequence_ends[idx] += sequence_ends[idx - 1];
+    }
+    return sequence_ends.back();
   }
   [[nodiscard]] size_t count_all_qgrams_get(void) const noexcept
   {
@@ -438,42 +844,79 @@ struct HashedQgramVectorTable
     }
     return total_has_wildcards;
   }
-  ~HashedQgramVectorTable(void) = default;
+  ~HashedQgramCollector(void) = default;
 };
 
-template<int sizeof_unit,class HashIterator>
-static void append_hashed_qgrams_threaded(size_t thread_id,
-                                          size_t task_num,
-                                          const GttlMultiseq &multiseq,
-                                          size_t qgram_length,
-                                          size_t window_size,
-                                          uint64_t hash_mask,
-                                          const GttlBitPacker<sizeof_unit,3>
-                                            &hashed_qgram_packer,
-                                          HashedQgramVectorTable<sizeof_unit>
-                                            *hashed_qgram_vector_table)
+template<int sizeof_unit,class HashIterator,class SamplingPolicy>
+static void count_hashed_qgrams_threaded(size_t thread_id,
+                                         size_t task_num,
+                                         const GttlMultiseq &multiseq,
+                                         size_t qgram_length,
+                                         size_t window_size,
+                                         uint64_t hash_mask,
+                                         const GttlBitPacker<sizeof_unit,3>
+                                           &hashed_qgram_packer,
+                                         HashedQgramCollector<sizeof_unit>
+                                           *hashed_qgram_collector)
 {
+  HashedQgramCounter<sizeof_unit> counter{};
   size_t this_count;
-  size_t this_has_wildcards;
+  bool this_has_wildcards;
   std::tie(this_count,this_has_wildcards)
-    = append_minimizers<sizeof_unit,HashIterator>
+    = SamplingPolicy::template append<sizeof_unit,HashIterator,
+                                      HashedQgramCounter<sizeof_unit>>
                        (qgram_length,
                         window_size,
                         hash_mask,
                         hashed_qgram_packer,
-                        &hashed_qgram_vector_table->table[thread_id],
+                        &counter,
                         multiseq.sequence_ptr_get(task_num),
                         multiseq.sequence_length_get(task_num),
                         task_num);
-  hashed_qgram_vector_table->count_all_qgrams[thread_id] += this_count;
+  hashed_qgram_collector->sequence_ends[task_num + 1] = counter.size();
+  hashed_qgram_collector->count_all_qgrams[thread_id] += this_count;
   if(this_has_wildcards)
   {
-    hashed_qgram_vector_table->has_wildcards[thread_id]
+    hashed_qgram_collector->has_wildcards[thread_id]
       .store(true, std::memory_order_relaxed);
   }
 }
 
-template<int sizeof_unit,class HashIterator>
+template<int sizeof_unit,class HashIterator,class SamplingPolicy>
+static void write_hashed_qgrams_threaded(size_t,
+                                         size_t task_num,
+                                         const GttlMultiseq &multiseq,
+                                         size_t qgram_length,
+                                         size_t window_size,
+                                         uint64_t hash_mask,
+                                         const GttlBitPacker<sizeof_unit,3>
+                                           &hashed_qgram_packer,
+                                         HashedQgramCollector<sizeof_unit>
+                                           *hashed_qgram_collector)
+{
+  HashedQgramWriter<sizeof_unit>
+    writer(hashed_qgram_collector->hashed_qgrams +
+           hashed_qgram_collector->sequence_ends[task_num]);
+  (void) SamplingPolicy::template append<sizeof_unit,HashIterator,
+                                         HashedQgramWriter<sizeof_unit>>
+                       (qgram_length,
+                        window_size,
+                        hash_mask,
+                        hashed_qgram_packer,
+                        &writer,
+                        multiseq.sequence_ptr_get(task_num),
+                        multiseq.sequence_length_get(task_num),
+                        task_num);
+  assert(writer.end() == hashed_qgram_collector->hashed_qgrams +
+                         hashed_qgram_collector->sequence_ends[task_num + 1]);
+}
+
+/* The hashed qgrams of the sequences of a multiseq, sampled by
+   SamplingPolicy, i.e. MinimizerSampling, ClosedSyncmerSampling,
+   OpenSyncmerSampling or ModMinimizerSampling, or at constant
+   distance. */
+template<int sizeof_unit,class HashIterator,
+         class SamplingPolicy = MinimizerSampling>
 class HashedQgramsGeneric
 {
   struct Iterator
@@ -617,12 +1060,20 @@ class HashedQgramsGeneric
     assert(hashbits != -1);
     RunTimeClass rt_collect{};
     assert(number_of_threads >= 1);
+    if (not at_constant_distance)
+    {
+      SamplingPolicy::parameters_check(qgram_length, window_size);
+    }
     if (log_vector != nullptr)
     {
       log_vector->push_back(std::string("kmer_size\t") +
                             std::to_string(qgram_length));
       log_vector->push_back(std::string("window_size\t") +
                             std::to_string(window_size));
+      log_vector->push_back(std::string("sampling\t") +
+                            (at_constant_distance
+                               ? ConstantDistanceSampling::name
+                               : SamplingPolicy::name));
     }
     const uint64_t hash_mask = gttl_bits2maxvalue<uint64_t>(hashbits);
     if (number_of_threads == 1)
@@ -631,12 +1082,12 @@ class HashedQgramsGeneric
            seqnum++)
       {
         size_t this_count;
-        size_t this_has_wildcards;
+        bool this_has_wildcards;
         std::tie(this_count,this_has_wildcards)
           = (at_constant_distance
-               ? append_constant_distance_hashed_qgrams
-                                  <sizeof_unit,HashIterator>
-               : append_minimizers<sizeof_unit,HashIterator>)
+               ? ConstantDistanceSampling::template append<sizeof_unit,
+                                                           HashIterator>
+               : SamplingPolicy::template append<sizeof_unit,HashIterator>)
                                   (qgram_length,
                                    window_size,
                                    hash_mask,
@@ -650,29 +1101,49 @@ class HashedQgramsGeneric
       }
     } else
     {
-      assert(!at_constant_distance);
-      HashedQgramVectorTable<sizeof_unit>
-        hashed_qgram_vector_table(number_of_threads);
+      const size_t number_of_sequences = multiseq.sequences_number_get();
+      HashedQgramCollector<sizeof_unit>
+        hashed_qgram_collector(number_of_threads, number_of_sequences);
+      /* the multiseq and the packer are passed as references, as
+         otherwise the thread pool would copy them for each thread */
       gttl_thread_pool_var(number_of_threads,
-                           multiseq.sequences_number_get(),
-                           append_hashed_qgrams_threaded<sizeof_unit,
-                                                         HashIterator>,
-                           multiseq,
+                           number_of_sequences,
+                           at_constant_distance
+                             ? count_hashed_qgrams_threaded
+                                 <sizeof_unit,
+                                  HashIterator,
+                                  ConstantDistanceSampling>
+                             : count_hashed_qgrams_threaded
+                                 <sizeof_unit,
+                                  HashIterator,
+                                  SamplingPolicy>,
+                           std::cref(multiseq),
                            qgram_length,
                            window_size,
                            hash_mask,
-                           hashed_qgram_packer,
-                           &hashed_qgram_vector_table);
-      RunTimeClass rt_concat{};
-      hashed_qgram_vector_table
-        .concat_hashed_qgram_vectors(&hashed_qgram_vector);
-      count_all_qgrams = hashed_qgram_vector_table.count_all_qgrams_get();
-      has_wildcards = hashed_qgram_vector_table.has_wildcards_get();
-      if (log_vector != nullptr)
-      {
-        log_vector->push_back(rt_concat.
-                              to_string("concatenate hashed kmers vectors"));
-      }
+                           std::cref(hashed_qgram_packer),
+                           &hashed_qgram_collector);
+      hashed_qgram_vector.resize(hashed_qgram_collector.prefix_sums());
+      hashed_qgram_collector.hashed_qgrams = hashed_qgram_vector.data();
+      gttl_thread_pool_var(number_of_threads,
+                           number_of_sequences,
+                           at_constant_distance
+                             ? write_hashed_qgrams_threaded
+                                 <sizeof_unit,
+                                  HashIterator,
+                                  ConstantDistanceSampling>
+                             : write_hashed_qgrams_threaded
+                                 <sizeof_unit,
+                                  HashIterator,
+                                  SamplingPolicy>,
+                           std::cref(multiseq),
+                           qgram_length,
+                           window_size,
+                           hash_mask,
+                           std::cref(hashed_qgram_packer),
+                           &hashed_qgram_collector);
+      count_all_qgrams = hashed_qgram_collector.count_all_qgrams_get();
+      has_wildcards = hashed_qgram_collector.has_wildcards_get();
     }
     if (log_vector != nullptr)
     {
@@ -687,7 +1158,8 @@ class HashedQgramsGeneric
         uint64_t * const ptr =
           reinterpret_cast<uint64_t *>(hashed_qgram_vector.data());
         const Buckets<size_t> *const buckets
-          = ska_lsb_radix_sort<size_t>(hashbits,ptr,hashed_qgram_vector.size());
+          = ska_lsb_radix_sort<size_t>(hashbits,ptr,hashed_qgram_vector.size(),
+                                       number_of_threads);
         delete buckets;
       } else
       {
@@ -697,7 +1169,8 @@ class HashedQgramsGeneric
                                        reinterpret_cast<uint8_t *>
                                          (hashed_qgram_vector.data()),
                                        hashed_qgram_vector.size(),
-                                       reversed_byte_order);
+                                       reversed_byte_order,
+                                       number_of_threads);
       }
       if (log_vector != nullptr)
       {
@@ -864,6 +1337,7 @@ class HashedQgramsGeneric
     header.possible_false_positive
       = HashIterator::possible_false_positive_matches ? 1 : 0;
     header.at_constant_distance = at_constant_distance_flag ? 1 : 0;
+    header.sampling = SamplingPolicy::cache_id;
     header.has_wildcards = has_wildcards ? 1 : 0;
     header.qgram_length = static_cast<uint64_t>(qgram_length);
     header.hashbits = static_cast<int64_t>(hashbits);
@@ -958,6 +1432,13 @@ class HashedQgramsGeneric
                                            "flag not compatible with cached "
                                            "version", cache_path));
     }
+    if (header.sampling != SamplingPolicy::cache_id)
+    {
+      throw std::runtime_error(std::format("cache file {}: sampling method "
+                                           "{} not compatible with cached "
+                                           "version", cache_path,
+                                           SamplingPolicy::name));
+    }
     if (header.qgram_length != expected_qgram_length)
     {
       throw std::runtime_error(std::format("cache file {}: kmer size {} is "
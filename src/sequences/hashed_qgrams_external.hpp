@@ -0,0 +1,374 @@
+#ifndef HASHED_QGRAMS_EXTERNAL_HPP
+#define HASHED_QGRAMS_EXTERNAL_HPP
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "utilities/bitpacker.hpp"
+#include "utilities/bytes_unit.hpp"
+#include "utilities/is_big_endian.hpp"
+#include "utilities/gttl_binary_read.hpp"
+#include "utilities/gttl_binary_write.hpp"
+#include "utilities/loser_tree.hpp"
+#include "utilities/ska_lsb_radix_sort.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/hashed_qgrams.hpp"
+
+/* Sorts hashed qgrams by their hash value in external memory. The
+   hashed qgrams are appended to a buffer of at most memory_budget
+   bytes. As this is done by emplace_back, an object of this class can
+   be used as output of the append functions of the sampling policies in
+   hashed_qgrams.hpp. Whenever the buffer is full, it is sorted and
+   written to a temporary file, called a run. Finally, the runs are
+   merged using a loser tree, which requires one buffer of 64 KB per run
+   in addition to the memory budget. To bound this memory, at most
+   max_merge_runs runs are merged at once: if there are more runs,
+   groups of max_merge_runs consecutive runs are merged into one run in
+   passes over all runs, until at most max_merge_runs runs remain. As
+   the groups keep the order of the runs, the result does not depend on
+   max_merge_runs. If all hashed qgrams fit into the buffer, no run is
+   written. */
+
+template<int sizeof_unit>
+class HashedQgramsExternalSorter
+{
+  using HashedQgram = BytesUnit<sizeof_unit,3>;
+  GttlBitPacker<sizeof_unit,3> hashed_qgram_packer;
+  int hashbits;
+  size_t number_of_threads;
+  std::string run_prefix;
+  size_t max_buffer_size;
+  size_t max_merge_runs;
+  std::vector<HashedQgram> buffer;
+  std::vector<std::string> run_files;
+  size_t number_of_written_runs;
+  size_t number_of_hashed_qgrams;
+  bool merged;
+
+  void buffer_sort(void)
+  {
+    if constexpr (sizeof_unit == 8)
+    {
+      const Buckets<size_t> *const buckets
+        = ska_lsb_radix_sort<size_t>(hashbits,
+                                     reinterpret_cast<uint64_t *>
+                                       (buffer.data()),
+                                     buffer.size(),
+                                     number_of_threads);
+      delete buckets;
+    } else
+    {
+      const bool reversed_byte_order = not is_big_endian();
+      ska_large_lsb_small_radix_sort(sizeof_unit,
+                                     hashbits,
+                                     reinterpret_cast<uint8_t *>
+                                       (buffer.data()),
+                                     buffer.size(),
+                                     reversed_byte_order,
+                                     number_of_threads);
+    }
+  }
+
+  [[nodiscard]] std::string run_file_new(void)
+  {
+    return std::format("{}.{}.run", run_prefix, number_of_written_runs++);
+  }
+
+  void run_write(void)
+  {
+    buffer_sort();
+    run_files.push_back(run_file_new());
+    BinaryFileWriter<HashedQgram> run_writer(run_files.back());
+    for (auto &hashed_qgram : buffer)
+    {
+      run_writer.append(hashed_qgram);
+    }
+    buffer.clear();
+  }
+
+  void run_files_remove(void) noexcept
+  {
+    for (auto &run_file : run_files)
+    {
+      (void) std::remove(run_file.c_str());
+    }
+    run_files.clear();
+  }
+
+  [[nodiscard]] uint64_t hash_value_get(const HashedQgram &hashed_qgram)
+                                        const noexcept
+  {
+    return hashed_qgram.template decode_at<0>(hashed_qgram_packer);
+  }
+
+  /* merges the runs run_files[first], ..., run_files[last - 1] and
+     delivers the hashed qgrams in ascending order of their hash value by
+     calling consume(hashed_qgram) */
+  template<class Consumer>
+  void runs_merge(size_t first, size_t last, Consumer consume)
+  {
+    assert(first < last);
+    using RunReader = BinaryFileReader<HashedQgram>;
+    std::vector<typename RunReader::Iterator> run_iterators{};
+    run_iterators.reserve(last - first);
+    const typename RunReader::Iterator run_end{};
+    GttlLoserTree<uint64_t> loser_tree(last - first);
+    for (size_t run_idx = first; run_idx < last; run_idx++)
+    {
+      run_iterators.emplace_back(run_files[run_idx]);
+      if (run_iterators.back() != run_end)
+      {
+        loser_tree.key_set(run_idx - first,
+                           hash_value_get(*run_iterators.back()));
+      }
+    }
+    loser_tree.init();
+    while (not loser_tree.empty())
+    {
+      auto &run_iterator = run_iterators[loser_tree.winner_get()];
+      consume(*run_iterator);
+      ++run_iterator;
+      if (run_iterator != run_end)
+      {
+        loser_tree.winner_replace(hash_value_get(*run_iterator));
+      } else
+      {
+        loser_tree.winner_remove();
+      }
+    }
+  }
+
+  /* merges groups of max_merge_runs consecutive runs into one run each,
+     until at most max_merge_runs runs remain */
+  void runs_reduce(void)
+  {
+    while (run_files.size() > max_merge_runs)
+    {
+      std::vector<std::string> merged_run_files{};
+      for (size_t first = 0; first < run_files.size();
+           first += max_merge_runs)
+      {
+        const size_t last = std::min(first + max_merge_runs,
+                                     run_files.size());
+        if (last - first == 1)
+        {
+          merged_run_files.push_back(run_files[first]);
+          continue;
+        }
+        merged_run_files.push_back(run_file_new());
+        {
+          BinaryFileWriter<HashedQgram> run_writer(merged_run_files.back());
+          runs_merge(first, last,
+                     [&run_writer](const HashedQgram &hashed_qgram)
+                     {
+                       run_writer.append(hashed_qgram);
+                     });
+        }
+        for (size_t run_idx = first; run_idx < last; run_idx++)
+        {
+          (void) std::remove(run_files[run_idx].c_str());
+        }
+      }
+      run_files.swap(merged_run_files);
+    }
+  }
+
+  public:
+  HashedQgramsExternalSorter(const GttlBitPacker<sizeof_unit,3>
+                               &_hashed_qgram_packer,
+                             int _hashbits,
+                             size_t memory_budget,
+                             const std::string &_run_prefix,
+                             size_t _number_of_threads = 1,
+                             size_t _max_merge_runs = 128)
+    : hashed_qgram_packer(_hashed_qgram_packer)
+    , hashbits(_hashbits)
+    , number_of_threads(_number_of_threads)
+    , run_prefix(_run_prefix)
+    , max_buffer_size(std::max(memory_budget/sizeof(HashedQgram),size_t(1)))
+    , max_merge_runs(_max_merge_runs)
+    , buffer({})
+    , run_files({})
+    , number_of_written_runs(0)
+    , number_of_hashed_qgrams(0)
+    , merged(false)
+  {
+    assert(max_merge_runs >= 2);
+    buffer.reserve(max_buffer_size);
+  }
+
+  ~HashedQgramsExternalSorter(void)
+  {
+    run_files_remove();
+  }
+
+  HashedQgramsExternalSorter(const HashedQgramsExternalSorter &) = delete;
+  HashedQgramsExternalSorter &operator=(const HashedQgramsExternalSorter &)
+    = delete;
+
+  void emplace_back(const HashedQgram &hashed_qgram)
+  {
+    assert(not merged);
+    if (buffer.size() == max_buffer_size)
+    {
+      run_write();
+    }
+    buffer.push_back(hashed_qgram);
+    number_of_hashed_qgrams++;
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return number_of_hashed_qgrams;
+  }
+
+  [[nodiscard]] size_t runs_number_get(void) const noexcept
+  {
+    return run_files.size();
+  }
+
+  [[nodiscard]] const GttlBitPacker<sizeof_unit,3> &packer_get(void)
+                                                      const noexcept
+  {
+    return hashed_qgram_packer;
+  }
+
+  /* delivers all hashed qgrams in ascending order of their hash value
+     by calling consume(hashed_qgram). If max_replicates > 0, the
+     hashed qgrams whose hash value occurs more than max_replicates
+     times are removed, like by
+     HashedQgramsGeneric::remove_replicates_inplace. Returns the number
+     of removed hashed qgrams. Can only be called once. */
+  template<class Consumer>
+  size_t merge(size_t max_replicates, Consumer consume)
+  {
+    assert(not merged);
+    merged = true;
+    size_t removed = 0;
+    std::vector<HashedQgram> replicates{};
+    bool too_many_replicates = false;
+    uint64_t previous_hash_value = 0;
+    auto replicates_deliver = [&](void)
+    {
+      for (auto &hashed_qgram : replicates)
+      {
+        consume(hashed_qgram);
+      }
+      replicates.clear();
+    };
+    auto deliver = [&](const HashedQgram &hashed_qgram)
+    {
+      if (max_replicates == 0)
+      {
+        consume(hashed_qgram);
+        return;
+      }
+      const uint64_t hash_value = hash_value_get(hashed_qgram);
+      if (hash_value != previous_hash_value)
+      {
+        replicates_deliver();
+        too_many_replicates = false;
+        previous_hash_value = hash_value;
+      }
+      if (too_many_replicates)
+      {
+        removed++;
+      } else
+      {
+        replicates.push_back(hashed_qgram);
+        if (replicates.size() > max_replicates)
+        {
+          removed += replicates.size();
+          replicates.clear();
+          too_many_replicates = true;
+        }
+      }
+    };
+    if (run_files.empty())
+    {
+      buffer_sort();
+      for (auto &hashed_qgram : buffer)
+      {
+        deliver(hashed_qgram);
+      }
+    } else
+    {
+      if (not buffer.empty())
+      {
+        run_write();
+      }
+      std::vector<HashedQgram>().swap(buffer);
+      runs_reduce();
+      runs_merge(0, run_files.size(), deliver);
+      run_files_remove();
+    }
+    replicates_deliver();
+    return removed;
+  }
+
+  /* writes the merged hashed qgrams to outputfile, which can then be
+     accessed via Gttlmmap<BytesUnit<sizeof_unit,3>>. Returns the number
+     of removed hashed qgrams. */
+  size_t merge(const std::string &outputfile, size_t max_replicates)
+  {
+    BinaryFileWriter<HashedQgram> writer(outputfile);
+    return merge(max_replicates,[&writer](const HashedQgram &hashed_qgram)
+                                {
+                                  writer.append(hashed_qgram);
+                                });
+  }
+};
+
+/* appends the hashed qgrams of all sequences in multiseq, sampled
+   according to SamplingPolicy or at constant distance, to sorter.
+   Returns the number of all qgrams and if the sequences contain
+   wildcards, like the constructor of HashedQgramsGeneric. */
+template<int sizeof_unit,class HashIterator,
+         class SamplingPolicy = MinimizerSampling>
+static std::pair<size_t,bool> hashed_qgrams_external_collect(
+                                const GttlMultiseq &multiseq,
+                                size_t qgram_length,
+                                size_t window_size,
+                                int hashbits,
+                                bool at_constant_distance,
+                                HashedQgramsExternalSorter<sizeof_unit>
+                                  *sorter)
+{
+  using Sorter = HashedQgramsExternalSorter<sizeof_unit>;
+  if (not at_constant_distance)
+  {
+    SamplingPolicy::parameters_check(qgram_length, window_size);
+  }
+  const uint64_t hash_mask = gttl_bits2maxvalue<uint64_t>(hashbits);
+  size_t count_all_qgrams = 0;
+  bool has_wildcards = false;
+  for (size_t seqnum = 0; seqnum < multiseq.sequences_number_get(); seqnum++)
+  {
+    size_t this_count;
+    bool this_has_wildcards;
+    std::tie(this_count,this_has_wildcards)
+      = (at_constant_distance
+           ? ConstantDistanceSampling::template append<sizeof_unit,
+                                                       HashIterator,Sorter>
+           : SamplingPolicy::template append<sizeof_unit,HashIterator,Sorter>)
+                              (qgram_length,
+                               window_size,
+                               hash_mask,
+                               sorter->packer_get(),
+                               sorter,
+                               multiseq.sequence_ptr_get(seqnum),
+                               multiseq.sequence_length_get(seqnum),
+                               seqnum);
+    count_all_qgrams += this_count;
+    has_wildcards = has_wildcards || this_has_wildcards;
+  }
+  return std::make_pair(count_all_qgrams, has_wildcards);
+}
+#endif
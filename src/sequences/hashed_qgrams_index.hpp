@@ -0,0 +1,490 @@
+#ifndef HASHED_QGRAMS_INDEX_HPP
+#define HASHED_QGRAMS_INDEX_HPP
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utilities/bitpacker.hpp"
+#include "utilities/bytes_unit.hpp"
+#include "utilities/gcc_builtin.hpp"
+#include "utilities/gttl_mmap.hpp"
+
+/* A persistent index of hashed qgrams sorted by their hash value. The
+   file consists of
+
+   - a header of 64 bytes,
+   - the hashed qgrams as BytesUnit<sizeof_unit,3> in ascending order of
+     their hash values,
+   - padding bytes up to the next multiple of 8,
+   - a directory of 2^directory_bits bucket ends (as uint64_t), where
+     bucket b contains the hashed qgrams whose hash value has the
+     directory_bits most significant bits b.
+
+   The directory bits are chosen such that there is about one hashed
+   qgram per bucket, so that a lookup only inspects very few hashed
+   qgrams. The file is accessed via a memory map. */
+
+static constexpr const char hashed_qgrams_index_magic[8]
+  = {'H','Q','G','S','I','D','X','1'};
+static constexpr const uint32_t hashed_qgrams_index_version = 1;
+static constexpr const int hashed_qgrams_index_max_directory_bits = 28;
+
+struct HashedQgramsIndexHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint8_t sizeof_unit;
+  uint8_t handle_both_strands;
+  uint8_t directory_bits;
+  uint8_t reserved;
+  uint64_t qgram_length;
+  uint64_t window_size;
+  uint64_t hashbits;
+  uint64_t sequences_number_bits;
+  uint64_t sequences_length_bits;
+  uint64_t number_of_hashed_qgrams;
+};
+
+static_assert(sizeof(HashedQgramsIndexHeader) == 64);
+
+static inline size_t hashed_qgrams_index_directory_offset(
+                       size_t sizeof_unit,
+                       size_t number_of_hashed_qgrams) noexcept
+{
+  const size_t end_of_units = sizeof(HashedQgramsIndexHeader) +
+                              sizeof_unit * number_of_hashed_qgrams;
+  return (end_of_units + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+/* reads the header of an index file, e.g. to determine the sizeof_unit
+   required to instantiate HashedQgramsIndex */
+static inline HashedQgramsIndexHeader hashed_qgrams_index_header_read(
+                                        const std::string &indexfile)
+{
+  HashedQgramsIndexHeader header{};
+  FILE *fp = std::fopen(indexfile.c_str(),"rb");
+  if (fp == nullptr)
+  {
+    throw std::ios_base::failure(std::format(": cannot open index file {}",
+                                             indexfile));
+  }
+  const size_t read = std::fread(&header, sizeof header, 1, fp);
+  std::fclose(fp);
+  if (read != 1 or
+      std::memcmp(header.magic,hashed_qgrams_index_magic,
+                  sizeof hashed_qgrams_index_magic) != 0)
+  {
+    throw std::runtime_error(std::format(": file {} is not an index of "
+                                         "hashed qgrams", indexfile));
+  }
+  if (header.version != hashed_qgrams_index_version)
+  {
+    throw std::runtime_error(std::format(": index file {} has version {}, "
+                                         "but version {} is required",
+                                         indexfile, header.version,
+                                         hashed_qgrams_index_version));
+  }
+  /* the packer and the directory of the index are derived from these
+     values, so they are checked before any of them is used */
+  if (header.directory_bits == 0 or
+      header.directory_bits > hashed_qgrams_index_max_directory_bits or
+      header.directory_bits > header.hashbits or
+      header.hashbits > 64 or
+      header.sequences_number_bits > 64 or
+      header.sequences_length_bits > 64 or
+      header.hashbits + header.sequences_number_bits
+                      + header.sequences_length_bits
+        > CHAR_BIT * static_cast<uint64_t>(header.sizeof_unit))
+  {
+    throw std::runtime_error(std::format(": index file {} has inconsistent "
+                                         "header values: directory_bits={}, "
+                                         "hashbits={}, sequences_number_bits"
+                                         "={}, sequences_length_bits={}, "
+                                         "sizeof_unit={}",
+                                         indexfile, header.directory_bits,
+                                         header.hashbits,
+                                         header.sequences_number_bits,
+                                         header.sequences_length_bits,
+                                         header.sizeof_unit));
+  }
+  return header;
+}
+
+/* Writes an index file from hashed qgrams which are appended in
+   ascending order of their hash value. The expected number of hashed
+   qgrams determines the size of the directory. */
+template<int sizeof_unit>
+class HashedQgramsIndexWriter
+{
+  using HashedQgram = BytesUnit<sizeof_unit,3>;
+  std::string indexfile;
+  FILE *out_fp;
+  GttlBitPacker<sizeof_unit,3> hashed_qgram_packer;
+  HashedQgramsIndexHeader header;
+  std::vector<uint64_t> directory;
+  uint64_t previous_hash_value;
+
+  void write_bytes(const void *ptr, size_t size)
+  {
+    if (std::fwrite(ptr, 1, size, out_fp) != size)
+    {
+      throw std::ios_base::failure(std::format(": cannot write {} bytes to "
+                                               "index file {}",
+                                               size, indexfile));
+    }
+  }
+
+  public:
+  HashedQgramsIndexWriter(const std::string &_indexfile,
+                          const GttlBitPacker<sizeof_unit,3>
+                            &_hashed_qgram_packer,
+                          int hashbits,
+                          int sequences_number_bits,
+                          int sequences_length_bits,
+                          size_t qgram_length,
+                          size_t window_size,
+                          bool handle_both_strands,
+                          size_t expected_number_of_hashed_qgrams)
+    : indexfile(_indexfile)
+    , out_fp(std::fopen(_indexfile.c_str(),"wb"))
+    , hashed_qgram_packer(_hashed_qgram_packer)
+    , header({})
+    , directory({})
+    , previous_hash_value(0)
+  {
+    if (out_fp == nullptr)
+    {
+      throw std::ios_base::failure(std::format(": cannot create index file "
+                                               "{}", indexfile));
+    }
+    const int log_expected
+      = expected_number_of_hashed_qgrams <= 1
+          ? 1
+          : static_cast<int>(std::bit_width(expected_number_of_hashed_qgrams)
+                             - 1);
+    const int directory_bits
+      = std::max(1,std::min({log_expected,hashbits,
+                             hashed_qgrams_index_max_directory_bits}));
+    std::memcpy(header.magic,hashed_qgrams_index_magic,
+                sizeof hashed_qgrams_index_magic);
+    header.version = hashed_qgrams_index_version;
+    header.sizeof_unit = static_cast<uint8_t>(sizeof_unit);
+    header.handle_both_strands = handle_both_strands ? 1 : 0;
+    header.directory_bits = static_cast<uint8_t>(directory_bits);
+    header.qgram_length = static_cast<uint64_t>(qgram_length);
+    header.window_size = static_cast<uint64_t>(window_size);
+    header.hashbits = static_cast<uint64_t>(hashbits);
+    header.sequences_number_bits
+      = static_cast<uint64_t>(sequences_number_bits);
+    header.sequences_length_bits
+      = static_cast<uint64_t>(sequences_length_bits);
+    header.number_of_hashed_qgrams = 0;
+    directory.resize(size_t(1) << directory_bits,0);
+    /* the header is written again by finish, when the number of
+       hashed qgrams is known */
+    write_bytes(&header, sizeof header);
+  }
+
+  HashedQgramsIndexWriter(const HashedQgramsIndexWriter &) = delete;
+  HashedQgramsIndexWriter &operator=(const HashedQgramsIndexWriter &)
+    = delete;
+
+  ~HashedQgramsIndexWriter(void)
+  {
+    if (out_fp != nullptr)
+    {
+      std::fclose(out_fp);
+    }
+  }
+
+  void append(const HashedQgram &hashed_qgram)
+  {
+    assert(out_fp != nullptr);
+    const uint64_t hash_value
+      = hashed_qgram.template decode_at<0>(hashed_qgram_packer);
+    if (hash_value < previous_hash_value)
+    {
+      throw std::runtime_error(std::format(": hashed qgrams must be added "
+                                           "to index file {} in ascending "
+                                           "order of their hash values",
+                                           indexfile));
+    }
+    previous_hash_value = hash_value;
+    directory[hash_value >> (header.hashbits - header.directory_bits)]++;
+    write_bytes(&hashed_qgram, sizeof hashed_qgram);
+    header.number_of_hashed_qgrams++;
+  }
+
+  /* writes the directory and the final header and closes the file */
+  void finish(void)
+  {
+    assert(out_fp != nullptr);
+    const size_t end_of_units
+      = sizeof(HashedQgramsIndexHeader)
+        + sizeof_unit * header.number_of_hashed_qgrams;
+    const size_t padding
+      = hashed_qgrams_index_directory_offset(sizeof_unit,
+                                             header.number_of_hashed_qgrams)
+        - end_of_units;
+    static constexpr const uint8_t zeros[sizeof(uint64_t)] = {0};
+    write_bytes(&zeros[0], padding);
+    uint64_t bucket_end = 0;
+    for (auto &count : directory)
+    {
+      bucket_end += count;
+      count = bucket_end;
+    }
+    write_bytes(directory.data(), directory.size() * sizeof(uint64_t));
+    if (std::fseek(out_fp, 0, SEEK_SET) != 0)
+    {
+      throw std::ios_base::failure(std::format(": cannot seek in index file "
+                                               "{}", indexfile));
+    }
+    write_bytes(&header, sizeof header);
+    if (std::fclose(out_fp) != 0)
+    {
+      out_fp = nullptr;
+      throw std::ios_base::failure(std::format(": cannot close index file "
+                                               "{}", indexfile));
+    }
+    out_fp = nullptr;
+  }
+};
+
+/* The hashed qgrams of an index with the same hash value. */
+template<int sizeof_unit>
+class HashedQgramsIndexMatches
+{
+  using HashedQgram = BytesUnit<sizeof_unit,3>;
+  const HashedQgram *first, *last;
+  const GttlBitPacker<sizeof_unit,3> *hashed_qgram_packer;
+
+  struct Iterator
+  {
+    private:
+    const HashedQgram *ptr;
+    const GttlBitPacker<sizeof_unit,3> *hashed_qgram_packer;
+    public:
+    Iterator(const HashedQgram *_ptr,
+             const GttlBitPacker<sizeof_unit,3> *_hashed_qgram_packer)
+      : ptr(_ptr)
+      , hashed_qgram_packer(_hashed_qgram_packer)
+    {}
+    /* the sequence number and the start position */
+    std::pair<size_t,size_t> operator*(void) const noexcept
+    {
+      return {static_cast<size_t>(ptr->template decode_at<1>
+                                               (*hashed_qgram_packer)),
+              static_cast<size_t>(ptr->template decode_at<2>
+                                               (*hashed_qgram_packer))};
+    }
+    Iterator &operator++(void) noexcept
+    {
+      ptr++;
+      return *this;
+    }
+    bool operator != (const Iterator &other) const noexcept
+    {
+      return ptr != other.ptr;
+    }
+  };
+
+  public:
+  HashedQgramsIndexMatches(const HashedQgram *_first,
+                           const HashedQgram *_last,
+                           const GttlBitPacker<sizeof_unit,3>
+                             *_hashed_qgram_packer)
+    : first(_first)
+    , last(_last)
+    , hashed_qgram_packer(_hashed_qgram_packer)
+  {}
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return static_cast<size_t>(last - first);
+  }
+  [[nodiscard]] bool empty(void) const noexcept
+  {
+    return first == last;
+  }
+  [[nodiscard]] Iterator begin(void) const noexcept
+  {
+    return Iterator(first,hashed_qgram_packer);
+  }
+  [[nodiscard]] Iterator end(void) const noexcept
+  {
+    return Iterator(last,hashed_qgram_packer);
+  }
+};
+
+template<int sizeof_unit>
+class HashedQgramsIndex
+{
+  using HashedQgram = BytesUnit<sizeof_unit,3>;
+  const Gttlmmap<uint8_t> mapped_file;
+  HashedQgramsIndexHeader header;
+  GttlBitPacker<sizeof_unit,3> hashed_qgram_packer;
+  const HashedQgram *hashed_qgrams;
+  const uint64_t *directory;
+  int directory_shift;
+
+  [[nodiscard]] uint64_t hash_value_get(const HashedQgram &hashed_qgram)
+                                        const noexcept
+  {
+    return hashed_qgram.template decode_at<0>(hashed_qgram_packer);
+  }
+
+  [[nodiscard]] size_t bucket_get(uint64_t hash_value) const noexcept
+  {
+    return static_cast<size_t>(hash_value >> directory_shift);
+  }
+
+  [[nodiscard]] size_t bucket_start_get(size_t bucket) const noexcept
+  {
+    return bucket == 0 ? 0 : static_cast<size_t>(directory[bucket - 1]);
+  }
+
+  [[nodiscard]] HashedQgramsIndexMatches<sizeof_unit>
+    bucket_lookup(size_t bucket, uint64_t hash_value) const noexcept
+  {
+    const HashedQgram *const bucket_first
+      = hashed_qgrams + bucket_start_get(bucket);
+    const HashedQgram *const bucket_last = hashed_qgrams + directory[bucket];
+    const HashedQgram *first = bucket_first;
+    while (first < bucket_last and hash_value_get(*first) < hash_value)
+    {
+      first++;
+    }
+    const HashedQgram *last = first;
+    while (last < bucket_last and hash_value_get(*last) == hash_value)
+    {
+      last++;
+    }
+    return HashedQgramsIndexMatches<sizeof_unit>(first,last,
+                                                 &hashed_qgram_packer);
+  }
+
+  public:
+  explicit HashedQgramsIndex(const std::string &indexfile)
+    : mapped_file(indexfile.c_str())
+    , header(hashed_qgrams_index_header_read(indexfile))
+    , hashed_qgram_packer(GttlBitPacker<sizeof_unit,3>(
+                            {static_cast<int>(header.hashbits),
+                             static_cast<int>(header.sequences_number_bits),
+                             static_cast<int>(header.sequences_length_bits)}))
+    , hashed_qgrams(reinterpret_cast<const HashedQgram *>
+                      (mapped_file.ptr() + sizeof(HashedQgramsIndexHeader)))
+    , directory(nullptr)
+    , directory_shift(static_cast<int>(header.hashbits)
+                      - static_cast<int>(header.directory_bits))
+  {
+    if (header.sizeof_unit != static_cast<uint8_t>(sizeof_unit))
+    {
+      throw std::runtime_error(std::format(": index file {} stores units of "
+                                           "{} bytes, but {} bytes are "
+                                           "expected", indexfile,
+                                           header.sizeof_unit, sizeof_unit));
+    }
+    const size_t directory_size = size_t(1) << header.directory_bits;
+    /* the first comparison excludes an overflow when computing the
+       directory offset from a corrupted number of hashed qgrams */
+    if (header.number_of_hashed_qgrams
+          > mapped_file.size() / sizeof_unit or
+        mapped_file.size()
+          != hashed_qgrams_index_directory_offset(
+               sizeof_unit,header.number_of_hashed_qgrams)
+             + directory_size * sizeof(uint64_t))
+    {
+      throw std::runtime_error(std::format(": index file {} has size {}, "
+                                           "which is inconsistent with its "
+                                           "header", indexfile,
+                                           mapped_file.size()));
+    }
+    directory = reinterpret_cast<const uint64_t *>
+                  (mapped_file.ptr()
+                   + hashed_qgrams_index_directory_offset(
+                       sizeof_unit,header.number_of_hashed_qgrams));
+    if (directory[directory_size - 1] != header.number_of_hashed_qgrams)
+    {
+      throw std::runtime_error(std::format(": the directory of index file {} "
+                                           "ends at {}, but the header "
+                                           "stores {} hashed qgrams",
+                                           indexfile,
+                                           directory[directory_size - 1],
+                                           header.number_of_hashed_qgrams));
+    }
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return static_cast<size_t>(header.number_of_hashed_qgrams);
+  }
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return static_cast<size_t>(header.qgram_length);
+  }
+  [[nodiscard]] size_t window_size_get(void) const noexcept
+  {
+    return static_cast<size_t>(header.window_size);
+  }
+  [[nodiscard]] int hashbits_get(void) const noexcept
+  {
+    return static_cast<int>(header.hashbits);
+  }
+  [[nodiscard]] int directory_bits_get(void) const noexcept
+  {
+    return static_cast<int>(header.directory_bits);
+  }
+  [[nodiscard]] bool handle_both_strands_get(void) const noexcept
+  {
+    return header.handle_both_strands != 0;
+  }
+
+  /* the hashed qgrams with the given hash value, which must be smaller
+     than 2^hashbits */
+  [[nodiscard]] HashedQgramsIndexMatches<sizeof_unit>
+    lookup(uint64_t hash_value) const noexcept
+  {
+    assert(header.hashbits == 64 or (hash_value >> header.hashbits) == 0);
+    return bucket_lookup(bucket_get(hash_value), hash_value);
+  }
+
+  /* looks up the num_hash_values hash values and calls
+     process_matches(idx, matches) for each hash_values[idx] in order. To
+     hide the latency of the random accesses, the directory entries are
+     prefetched prefetch_distance hash values ahead and the first hashed
+     qgrams of the buckets half of this distance ahead. */
+  template<class MatchesProcessor>
+  void lookup_batch(const uint64_t *hash_values,
+                    size_t num_hash_values,
+                    MatchesProcessor process_matches) const
+  {
+    static constexpr const size_t prefetch_distance = 16;
+    for (size_t idx = 0; idx < num_hash_values; idx++)
+    {
+      if (idx + prefetch_distance < num_hash_values)
+      {
+        GTTL_PREFETCH(directory +
+                      bucket_get(hash_values[idx + prefetch_distance]));
+      }
+      if (idx + prefetch_distance/2 < num_hash_values)
+      {
+        const size_t bucket
+          = bucket_get(hash_values[idx + prefetch_distance/2]);
+        GTTL_PREFETCH(hashed_qgrams + bucket_start_get(bucket));
+      }
+      process_matches(idx, bucket_lookup(bucket_get(hash_values[idx]),
+                                         hash_values[idx]));
+    }
+  }
+};
+#endif
@@ -0,0 +1,213 @@
+#ifndef KMER_COUNTER_HPP
+#define KMER_COUNTER_HPP
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include "sequences/char_finder.hpp"
+#include "sequences/char_range.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/qgrams_hash_invint.hpp"
+#include "threading/thread_pool_var.hpp"
+#include "utilities/concurrent_count_table.hpp"
+#include "utilities/hyperloglog_table.hpp"
+#include "utilities/splitmix64.hpp"
+
+/* Exact counting of the k-mers of the sequences in a multiseq. The
+   k-mers are represented by their 2-bit integer codes, as delivered by
+   InvertibleIntegercode2Iterator4, so that the keys of the table can be
+   decoded into k-mers. If canonical is true, the smaller of the codes of
+   a k-mer and its reverse complement is counted. k-mers containing
+   wildcards are skipped. To allow several threads to work on a single
+   long sequence, the sequences are divided into segments, each
+   consisting of the k-mers starting in a range of positions. */
+
+static constexpr const char_finder::NucleotideFinder kmc_nucleotide_finder{};
+using KmerCounterRanger = GttlCharRange<char_finder::NucleotideFinder,
+                                        kmc_nucleotide_finder,
+                                        true, false>;
+
+struct KmerCounterSegment
+{
+  size_t seqnum, startpos, kmers_number;
+};
+
+static inline std::vector<KmerCounterSegment> kmer_counter_segments(
+                                                const GttlMultiseq &multiseq,
+                                                size_t qgram_length,
+                                                size_t max_segment_length)
+{
+  std::vector<KmerCounterSegment> segments{};
+  for (size_t seqnum = 0; seqnum < multiseq.sequences_number_get(); seqnum++)
+  {
+    const size_t seqlen = multiseq.sequence_length_get(seqnum);
+    if (seqlen < qgram_length)
+    {
+      continue;
+    }
+    const size_t kmers_number = seqlen - qgram_length + 1;
+    for (size_t startpos = 0; startpos < kmers_number;
+         startpos += max_segment_length)
+    {
+      segments.push_back({seqnum, startpos,
+                          std::min(max_segment_length,
+                                   kmers_number - startpos)});
+    }
+  }
+  return segments;
+}
+
+/* calls apply(code) for the (canonical) integer codes of all k-mers of
+   segment */
+template<bool canonical,class Apply>
+static void kmer_counter_segment_apply(const GttlMultiseq &multiseq,
+                                       size_t qgram_length,
+                                       const KmerCounterSegment &segment,
+                                       Apply apply)
+{
+  std::array<uint64_t,256> fwd_codes;
+  std::array<uint64_t,256> rc_codes;
+  const char *const sequence = multiseq.sequence_ptr_get(segment.seqnum)
+                               + segment.startpos;
+  const KmerCounterRanger ranger(sequence,
+                                 segment.kmers_number + qgram_length - 1);
+  for (auto const &&range : ranger)
+  {
+    const size_t this_length = std::get<1>(range);
+    if (this_length < qgram_length)
+    {
+      continue;
+    }
+    InvertibleIntegercode2Iterator4 qgiter(qgram_length,
+                                           sequence + std::get<0>(range),
+                                           this_length);
+    while (true)
+    {
+      const size_t count = qgiter.fill(fwd_codes.data(),
+                                       canonical ? rc_codes.data() : nullptr,
+                                       fwd_codes.size());
+      if (count == 0)
+      {
+        break;
+      }
+      for (size_t idx = 0; idx < count; idx++)
+      {
+        if constexpr (canonical)
+        {
+          apply(std::min(fwd_codes[idx], rc_codes[idx]));
+        } else
+        {
+          apply(fwd_codes[idx]);
+        }
+      }
+    }
+  }
+}
+
+static inline void kmer_counter_qgram_length_check(size_t qgram_length)
+{
+  if (qgram_length == 0 or qgram_length >= 32)
+  {
+    throw std::invalid_argument(std::format(": k-mer length {} is not "
+                                            "possible for exact k-mer "
+                                            "counting, it must be in the "
+                                            "range from 1 to 31",
+                                            qgram_length));
+  }
+}
+
+/* about 16 segments per thread to balance the work */
+static inline std::vector<KmerCounterSegment>
+  kmer_counter_balanced_segments(const GttlMultiseq &multiseq,
+                                 size_t qgram_length,
+                                 size_t num_threads)
+{
+  const size_t max_segment_length
+    = std::max(size_t(1) << 16,
+               multiseq.sequences_total_length_get() / (16 * num_threads));
+  return kmer_counter_segments(multiseq, qgram_length, max_segment_length);
+}
+
+/* estimates the number of distinct (canonical) k-mers of all sequences in
+   multiseq by a HyperLogLog sketch, using num_threads threads. With
+   precision 14, the relative standard error is about 0.8%. This is used
+   to determine the size of the table for kmer_counter_fill. */
+template<bool canonical>
+static size_t kmer_counter_distinct_estimate(const GttlMultiseq &multiseq,
+                                             size_t qgram_length,
+                                             size_t num_threads)
+{
+  static constexpr const size_t hll_precision = 14;
+  kmer_counter_qgram_length_check(qgram_length);
+  const std::vector<KmerCounterSegment> segments
+    = kmer_counter_balanced_segments(multiseq, qgram_length, num_threads);
+  if (segments.empty())
+  {
+    return 0;
+  }
+  std::vector<HyperLogLogTable> hll_tables(num_threads,
+                                           HyperLogLogTable(hll_precision));
+  gttl_thread_pool_var(num_threads,
+                       segments.size(),
+                       [&multiseq, &segments, &hll_tables, qgram_length]
+                       (size_t thd, size_t task_num)
+                       {
+                         HyperLogLogTable &hll_table = hll_tables[thd];
+                         kmer_counter_segment_apply<canonical>
+                           (multiseq, qgram_length, segments[task_num],
+                            [&hll_table](uint64_t code)
+                            {
+                              hll_table.add_hash(
+                                gttl_splitmix64_finalize(code));
+                            });
+                       });
+  for (size_t thd = 1; thd < num_threads; thd++)
+  {
+    hll_tables[0].merge(hll_tables[thd]);
+  }
+  return static_cast<size_t>(hll_tables[0].estimate_F0());
+}
+
+/* adds the k-mers of all sequences in multiseq to table, using
+   num_threads threads. The segments are processed in rounds of
+   4 * num_threads segments. If after a round the load factor of the
+   table exceeds 0.5, the table grows to the number of distinct k-mers
+   extrapolated from the segments processed so far. So few k-mers end up
+   in the overflow table, even if the table was too small initially. */
+template<bool canonical>
+static void kmer_counter_fill(const GttlMultiseq &multiseq,
+                              size_t qgram_length,
+                              size_t num_threads,
+                              GttlConcurrentCountTable *table)
+{
+  kmer_counter_qgram_length_check(qgram_length);
+  const std::vector<KmerCounterSegment> segments
+    = kmer_counter_balanced_segments(multiseq, qgram_length, num_threads);
+  const size_t round_size = 4 * num_threads;
+  for (size_t first = 0; first < segments.size(); first += round_size)
+  {
+    const size_t round_end = std::min(first + round_size, segments.size());
+    gttl_thread_pool_var(num_threads,
+                         round_end - first,
+                         [&multiseq, &segments, qgram_length, table, first]
+                         (size_t, size_t task_num)
+                         {
+                           kmer_counter_segment_apply<canonical>
+                             (multiseq, qgram_length,
+                              segments[first + task_num],
+                              [table](uint64_t code)
+                              {
+                                table->add(code);
+                              });
+                         });
+    if (round_end < segments.size() and table->grow_needed())
+    {
+      table->grow(table->size() * segments.size() / round_end);
+    }
+  }
+}
+#endif
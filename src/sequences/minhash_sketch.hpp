@@ -0,0 +1,333 @@
+#ifndef MINHASH_SKETCH_HPP
+#define MINHASH_SKETCH_HPP
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include "sequences/char_finder.hpp"
+#include "sequences/char_range.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/max_qgram_length.hpp"
+#include "sequences/nthash_lanes.hpp"
+#include "sequences/qgrams_hash_nthash.hpp"
+#include "threading/thread_pool_var.hpp"
+#include "utilities/sorted_intersection.hpp"
+
+/* MinHash sketches of the sets of q-grams of sequences, based on their
+   ntHash values. For DNA sequences, the smaller of the hash values of a
+   q-gram and its reverse complement is used, for protein sequences the
+   hash value of the q-gram. q-grams containing wildcards are skipped. A
+   sketch is a sorted vector of distinct hash values. A bottom-k sketch
+   consists of the sketch_size smallest hash values of the sequence, a
+   FracMinHash sketch of all hash values not larger than
+   UINT64_MAX/scale. The Jaccard index of two sketches is estimated from
+   the hash values up to the smaller of the largest hash values of
+   two bottom-k sketches of maximum size, as in Mash. */
+
+using MinHashSketch = std::vector<uint64_t>;
+
+static constexpr const char_finder::NucleotideFinder mhs_nucleotide_finder{};
+static constexpr const char_finder::AminoacidFinder mhs_aminoacid_finder{};
+using MinHashNucleotideRanger = GttlCharRange<char_finder::NucleotideFinder,
+                                              mhs_nucleotide_finder,
+                                              true, false>;
+using MinHashAminoacidRanger = GttlCharRange<char_finder::AminoacidFinder,
+                                             mhs_aminoacid_finder,
+                                             true, false>;
+
+class MinHashSketcher
+{
+  size_t qgram_length,
+         sketch_size;
+  uint64_t max_hash_value;
+  bool is_protein;
+
+  /* sorts the hash values, removes duplicates and, for a bottom-k sketch,
+     all but the sketch_size smallest values */
+  void compact(MinHashSketch *sketch) const
+  {
+    std::ranges::sort(*sketch);
+    const auto duplicates = std::ranges::unique(*sketch);
+    sketch->erase(duplicates.begin(), duplicates.end());
+    if (sketch_size > 0 and sketch->size() > sketch_size)
+    {
+      sketch->resize(sketch_size);
+    }
+  }
+
+  template<bool canonical,class HashValueIterator>
+  void range_add(const char *sequence, size_t seqlen, MinHashSketch *sketch,
+                 uint64_t *threshold) const
+  {
+    std::array<uint64_t,256> fwd_hash_values;
+    std::array<uint64_t,256> rc_hash_values;
+    HashValueIterator qgiter(qgram_length, sequence, seqlen);
+    while (true)
+    {
+      size_t count;
+      if constexpr (canonical)
+      {
+        count = qgiter.fill(fwd_hash_values.data(), rc_hash_values.data(),
+                            fwd_hash_values.size());
+      } else
+      {
+        count = qgiter.fill(fwd_hash_values.data(), fwd_hash_values.size());
+      }
+      if (count == 0)
+      {
+        break;
+      }
+      for (size_t idx = 0; idx < count; idx++)
+      {
+        const uint64_t hash_value
+          = canonical ? std::min(fwd_hash_values[idx], rc_hash_values[idx])
+                      : fwd_hash_values[idx];
+        if (hash_value <= *threshold)
+        {
+          sketch->push_back(hash_value);
+        }
+      }
+      /* for a bottom-k sketch, the candidates are reduced to the
+         sketch_size smallest whenever there are four times as many. If
+         sketch_size distinct values remain, the threshold is lowered to
+         the largest of them. Otherwise, as for repetitive sequences,
+         larger hash values may still belong to the sketch. */
+      if (sketch_size > 0 and sketch->size() >= 4 * sketch_size)
+      {
+        compact(sketch);
+        if (sketch->size() == sketch_size)
+        {
+          *threshold = sketch->back();
+        }
+      }
+    }
+  }
+
+  template<class Ranger,bool canonical,class HashValueIterator>
+  void sequence_add(const char *sequence, size_t seqlen,
+                    MinHashSketch *sketch, uint64_t *threshold) const
+  {
+    const Ranger ranger(sequence, seqlen);
+    for (auto const &&range : ranger)
+    {
+      const size_t this_length = std::get<1>(range);
+      if (this_length >= qgram_length)
+      {
+        range_add<canonical,HashValueIterator>(sequence + std::get<0>(range),
+                                               this_length, sketch,
+                                               threshold);
+      }
+    }
+  }
+
+  public:
+  /* if scale is 0, bottom-k sketches of sketch_size hash values are
+     computed, otherwise FracMinHash sketches */
+  MinHashSketcher(size_t _qgram_length, size_t _sketch_size, size_t scale,
+                  bool _is_protein)
+    : qgram_length(_qgram_length)
+    , sketch_size(scale > 0 ? 0 : _sketch_size)
+    , max_hash_value(scale > 0 ? UINT64_MAX / scale : UINT64_MAX)
+    , is_protein(_is_protein)
+  {
+    if (qgram_length == 0)
+    {
+      throw std::invalid_argument(": q-gram length of MinHash sketches must "
+                                  "be positive");
+    }
+    if (not is_protein and qgram_length > 32)
+    {
+      throw std::invalid_argument(std::format(": q-gram length {} is not "
+                                              "possible for MinHash "
+                                              "sketches of DNA sequences, it "
+                                              "must be in the range from 1 to "
+                                              "32", qgram_length));
+    }
+    /* the window of the hash function of protein q-grams holds at most
+       MAX_QGRAM_LENGTH characters */
+    if (is_protein and qgram_length > MAX_QGRAM_LENGTH)
+    {
+      throw std::invalid_argument(std::format(": q-gram length {} is not "
+                                              "possible for MinHash "
+                                              "sketches of protein "
+                                              "sequences, it must be in the "
+                                              "range from 1 to {}",
+                                              qgram_length,
+                                              MAX_QGRAM_LENGTH));
+    }
+    if (scale == 0 and sketch_size == 0)
+    {
+      throw std::invalid_argument(": either the sketch size or the scale "
+                                  "of MinHash sketches must be positive");
+    }
+  }
+
+  [[nodiscard]] MinHashSketch sketch(const char *sequence, size_t seqlen)
+                                     const
+  {
+    MinHashSketch this_sketch{};
+    uint64_t threshold = max_hash_value;
+    if (is_protein)
+    {
+      sequence_add<MinHashAminoacidRanger,false,QgramNtHashAAFwdIterator20>
+                  (sequence, seqlen, &this_sketch, &threshold);
+    } else
+    {
+      sequence_add<MinHashNucleotideRanger,true,QgramNtHashLanesIterator4>
+                  (sequence, seqlen, &this_sketch, &threshold);
+    }
+    compact(&this_sketch);
+    this_sketch.shrink_to_fit();
+    return this_sketch;
+  }
+
+  /* the sketch of the union of the sets represented by the given
+     sketches */
+  [[nodiscard]] MinHashSketch merge(const std::vector<MinHashSketch>
+                                      &sketches) const
+  {
+    MinHashSketch merged{};
+    for (auto &this_sketch : sketches)
+    {
+      merged.insert(merged.end(), this_sketch.begin(), this_sketch.end());
+    }
+    compact(&merged);
+    return merged;
+  }
+
+  /* one sketch for each sequence of multiseq, computed by num_threads
+     threads */
+  [[nodiscard]] std::vector<MinHashSketch> sketches(
+                                             const GttlMultiseq &multiseq,
+                                             size_t num_threads) const
+  {
+    std::vector<MinHashSketch> all_sketches(multiseq.sequences_number_get());
+    if (all_sketches.empty())
+    {
+      return all_sketches;
+    }
+    gttl_thread_pool_var(num_threads,
+                         all_sketches.size(),
+                         [this, &multiseq, &all_sketches]
+                         (size_t, size_t seqnum)
+                         {
+                           all_sketches[seqnum]
+                             = sketch(multiseq.sequence_ptr_get(seqnum),
+                                      multiseq.sequence_length_get(seqnum));
+                         });
+    return all_sketches;
+  }
+
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+
+  [[nodiscard]] size_t sketch_size_get(void) const noexcept
+  {
+    return sketch_size;
+  }
+};
+
+struct MinHashDistance
+{
+  size_t shared,
+         union_size;
+  double jaccard,
+         mash_distance;
+};
+
+/* sketch_size is 0 for FracMinHash sketches */
+static inline MinHashDistance minhash_distance(const MinHashSketch &a,
+                                               const MinHashSketch &b,
+                                               size_t sketch_size,
+                                               size_t qgram_length)
+{
+  /* a bottom-k sketch with less than sketch_size values contains all
+     hash values of its sequence */
+  const uint64_t a_threshold
+    = (sketch_size > 0 and a.size() == sketch_size) ? a.back() : UINT64_MAX;
+  const uint64_t b_threshold
+    = (sketch_size > 0 and b.size() == sketch_size) ? b.back() : UINT64_MAX;
+  const uint64_t threshold = std::min(a_threshold, b_threshold);
+  const size_t a_len = static_cast<size_t>(std::ranges::upper_bound(a,
+                                                                    threshold)
+                                           - a.begin());
+  const size_t b_len = static_cast<size_t>(std::ranges::upper_bound(b,
+                                                                    threshold)
+                                           - b.begin());
+  const size_t shared = sorted_intersection_size(a.data(), a_len,
+                                                 b.data(), b_len);
+  const size_t union_size = a_len + b_len - shared;
+  const double jaccard = union_size == 0
+                           ? 0.0
+                           : static_cast<double>(shared)
+                               / static_cast<double>(union_size);
+  const double mash_distance
+    = shared == 0 ? 1.0
+                  : (shared == union_size
+                       ? 0.0
+                       : std::min(1.0,
+                                  -std::log(2.0 * jaccard / (1.0 + jaccard))
+                                    / static_cast<double>(qgram_length)));
+  return {shared, union_size, jaccard, mash_distance};
+}
+
+/* A comparator for all_against_all_compare_pairs, which stores the pairs
+   of sketches with a Mash distance of at most max_distance */
+class MinHashComparator
+{
+  public:
+  struct Result
+  {
+    size_t ref_idx,
+           query_idx;
+    MinHashDistance distance;
+  };
+  private:
+  size_t sketch_size,
+         qgram_length;
+  double max_distance;
+  const MinHashSketch *reference;
+  std::vector<Result> results;
+
+  public:
+  MinHashComparator(size_t _sketch_size, size_t _qgram_length,
+                    double _max_distance)
+    : sketch_size(_sketch_size)
+    , qgram_length(_qgram_length)
+    , max_distance(_max_distance)
+    , reference(nullptr)
+    , results({})
+  {}
+
+  void preprocess(size_t, const MinHashSketch &ref_sketch)
+  {
+    reference = &ref_sketch;
+  }
+
+  bool compare(size_t ref_idx, size_t query_idx,
+               const MinHashSketch &query_sketch)
+  {
+    assert(reference != nullptr);
+    const MinHashDistance distance
+      = minhash_distance(*reference, query_sketch, sketch_size, qgram_length);
+    if (distance.mash_distance <= max_distance)
+    {
+      results.push_back({ref_idx, query_idx, distance});
+    }
+    return false;
+  }
+
+  [[nodiscard]] const std::vector<Result> &results_get(void) const noexcept
+  {
+    return results;
+  }
+};
+#endif
@@ -0,0 +1,90 @@
+#ifndef MINIMIZER_QUEUE_HPP
+#define MINIMIZER_QUEUE_HPP
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* The monotone queue used for computing the minimizers of a sliding window
+   of window_size q-grams. It stores pairs of hash values and payloads, e.g.
+   positions, such that the hash values increase from the front to the
+   back. As each element is appended and removed at most once, the amortized
+   cost per q-gram is constant. The elements are stored in a ring buffer
+   whose size is the smallest power of 2 larger than window_size. It is
+   allocated once, so that no memory is allocated when sliding the window,
+   in contrast to a std::deque. */
+
+class GttlMinimizerQueue
+{
+  std::vector<uint64_t> hash_values, payloads;
+  size_t mask, first, num_elems;
+
+  [[nodiscard]] size_t back_index(void) const noexcept
+  {
+    assert(num_elems > 0);
+    return (first + num_elems - 1) & mask;
+  }
+
+  public:
+  explicit GttlMinimizerQueue(size_t window_size)
+    : hash_values(std::bit_ceil(window_size + 1))
+    , payloads(hash_values.size())
+    , mask(hash_values.size() - 1)
+    , first(0)
+    , num_elems(0)
+  {}
+
+  void clear(void) noexcept
+  {
+    first = num_elems = 0;
+  }
+
+  [[nodiscard]] bool empty(void) const noexcept
+  {
+    return num_elems == 0;
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return num_elems;
+  }
+
+  /* removes all elements with a hash value larger than hash_value from the
+     back of the queue and then appends the new element. So of several
+     elements with the same hash value, the first one stays in front.
+     Returns true if and only if the new element is the front element. */
+  bool push_back(uint64_t hash_value, uint64_t payload) noexcept
+  {
+    while (num_elems > 0 and hash_values[back_index()] > hash_value)
+    {
+      num_elems--;
+    }
+    assert(num_elems < hash_values.size());
+    const size_t idx = (first + num_elems) & mask;
+    hash_values[idx] = hash_value;
+    payloads[idx] = payload;
+    num_elems++;
+    return num_elems == 1;
+  }
+
+  void pop_front(void) noexcept
+  {
+    assert(num_elems > 0);
+    first = (first + 1) & mask;
+    num_elems--;
+  }
+
+  [[nodiscard]] uint64_t front_hash_value_get(void) const noexcept
+  {
+    assert(num_elems > 0);
+    return hash_values[first];
+  }
+
+  [[nodiscard]] uint64_t front_payload_get(void) const noexcept
+  {
+    assert(num_elems > 0);
+    return payloads[first];
+  }
+};
+#endif
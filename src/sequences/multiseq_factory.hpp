@@ -8,6 +8,7 @@
 #include <cstdio>
 #include "sequences/gttl_fasta_generator.hpp"
 #include "sequences/gttl_fastq_generator.hpp"
+#include "sequences/fastq_pair_reader.hpp"
 #include "sequences/gttl_multiseq.hpp"
 
 class GttlMultiseqFactory
@@ -21,7 +22,7 @@ class GttlMultiseqFactory
   [[nodiscard]] size_t
   fastq_file_total_length_get(const std::string &inputfile) const
   {
-    GttlFastQGenerator<buf_size> fastq_it(inputfile.c_str());
+    GttlFastQGenerator<buf_size,false> fastq_it(inputfile.c_str());
     size_t sequences_total_length = 0;
     for (const auto *it : fastq_it)
     {
@@ -61,22 +62,24 @@ class GttlMultiseqFactory
                       : num_sequences;
     size_t seqnum = 0;
     size_t current_part_number_of_units = 0;
-    GttlFastQGenerator<buf_size> fastq_it0(fastq_file0.c_str());
-    GttlFastQGenerator<buf_size> fastq_it1(fastq_file1.c_str());
-    auto it0 = fastq_it0.begin();
-    auto it1 = fastq_it1.begin();
-    while(it0 != fastq_it0.end() and it1 != fastq_it1.end())
+    /* both files are parsed concurrently, the pairs are delivered in
+       order */
+    gttl_fastq_pairs_read<buf_size,false>(
+      fastq_file0,
+      fastq_file1,
+      [&](size_t idx,const GttlFastQBatch &batch0,
+          const GttlFastQBatch &batch1)
     {
       if (current_part_number_of_units < number_of_units_in_split)
       {
-        auto sequence0 = (*it0)->sequence_get();
-        multiseq->append((*it0)->header_get(),
+        auto sequence0 = batch0.sequence_get(idx);
+        multiseq->append(batch0.header_get(idx),
                          sequence0,
                          store_header,
                          store_sequence,
                          padding_char);
-        auto sequence1 = (*it1)->sequence_get();
-        multiseq->append((*it1)->header_get(),
+        auto sequence1 = batch1.sequence_get(idx);
+        multiseq->append(batch1.header_get(idx),
                          sequence1,
                          store_header,
                          store_sequence,
@@ -103,14 +106,14 @@ class GttlMultiseqFactory
                                       seqnum,
                                       has_read_pairs,
                                       with_reverse_complement);
-          auto sequence0 = (*it0)->sequence_get();
-          multiseq->append((*it0)->header_get(),
+          auto sequence0 = batch0.sequence_get(idx);
+          multiseq->append(batch0.header_get(idx),
                            sequence0,
                            store_header,
                            store_sequence,
                            padding_char);
-          auto sequence1 = (*it1)->sequence_get();
-          multiseq->append((*it1)->header_get(),
+          auto sequence1 = batch1.sequence_get(idx);
+          multiseq->append(batch1.header_get(idx),
                            sequence1,
                            store_header,
                            store_sequence,
@@ -125,10 +128,8 @@ class GttlMultiseqFactory
           current_part_number_of_units = 0;
         }
       }
-      ++it0;
-      ++it1;
       seqnum += 2;
-    }
+    });
     if (multiseq != nullptr and multiseq->sequences_number_get() > 0)
     {
       if (short_header)
@@ -1,14 +1,18 @@
 #ifndef NTCARD_HPP
 #define NTCARD_HPP
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <ios>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <format>
 #include "sequences/gttl_fasta_generator.hpp"
@@ -16,18 +20,187 @@
 #include "utilities/gttl_file_open.hpp"
 #include "utilities/has_fasta_or_fastq_extension.hpp"
 #include "sequences/split.hpp"
+#include "sequences/sequences_chunk_reader.hpp"
 #include "sequences/dna_seq_encoder.hpp"
 #include "sequences/dna_seq_decoder.hpp"
 #include "utilities/runtime_class.hpp"
 
+/* adds the hash values delivered by qgiter to table. The hash values
+   are obtained in blocks, so that the loop adding them is not
+   interrupted by the computation of the hash values */
+template <class HashValueIterator,class TableClass>
+static void ntcard_hash_values_add(HashValueIterator *qgiter,
+                                   TableClass *table)
+{
+  std::array<uint64_t,256> hash_values;
+  while (true)
+  {
+    const size_t count = qgiter->fill(hash_values.data(),
+                                      hash_values.size());
+    if (count == 0)
+    {
+      break;
+    }
+    for (size_t idx = 0; idx < count; idx++)
+    {
+      table->add_hash(hash_values[idx]);
+    }
+  }
+}
+
+/* merges other_tables into first_table. If TableClass provides a merge
+   of several tables with num_threads threads, this is used. */
+template<class TableClass>
+static void ntcard_tables_merge(TableClass *first_table,
+                                const std::vector<const TableClass *>
+                                  &other_tables,
+                                size_t num_threads)
+{
+  if constexpr (requires { first_table->merge(other_tables, num_threads); })
+  {
+    first_table->merge(other_tables, num_threads);
+  } else
+  {
+    for (auto other_table : other_tables)
+    {
+      first_table->merge(*other_table);
+    }
+  }
+}
+
+/* One table of class TableClass for each of several qgram lengths. All
+   tables are filled in a single pass over the input, so that reading,
+   decompressing and parsing the input as well as splitting the
+   sequences at wildcards is done only once. For each qgram length,
+   the hash values are computed by a separate HashValueIterator, as the
+   rolling hash values of qgrams of different lengths cannot be derived
+   from each other. Like any TableClass, an NtCardMultiTable is copied for
+   each thread and the copies are merged at the end. So with t threads and
+   m qgram lengths, t * m tables are stored, e.g. 8 * 9 tables of 2^27
+   counters of 2 bytes, i.e. 18 GB, for NtTable with r = 27. The counters
+   are not shared by the threads, as atomic saturating additions of small
+   counters would be much slower than the merge. Use a smaller r or fewer
+   threads if this does not fit into memory. */
+template<class TableClass>
+class NtCardMultiTable
+{
+  std::vector<size_t> qgram_lengths;
+  std::vector<TableClass> tables;
+
+  public:
+  /* each of the tables is a copy of empty_table */
+  NtCardMultiTable(const std::vector<size_t> &_qgram_lengths,
+                   const TableClass &empty_table)
+    : qgram_lengths(_qgram_lengths)
+    , tables(_qgram_lengths.size(), empty_table)
+  {
+    assert(not qgram_lengths.empty());
+  }
+
+  template<class HashValueIterator,typename SequenceBaseType>
+  void sequence_add(const SequenceBaseType *sequence, size_t seqlen)
+  {
+    for (size_t idx = 0; idx < qgram_lengths.size(); idx++)
+    {
+      if (seqlen >= qgram_lengths[idx])
+      {
+        HashValueIterator qgiter(qgram_lengths[idx], sequence, seqlen);
+        ntcard_hash_values_add(&qgiter, &tables[idx]);
+      }
+    }
+  }
+
+  void merge(const NtCardMultiTable &other)
+  {
+    assert(qgram_lengths == other.qgram_lengths);
+    for (size_t idx = 0; idx < tables.size(); idx++)
+    {
+      tables[idx].merge(other.tables[idx]);
+    }
+  }
+
+  void merge(const std::vector<const NtCardMultiTable *> &others,
+             size_t num_threads)
+  {
+    std::vector<const TableClass *> other_tables(others.size());
+    for (size_t idx = 0; idx < tables.size(); idx++)
+    {
+      for (size_t other_idx = 0; other_idx < others.size(); other_idx++)
+      {
+        assert(qgram_lengths == others[other_idx]->qgram_lengths);
+        other_tables[other_idx] = &others[other_idx]->tables[idx];
+      }
+      ntcard_tables_merge(&tables[idx], other_tables, num_threads);
+    }
+  }
+
+  void sequences_number_set(size_t sequences_number)
+  {
+    for (auto &table : tables)
+    {
+      table.sequences_number_set(sequences_number);
+    }
+  }
+
+  [[nodiscard]] size_t sequences_number_get(void) const noexcept
+  {
+    return tables[0].sequences_number_get();
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return tables.size();
+  }
+
+  [[nodiscard]] size_t qgram_length_get(size_t idx) const noexcept
+  {
+    assert(idx < qgram_lengths.size());
+    return qgram_lengths[idx];
+  }
+
+  [[nodiscard]] size_t min_qgram_length_get(void) const noexcept
+  {
+    return std::ranges::min(qgram_lengths);
+  }
+
+  [[nodiscard]] const TableClass &table_get(size_t idx) const noexcept
+  {
+    assert(idx < tables.size());
+    return tables[idx];
+  }
+};
+
+/* adds the hash values of all qgrams of the given sequence to table. For
+   an NtCardMultiTable this is done for all of its qgram lengths, which
+   must not be smaller than qgram_length. */
+template <class HashValueIterator,class TableClass,typename SequenceBaseType>
+static void ntcard_sequence_add(const SequenceBaseType *sequence,
+                                size_t seqlen,
+                                size_t qgram_length,
+                                TableClass *table)
+{
+  if constexpr (requires { table->template sequence_add<HashValueIterator>
+                                                       (sequence, seqlen); })
+  {
+    table->template sequence_add<HashValueIterator>(sequence, seqlen);
+  } else
+  {
+    if (seqlen >= qgram_length)
+    {
+      HashValueIterator qgiter(qgram_length, sequence, seqlen);
+      ntcard_hash_values_add(&qgiter, table);
+    }
+  }
+}
+
 template <bool split_at_wildcard,
           class SeqGenerator,
           class HashValueIterator,
           class TableClass,
           bool is_aminoacid>
-static void ntcard_enumerate_inner(SeqGenerator* gttl_si,
-                                   TableClass* table,
-                                   size_t qgram_length)
+static size_t ntcard_enumerate_inner(SeqGenerator* gttl_si,
+                                     TableClass* table,
+                                     size_t qgram_length)
 {
   size_t sequences_number = 0;
   for (auto &&si : *gttl_si)
@@ -43,30 +216,22 @@ static void ntcard_enumerate_inner(SeqGenerator* gttl_si,
         if (this_length >= qgram_length)
         {
           const char *const substring = sequence.data() + std::get<0>(range);
-          HashValueIterator qgiter(qgram_length, substring, this_length);
-          for (auto const &&code_pair : qgiter)
-          {
-            const uint64_t this_hash = std::get<0>(code_pair);
-            table->add_hash(this_hash);
-          }
+          ntcard_sequence_add<HashValueIterator>(substring, this_length,
+                                                 qgram_length, table);
         }
       }
     } else
     {
       if (sequence.size() >= qgram_length)
       {
-        HashValueIterator qgiter(qgram_length, sequence.data(),
-                                 sequence.size());
-        for (auto const &&code_pair : qgiter)
-        {
-          const uint64_t this_hash = std::get<0>(code_pair);
-          table->add_hash(this_hash);
-        }
+        ntcard_sequence_add<HashValueIterator>(sequence.data(),
+                                               sequence.size(),
+                                               qgram_length, table);
       }
     }
     sequences_number++;
   }
-  table->sequences_number_set(sequences_number);
+  return sequences_number;
 }
 
 template <bool split_at_wildcard,
@@ -75,11 +240,10 @@ template <bool split_at_wildcard,
           bool is_aminoacid>
 static TableClass ntcard_enumerate_seq(const std::string &inputfilename,
                                        size_t qgram_length,
-                                       size_t s_value,
-                                       size_t r_value)
+                                       const TableClass &empty_table)
 {
   static constexpr const int buf_size = 1 << 14;
-  TableClass table(s_value, r_value);
+  TableClass table(empty_table);
   if (gttl_likely_fasta_format(inputfilename))
   {
     const GttlFpType in_fp = gttl_fp_type_open(inputfilename.c_str(), "rb");
@@ -89,21 +253,25 @@ static TableClass ntcard_enumerate_seq(const std::string &inputfilename,
       /* check_err.py checked */
     }
     GttlFastAGenerator<buf_size> gttl_si(in_fp);
-    ntcard_enumerate_inner<split_at_wildcard,
-                           GttlFastAGenerator<buf_size>,
-                           HashValueIterator,
-                           TableClass,
-                           is_aminoacid>
-                          (&gttl_si, &table, qgram_length);
+    table.sequences_number_set(ntcard_enumerate_inner<split_at_wildcard,
+                                                      GttlFastAGenerator
+                                                        <buf_size>,
+                                                      HashValueIterator,
+                                                      TableClass,
+                                                      is_aminoacid>
+                                                     (&gttl_si, &table,
+                                                      qgram_length));
   } else
   {
-    GttlFastQGenerator<buf_size> fastq_it(inputfilename.c_str());
-    ntcard_enumerate_inner<split_at_wildcard,
-                           GttlFastQGenerator<buf_size>,
-                           HashValueIterator,
-                           TableClass,
-                           is_aminoacid>
-                          (&fastq_it, &table, qgram_length);
+    GttlFastQGenerator<buf_size,false> fastq_it(inputfilename.c_str());
+    table.sequences_number_set(ntcard_enumerate_inner<split_at_wildcard,
+                                                      GttlFastQGenerator
+                                                        <buf_size,false>,
+                                                      HashValueIterator,
+                                                      TableClass,
+                                                      is_aminoacid>
+                                                     (&fastq_it, &table,
+                                                      qgram_length));
   }
   return table;
 }
@@ -114,18 +282,17 @@ template <bool split_at_wildcard,
           bool is_aminoacid>
 static TableClass ntcard_enumerate_thd(const std::string &inputfilename,
                                        size_t qgram_length,
-                                       size_t s_value,
-                                       size_t r_value,
+                                       const TableClass &empty_table,
                                        size_t num_threads)
 {
   assert(num_threads > 1);
   const bool fasta_format = gttl_likely_fasta_format(inputfilename);
   SequencesSplit sequence_parts(num_threads, inputfilename, fasta_format);
-  TableClass first_table(s_value,r_value);
+  TableClass first_table(empty_table);
   std::vector<TableClass *> other_tables;
   for (size_t thd_num = 1; thd_num < sequence_parts.size(); thd_num++)
   {
-    other_tables.push_back(new TableClass(s_value, r_value));
+    other_tables.push_back(new TableClass(empty_table));
   }
   std::vector<std::thread> threads;
   constexpr const size_t buf_size = size_t{1} << size_t{14};
@@ -137,15 +304,16 @@ static TableClass ntcard_enumerate_thd(const std::string &inputfilename,
                                      &sequence_parts,thd_num,qgram_length]
       {
         GttlFastAGenerator<buf_size> gttl_si(sequence_parts[thd_num]);
-        ntcard_enumerate_inner<split_at_wildcard,
-                               GttlFastAGenerator<buf_size>,
-                               HashValueIterator,
-                               TableClass,
-                               is_aminoacid>
-                              (&gttl_si,
-                               thd_num == 0 ? &first_table
-                                            : other_tables[thd_num-1],
-                               qgram_length);
+        TableClass *const table = thd_num == 0 ? &first_table
+                                               : other_tables[thd_num-1];
+        table->sequences_number_set(ntcard_enumerate_inner<split_at_wildcard,
+                                                           GttlFastAGenerator
+                                                             <buf_size>,
+                                                           HashValueIterator,
+                                                           TableClass,
+                                                           is_aminoacid>
+                                                          (&gttl_si, table,
+                                                           qgram_length));
       }));
     }
   } else
@@ -156,17 +324,18 @@ static TableClass ntcard_enumerate_thd(const std::string &inputfilename,
                                      &sequence_parts,thd_num,qgram_length]
       {
         const std::string_view &this_view =  sequence_parts[thd_num];
-        GttlFastQGenerator<buf_size> fastq_it(this_view.data(),
-                                              this_view.size());
-        ntcard_enumerate_inner<split_at_wildcard,
-                               GttlFastQGenerator<buf_size>,
-                               HashValueIterator,
-                               TableClass,
-                               is_aminoacid>
-                              (&fastq_it,
-                               thd_num == 0 ? &first_table
-                                            : other_tables[thd_num-1],
-                               qgram_length);
+        GttlFastQGenerator<buf_size,false> fastq_it(this_view.data(),
+                                                    this_view.size());
+        TableClass *const table = thd_num == 0 ? &first_table
+                                               : other_tables[thd_num-1];
+        table->sequences_number_set(ntcard_enumerate_inner<split_at_wildcard,
+                                                           GttlFastQGenerator
+                                                             <buf_size,false>,
+                                                           HashValueIterator,
+                                                           TableClass,
+                                                           is_aminoacid>
+                                                          (&fastq_it, table,
+                                                           qgram_length));
       }));
     }
   }
@@ -174,11 +343,93 @@ static TableClass ntcard_enumerate_thd(const std::string &inputfilename,
   {
     th.join();
   }
-  for (size_t thd_num = 1; thd_num < sequence_parts.size(); thd_num++)
+  ntcard_tables_merge(&first_table,
+                      std::vector<const TableClass *>(other_tables.begin(),
+                                                      other_tables.end()),
+                      num_threads);
+  for (auto other_table : other_tables)
+  {
+    delete other_table;
+  }
+  return first_table;
+}
+
+/* enumerates the hash values of the sequences delivered by a chunk reader,
+   used for input which cannot be memory mapped, like the standard input
+   or a named pipe. Each thread repeatedly fetches the next chunk from
+   the reader and adds the hash values of its sequences to its own
+   table. */
+template <bool split_at_wildcard,
+          class HashValueIterator,
+          class TableClass,
+          bool is_aminoacid>
+static TableClass ntcard_enumerate_chunks(GttlSequencesChunkReader
+                                            *chunk_reader,
+                                          size_t qgram_length,
+                                          const TableClass &empty_table,
+                                          size_t num_threads)
+{
+  assert(num_threads > 0);
+  TableClass first_table(empty_table);
+  std::vector<std::unique_ptr<TableClass>> other_tables;
+  for (size_t thd_num = 1; thd_num < num_threads; thd_num++)
+  {
+    other_tables.push_back(std::make_unique<TableClass>(empty_table));
+  }
+  constexpr const size_t buf_size = size_t{1} << size_t{14};
+  const bool fasta_format = chunk_reader->fasta_format_get();
+  auto process_chunks = [&first_table,&other_tables,chunk_reader,fasta_format,
+                         qgram_length]
+                        (size_t thd_num)
+  {
+    TableClass *const table = thd_num == 0 ? &first_table
+                                           : other_tables[thd_num-1].get();
+    std::string chunk{};
+    size_t sequences_number = 0;
+    while (std::get<0>(chunk_reader->next(chunk)))
+    {
+      if (fasta_format)
+      {
+        GttlFastAGenerator<buf_size> gttl_si{std::string_view(chunk)};
+        sequences_number += ntcard_enumerate_inner<split_at_wildcard,
+                                                   GttlFastAGenerator
+                                                     <buf_size>,
+                                                   HashValueIterator,
+                                                   TableClass,
+                                                   is_aminoacid>
+                                                  (&gttl_si, table,
+                                                   qgram_length);
+      } else
+      {
+        GttlFastQGenerator<buf_size,false> fastq_it(chunk.data(), chunk.size());
+        sequences_number += ntcard_enumerate_inner<split_at_wildcard,
+                                                   GttlFastQGenerator
+                                                     <buf_size,false>,
+                                                   HashValueIterator,
+                                                   TableClass,
+                                                   is_aminoacid>
+                                                  (&fastq_it, table,
+                                                   qgram_length);
+      }
+    }
+    table->sequences_number_set(sequences_number);
+  };
+  std::vector<std::thread> threads;
+  for (size_t thd_num = 1; thd_num < num_threads; thd_num++)
+  {
+    threads.emplace_back(process_chunks, thd_num);
+  }
+  process_chunks(0);
+  for (auto &th : threads)
+  {
+    th.join();
+  }
+  std::vector<const TableClass *> other_table_ptrs{};
+  for (auto &other_table : other_tables)
   {
-    first_table.merge(*other_tables[thd_num-1]);
-    delete other_tables[thd_num-1];
+    other_table_ptrs.push_back(other_table.get());
   }
+  ntcard_tables_merge(&first_table, other_table_ptrs, num_threads);
   return first_table;
 }
 
@@ -203,12 +454,8 @@ static void process_encoded_sequence_part(
       std::vector<uint8_t> ds = dna_sequence_decode(sub_unit_ptr,
                                                    sequence_length);
       assert(sequence_length == ds.size());
-      HashValueIterator qgiter(qgram_length, ds.data(), sequence_length);
-      for (auto const &&code_pair : qgiter)
-      {
-        const uint64_t this_hash = std::get<0>(code_pair);
-        table->add_hash(this_hash);
-      }
+      ntcard_sequence_add<HashValueIterator>(ds.data(), sequence_length,
+                                             qgram_length, table);
     }
   }
 }
@@ -221,10 +468,9 @@ static TableClass ntcard_enumerate_thd_gz(const DNAEncodingMultiLength
                                             <uint64_t,split_at_wildcard,false>
                                             &dna_encoding_multi_length,
                                           size_t qgram_length,
-                                          size_t s_value,
-                                          size_t r_value)
+                                          const TableClass &empty_table)
 {
-  TableClass first_table(s_value,r_value);
+  TableClass first_table(empty_table);
   if (dna_encoding_multi_length.num_parts_get() == 1)
   {
     process_encoded_sequence_part<split_at_wildcard,
@@ -239,7 +485,7 @@ static TableClass ntcard_enumerate_thd_gz(const DNAEncodingMultiLength
   for (size_t thd_num = 1; thd_num < dna_encoding_multi_length.num_parts_get();
        thd_num++)
   {
-    other_tables.push_back(new TableClass(s_value, r_value));
+    other_tables.push_back(new TableClass(empty_table));
   }
   std::vector<std::thread> threads;
 
@@ -266,11 +512,13 @@ static TableClass ntcard_enumerate_thd_gz(const DNAEncodingMultiLength
   {
     th.join();
   }
-  for (size_t thd_num = 1; thd_num < dna_encoding_multi_length.num_parts_get();
-       thd_num++)
+  ntcard_tables_merge(&first_table,
+                      std::vector<const TableClass *>(other_tables.begin(),
+                                                      other_tables.end()),
+                      dna_encoding_multi_length.num_parts_get());
+  for (auto other_table : other_tables)
   {
-    first_table.merge(*other_tables[thd_num-1]);
-    delete other_tables[thd_num-1];
+    delete other_table;
   }
   return first_table;
 }
@@ -282,10 +530,37 @@ template <bool split_at_wildcard,
           bool is_aminoacid>
 static TableClass ntcard_enumerate(const std::string &inputfilename,
                                    size_t qgram_length,
-                                   size_t s_value,
-                                   size_t r_value,
-                                   size_t num_threads)
+                                   const TableClass &empty_table,
+                                   size_t num_threads,
+                                   GttlSequencesChunkReader *chunk_reader
+                                     = nullptr)
 {
+  if (chunk_reader != nullptr or gttl_is_stream_input(inputfilename))
+  {
+    RunTimeClass rt_enumerate{};
+    std::unique_ptr<GttlSequencesChunkReader> local_reader{};
+    if (chunk_reader == nullptr)
+    {
+      local_reader
+        = std::make_unique<GttlSequencesChunkReader>(inputfilename);
+      chunk_reader = local_reader.get();
+    }
+    auto table = ntcard_enumerate_chunks<split_at_wildcard,
+                                         HashValueIterator,
+                                         TableClass,
+                                         is_aminoacid>
+                                        (chunk_reader,
+                                         qgram_length,
+                                         empty_table,
+                                         num_threads);
+    const std::string msg = std::format("ntcard.enumerate, {}, {}, {} threads,"
+                                        " streamed",
+                                        inputfilename,
+                                        is_aminoacid ? "protein" : "DNA",
+                                        num_threads);
+    rt_enumerate.show(msg.c_str());
+    return table;
+  }
   if (num_threads == 1)
   {
     RunTimeClass rt_enumerate{};
@@ -295,8 +570,7 @@ static TableClass ntcard_enumerate(const std::string &inputfilename,
                                       is_aminoacid>
                                      (inputfilename,
                                       qgram_length,
-                                      s_value,
-                                      r_value);
+                                      empty_table);
     const std::string msg = std::format("ntcard.enumerate, {}, {}, 1 thread",
                                         inputfilename,
                                         is_aminoacid ? "protein" : "DNA");
@@ -317,8 +591,7 @@ static TableClass ntcard_enumerate(const std::string &inputfilename,
                                          is_aminoacid>
                                         (dna_encoding_multi_length,
                                          qgram_length,
-                                         s_value,
-                                         r_value);
+                                         empty_table);
     table.sequences_number_set(dna_encoding_multi_length
                                   .total_number_of_sequences_get());
     const std::string msg = std::format("ntcard.enumerate {}, {}, {} threads",
@@ -335,8 +608,7 @@ static TableClass ntcard_enumerate(const std::string &inputfilename,
                                     is_aminoacid>
                                    (inputfilename,
                                     qgram_length,
-                                    s_value,
-                                    r_value,
+                                    empty_table,
                                     num_threads);
   const std::string msg = std::format("ntcard.enumerate, {}, {}, {} threads",
                                       inputfilename,
@@ -345,4 +617,28 @@ static TableClass ntcard_enumerate(const std::string &inputfilename,
   rt_enumerate.show(msg.c_str());
   return table;
 }
+
+template <bool split_at_wildcard,
+          class HashValueIterator,
+          class HashValueIteratorNoTransform,
+          class TableClass,
+          bool is_aminoacid>
+static TableClass ntcard_enumerate(const std::string &inputfilename,
+                                   size_t qgram_length,
+                                   size_t s_value,
+                                   size_t r_value,
+                                   size_t num_threads,
+                                   GttlSequencesChunkReader *chunk_reader
+                                     = nullptr)
+{
+  return ntcard_enumerate<split_at_wildcard,
+                          HashValueIterator,
+                          HashValueIteratorNoTransform,
+                          TableClass,
+                          is_aminoacid>(inputfilename,
+                                        qgram_length,
+                                        TableClass(s_value, r_value),
+                                        num_threads,
+                                        chunk_reader);
+}
 #endif
@@ -111,6 +111,20 @@ class NThashTransformer
         = (msTab31l[idx][qgram_length % 31] | msTab33r[idx][qgram_length % 33]);
     }
   }
+  /* the seed of the given rank, which is xored to the hash value when a
+     character of this rank is shifted into the q-gram */
+  [[nodiscard]] static uint64_t seed_get(uint8_t rank) noexcept
+  {
+    assert(rank < uint8_t(4));
+    return nt_hash_seed_table[rank];
+  }
+  /* the value xored to the hash value when a character of the given rank
+     is shifted out of the q-gram */
+  [[nodiscard]] uint64_t shift_out_value_get(uint8_t rank) const noexcept
+  {
+    assert(rank < uint8_t(4));
+    return msTab31l_33r_or[rank];
+  }
   static uint64_t first_fwd_hash_value_get(const uint8_t *t_sequence,
                                     size_t qgram_length)  noexcept
   {
@@ -0,0 +1,807 @@
+#ifndef NTHASH_LANES_HPP
+#define NTHASH_LANES_HPP
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sequences/alphabet.hpp"
+#include "sequences/max_qgram_length.hpp"
+#include "sequences/nthash_fwd.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* The operations on vectors of 64 bit hash values required to roll
+   the ntHash values of several lanes at once. Depending on the instruction
+   set the vectors have 8 (AVX-512), 4 (AVX2), 2 (NEON) or 1 (no SIMD)
+   elements. A table lookup delivers for each element the entry of a table
+   of size 4 selected by a rank in the range 0 to 3. */
+
+#if defined(__AVX512F__)
+struct GttlNtHashVector
+{
+  using Type = __m512i;
+  using Table = __m512i;
+  static constexpr const size_t width = 8;
+  /* the masked forms of the intrinsics with all bits set are used,
+     as the unmasked forms lead to false warnings of gcc about
+     uninitialized values */
+  static constexpr const __mmask8 all_lanes = 0xFF;
+  static Table table_set(const std::array<uint64_t,4> &table) noexcept
+  {
+    return _mm512_set_epi64(static_cast<int64_t>(table[3]),
+                            static_cast<int64_t>(table[2]),
+                            static_cast<int64_t>(table[1]),
+                            static_cast<int64_t>(table[0]),
+                            static_cast<int64_t>(table[3]),
+                            static_cast<int64_t>(table[2]),
+                            static_cast<int64_t>(table[1]),
+                            static_cast<int64_t>(table[0]));
+  }
+  static Type lookup(Table table, Type ranks) noexcept
+  {
+    return _mm512_maskz_permutexvar_epi64(all_lanes, ranks, table);
+  }
+  static Type bit_xor(Type a, Type b) noexcept
+  {
+    return _mm512_xor_si512(a, b);
+  }
+  static Type rotate_left_1(Type v) noexcept
+  {
+    return _mm512_maskz_rol_epi64(all_lanes, v, 1);
+  }
+  static Type rotate_right_1(Type v) noexcept
+  {
+    return _mm512_maskz_ror_epi64(all_lanes, v, 1);
+  }
+  template<int shift>
+  static Type shift_left(Type v) noexcept
+  {
+    return _mm512_maskz_slli_epi64(all_lanes, v, shift);
+  }
+  template<int shift>
+  static Type shift_right(Type v) noexcept
+  {
+    return _mm512_maskz_srli_epi64(all_lanes, v, shift);
+  }
+  static Type bit_and_1(Type v) noexcept
+  {
+    return _mm512_and_si512(v, _mm512_set1_epi64(1));
+  }
+  static Type zero(void) noexcept { return _mm512_setzero_si512(); }
+  static Type low_byte(Type v) noexcept
+  {
+    return _mm512_and_si512(v, _mm512_set1_epi64(UINT8_MAX));
+  }
+  static Type min(Type a, Type b) noexcept
+  {
+    return _mm512_maskz_min_epu64(all_lanes, a, b);
+  }
+  static void store(uint64_t *out, Type v) noexcept
+  {
+    _mm512_storeu_si512(out, v);
+  }
+  static Type load(const uint64_t *in) noexcept
+  {
+    return _mm512_loadu_si512(in);
+  }
+};
+#elif defined(__AVX2__)
+struct GttlNtHashVector
+{
+  using Type = __m256i;
+  using Table = __m256i;
+  static constexpr const size_t width = 4;
+  static Table table_set(const std::array<uint64_t,4> &table) noexcept
+  {
+    return _mm256_set_epi64x(static_cast<int64_t>(table[3]),
+                             static_cast<int64_t>(table[2]),
+                             static_cast<int64_t>(table[1]),
+                             static_cast<int64_t>(table[0]));
+  }
+  /* selects the two 32 bit halves of the entries via a permutation
+     of 32 bit values */
+  static Type lookup(Table table, Type ranks) noexcept
+  {
+    const Type low = _mm256_slli_epi64(ranks, 1);
+    const Type high = _mm256_add_epi64(low, _mm256_set1_epi64x(1));
+    return _mm256_permutevar8x32_epi32(table,
+                                       _mm256_or_si256(low,
+                                                       _mm256_slli_epi64(high,
+                                                                         32)));
+  }
+  static Type bit_xor(Type a, Type b) noexcept
+  {
+    return _mm256_xor_si256(a, b);
+  }
+  static Type rotate_left_1(Type v) noexcept
+  {
+    return _mm256_or_si256(_mm256_slli_epi64(v, 1), _mm256_srli_epi64(v, 63));
+  }
+  static Type rotate_right_1(Type v) noexcept
+  {
+    return _mm256_or_si256(_mm256_srli_epi64(v, 1), _mm256_slli_epi64(v, 63));
+  }
+  template<int shift>
+  static Type shift_left(Type v) noexcept
+  {
+    return _mm256_slli_epi64(v, shift);
+  }
+  template<int shift>
+  static Type shift_right(Type v) noexcept
+  {
+    return _mm256_srli_epi64(v, shift);
+  }
+  static Type bit_and_1(Type v) noexcept
+  {
+    return _mm256_and_si256(v, _mm256_set1_epi64x(1));
+  }
+  static Type zero(void) noexcept { return _mm256_setzero_si256(); }
+  static Type low_byte(Type v) noexcept
+  {
+    return _mm256_and_si256(v, _mm256_set1_epi64x(UINT8_MAX));
+  }
+  /* AVX2 only provides a signed comparison of 64 bit values */
+  static Type min(Type a, Type b) noexcept
+  {
+    const Type sign = _mm256_set1_epi64x(INT64_MIN);
+    const Type a_greater = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign),
+                                              _mm256_xor_si256(b, sign));
+    return _mm256_blendv_epi8(a, b, a_greater);
+  }
+  static void store(uint64_t *out, Type v) noexcept
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v);
+  }
+  static Type load(const uint64_t *in) noexcept
+  {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+  }
+};
+#elif defined(__ARM_NEON)
+struct GttlNtHashVector
+{
+  using Type = uint64x2_t;
+  using Table = std::array<uint64_t,4>;
+  static constexpr const size_t width = 2;
+  static Table table_set(const std::array<uint64_t,4> &table) noexcept
+  {
+    return table;
+  }
+  static Type lookup(const Table &table, Type ranks) noexcept
+  {
+    const uint64_t two_values[] = {table[vgetq_lane_u64(ranks, 0)],
+                                   table[vgetq_lane_u64(ranks, 1)]};
+    return vld1q_u64(&two_values[0]);
+  }
+  static Type bit_xor(Type a, Type b) noexcept { return veorq_u64(a, b); }
+  static Type rotate_left_1(Type v) noexcept
+  {
+    return vorrq_u64(vshlq_n_u64(v, 1), vshrq_n_u64(v, 63));
+  }
+  static Type rotate_right_1(Type v) noexcept
+  {
+    return vorrq_u64(vshrq_n_u64(v, 1), vshlq_n_u64(v, 63));
+  }
+  template<int shift>
+  static Type shift_left(Type v) noexcept { return vshlq_n_u64(v, shift); }
+  template<int shift>
+  static Type shift_right(Type v) noexcept { return vshrq_n_u64(v, shift); }
+  static Type bit_and_1(Type v) noexcept
+  {
+    return vandq_u64(v, vdupq_n_u64(1));
+  }
+  static Type zero(void) noexcept { return vdupq_n_u64(0); }
+  static Type low_byte(Type v) noexcept
+  {
+    return vandq_u64(v, vdupq_n_u64(UINT8_MAX));
+  }
+  static Type min(Type a, Type b) noexcept
+  {
+    return vbslq_u64(vcgtq_u64(a, b), b, a);
+  }
+  static void store(uint64_t *out, Type v) noexcept { vst1q_u64(out, v); }
+  static Type load(const uint64_t *in) noexcept { return vld1q_u64(in); }
+};
+#else
+struct GttlNtHashVector
+{
+  using Type = uint64_t;
+  using Table = std::array<uint64_t,4>;
+  static constexpr const size_t width = 1;
+  static Table table_set(const std::array<uint64_t,4> &table) noexcept
+  {
+    return table;
+  }
+  static Type lookup(const Table &table, Type rank) noexcept
+  {
+    return table[rank];
+  }
+  static Type bit_xor(Type a, Type b) noexcept { return a ^ b; }
+  static Type rotate_left_1(Type v) noexcept { return (v << 1) | (v >> 63); }
+  static Type rotate_right_1(Type v) noexcept { return (v >> 1) | (v << 63); }
+  template<int shift>
+  static Type shift_left(Type v) noexcept { return v << shift; }
+  template<int shift>
+  static Type shift_right(Type v) noexcept { return v >> shift; }
+  static Type bit_and_1(Type v) noexcept { return v & uint64_t(1); }
+  static Type zero(void) noexcept { return 0; }
+  static Type low_byte(Type v) noexcept { return v & uint64_t(UINT8_MAX); }
+  static Type min(Type a, Type b) noexcept { return a < b ? a : b; }
+  static void store(uint64_t *out, Type v) noexcept { *out = v; }
+  static Type load(const uint64_t *in) noexcept { return *in; }
+};
+#endif
+
+/* Computes the ntHash values of the q-grams of num_lanes independent
+   lanes at once, where num_lanes is a multiple of the number of elements
+   of the SIMD vectors available. Using more than one vector per lane
+   group hides the latency of the operations. The hash values are the
+   same as delivered by QgramNtHashIterator4: the forward hash values,
+   the hash values of the reverse complements and the canonical hash
+   values, i.e. the minimum of both.
+
+   The lanes may refer to different sequences or to different segments of
+   the same sequence, see the methods lanes_hash and chunk_hash. The
+   sequences must consist of the characters A, C, G and T (in upper or
+   lower case) only, e.g. because they are the ranges delivered by a
+   NucleotideRanger. chunk_hash throws an exception for other
+   characters. */
+
+template<size_t num_lanes = 2 * GttlNtHashVector::width>
+class GttlNtHashLanes
+{
+  using Vector = GttlNtHashVector;
+  using VectorType = typename Vector::Type;
+  static_assert(num_lanes > 0 and num_lanes % Vector::width == 0);
+  static constexpr const size_t num_vectors = num_lanes / Vector::width;
+  static constexpr const GttlAlphabet<alphabet::nucleotides_upper_lower,4>
+    alphabet{};
+
+  NThashTransformer transformer;
+  size_t qgram_length;
+  typename Vector::Table seed_table, shift_out_table,
+                         compl_seed_table, compl_shift_out_table;
+  /* the maximum number of q-grams hashed by chunk_hash */
+  static constexpr const size_t chunk_size = num_lanes * 512;
+  /* the minimum length of a segment, in multiples of the q-gram length,
+     for which the lanes are used */
+  static constexpr const size_t min_segment_factor = 4;
+  std::vector<uint8_t> rank_buffer;
+  std::vector<uint64_t> fwd_hash_values, rc_hash_values, fwd_block, rc_block;
+  size_t num_qgrams;
+
+  static VectorType swapbits033(VectorType v) noexcept
+  {
+    const VectorType x
+      = Vector::bit_and_1(Vector::bit_xor(v, Vector::template
+                                                     shift_right<33>(v)));
+    return Vector::bit_xor(v, Vector::bit_xor(x, Vector::template
+                                                    shift_left<33>(x)));
+  }
+
+  static VectorType swapbits3263(VectorType v) noexcept
+  {
+    const VectorType x
+      = Vector::bit_and_1(Vector::bit_xor(Vector::template shift_right<32>(v),
+                                          Vector::template
+                                                  shift_right<63>(v)));
+    return Vector::bit_xor(v, Vector::bit_xor(Vector::template
+                                                      shift_left<32>(x),
+                                              Vector::template
+                                                      shift_left<63>(x)));
+  }
+
+  /* the ranks at positions idx to idx + 7 as a little endian word,
+     where ranks beyond num_ranks are 0 */
+  static uint64_t ranks_word_get(const uint8_t *ranks, size_t idx,
+                                 size_t num_ranks) noexcept
+  {
+    uint64_t word = 0;
+    if (std::endian::native == std::endian::little and
+        idx + sizeof word <= num_ranks)
+    {
+      std::memcpy(&word, ranks + idx, sizeof word);
+    } else
+    {
+      for (size_t shift = 0; idx < num_ranks; idx++, shift += CHAR_BIT)
+      {
+        word |= static_cast<uint64_t>(ranks[idx]) << shift;
+      }
+    }
+    return word;
+  }
+
+  public:
+  explicit GttlNtHashLanes(size_t _qgram_length)
+    : transformer(_qgram_length)
+    , qgram_length(_qgram_length)
+    , rank_buffer({})
+    , fwd_hash_values({})
+    , rc_hash_values({})
+    , fwd_block({})
+    , rc_block({})
+    , num_qgrams(0)
+  {
+    assert(qgram_length > 0 and qgram_length <= MAX_QGRAM_LENGTH);
+    std::array<uint64_t,4> seeds{}, shift_out_values{},
+                           compl_seeds{}, compl_shift_out_values{};
+    for (uint8_t rank = 0; rank < uint8_t(4); rank++)
+    {
+      seeds[rank] = NThashTransformer::seed_get(rank);
+      shift_out_values[rank] = transformer.shift_out_value_get(rank);
+      /* the complement of rank r is 3 - r */
+      compl_seeds[rank]
+        = NThashTransformer::seed_get(static_cast<uint8_t>(3 - rank));
+      compl_shift_out_values[rank]
+        = transformer.shift_out_value_get(static_cast<uint8_t>(3 - rank));
+    }
+    seed_table = Vector::table_set(seeds);
+    shift_out_table = Vector::table_set(shift_out_values);
+    compl_seed_table = Vector::table_set(compl_seeds);
+    compl_shift_out_table = Vector::table_set(compl_shift_out_values);
+  }
+
+  [[nodiscard]] static constexpr size_t lanes_get(void) noexcept
+  {
+    return num_lanes;
+  }
+
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+
+  /* Computes the hash values of the first num_qgrams q-grams of each
+     lane. lane_ranks[l] refers to the ranks of lane l, which must provide
+     at least num_qgrams + qgram_length - 1 ranks in the range 0 to 3.
+     The hash values are stored in blocks of num_lanes values, one block
+     for each q-gram position, i.e. the forward hash value of the q-gram of
+     lane l at position step is stored in fwd_block[step * num_lanes + l].
+     So the hash values can be stored without rearranging the SIMD
+     vectors. If rc_block or canonical_block is not nullptr, the hash values
+     of the reverse complements or the canonical hash values are stored in
+     the same way. */
+  void lanes_hash(const std::array<const uint8_t *,num_lanes> &lane_ranks,
+                  size_t num_qgrams,
+                  uint64_t *fwd_block,
+                  uint64_t *rc_block,
+                  uint64_t *canonical_block) const noexcept
+  {
+    if (num_qgrams == 0)
+    {
+      return;
+    }
+    alignas(64) uint64_t fwd_values[num_lanes], rc_values[num_lanes];
+    for (size_t lane = 0; lane < num_lanes; lane++)
+    {
+      const auto hash_pair
+        = NThashTransformer::first_hash_value_pair_get(lane_ranks[lane],
+                                                       qgram_length);
+      fwd_values[lane] = hash_pair.first;
+      rc_values[lane] = hash_pair.second;
+    }
+    VectorType fwd[num_vectors], rc[num_vectors],
+               in_ranks[num_vectors], out_ranks[num_vectors];
+    for (size_t vidx = 0; vidx < num_vectors; vidx++)
+    {
+      fwd[vidx] = Vector::load(&fwd_values[0] + vidx * Vector::width);
+      rc[vidx] = Vector::load(&rc_values[0] + vidx * Vector::width);
+      in_ranks[vidx] = out_ranks[vidx] = Vector::zero();
+    }
+    /* The ranks of the characters shifted in and out are loaded as words
+       of 8 ranks per lane, and in each step the rank in the least
+       significant byte is used and shifted out. */
+    alignas(64) uint64_t in_words[num_lanes], out_words[num_lanes];
+    const size_t num_ranks = num_qgrams + qgram_length - 1;
+    for (size_t step = 0; /* Nothing */; step++)
+    {
+      for (size_t vidx = 0; vidx < num_vectors; vidx++)
+      {
+        const size_t offset = step * num_lanes + vidx * Vector::width;
+        Vector::store(fwd_block + offset, fwd[vidx]);
+        if (rc_block != nullptr)
+        {
+          Vector::store(rc_block + offset, rc[vidx]);
+        }
+        if (canonical_block != nullptr)
+        {
+          Vector::store(canonical_block + offset,
+                        Vector::min(fwd[vidx], rc[vidx]));
+        }
+      }
+      if (step + 1 == num_qgrams)
+      {
+        break;
+      }
+      if (step % sizeof(uint64_t) == 0)
+      {
+        for (size_t lane = 0; lane < num_lanes; lane++)
+        {
+          out_words[lane] = ranks_word_get(lane_ranks[lane], step, num_ranks);
+          in_words[lane] = ranks_word_get(lane_ranks[lane],
+                                          step + qgram_length, num_ranks);
+        }
+        for (size_t vidx = 0; vidx < num_vectors; vidx++)
+        {
+          in_ranks[vidx] = Vector::load(&in_words[0] + vidx * Vector::width);
+          out_ranks[vidx] = Vector::load(&out_words[0]
+                                         + vidx * Vector::width);
+        }
+      }
+      for (size_t vidx = 0; vidx < num_vectors; vidx++)
+      {
+        const VectorType in_rank = Vector::low_byte(in_ranks[vidx]);
+        const VectorType out_rank = Vector::low_byte(out_ranks[vidx]);
+        in_ranks[vidx] = Vector::template shift_right<8>(in_ranks[vidx]);
+        out_ranks[vidx] = Vector::template shift_right<8>(out_ranks[vidx]);
+        /* forward strand: rotate, then add the new and remove the
+           old character */
+        fwd[vidx] = Vector::bit_xor(
+                      Vector::bit_xor(swapbits033(Vector::rotate_left_1(
+                                                    fwd[vidx])),
+                                      Vector::lookup(seed_table, in_rank)),
+                      Vector::lookup(shift_out_table, out_rank));
+        /* reverse strand: add the complement of the new character at the
+           front and remove the complement of the old character, then
+           rotate */
+        rc[vidx] = swapbits3263(Vector::rotate_right_1(
+                     Vector::bit_xor(
+                       Vector::bit_xor(rc[vidx],
+                                       Vector::lookup(compl_shift_out_table,
+                                                      in_rank)),
+                       Vector::lookup(compl_seed_table, out_rank))));
+      }
+    }
+  }
+
+  /* Computes the ntHash values of the at most min(chunk_size, max_qgrams)
+     q-grams starting at positions start, start + 1, ... of sequence of
+     length seqlen and,
+     if with_rc is true, of their reverse complements. For this the
+     q-grams are divided into num_lanes segments of equal length, each of
+     which is processed by one lane. The at most num_lanes - 1 remaining
+     q-grams are hashed by the scalar method. As a chunk fits into the
+     cache, the hash values can be stored in the order of the positions at
+     little cost. Returns the number of q-grams hashed. Throws an
+     exception if the chunk contains a character other than A, C, G and
+     T. */
+  size_t chunk_hash(const char *sequence, size_t seqlen, size_t start,
+                    bool with_rc, size_t max_qgrams = SIZE_MAX)
+  {
+    assert(seqlen >= qgram_length and start <= seqlen - qgram_length);
+    num_qgrams = std::min({chunk_size, max_qgrams,
+                           seqlen - qgram_length + 1 - start});
+    const size_t num_ranks = num_qgrams + qgram_length - 1;
+    rank_buffer.resize(num_ranks);
+    /* the ranks of wildcards are larger than 3, so it suffices to check
+       the bitwise or of all ranks */
+    uint8_t all_ranks = 0;
+    for (size_t idx = 0; idx < num_ranks; idx++)
+    {
+      rank_buffer[idx] = alphabet.char_to_rank(sequence[start + idx]);
+      all_ranks |= rank_buffer[idx];
+    }
+    if (all_ranks > uint8_t(3))
+    {
+      const size_t wildcard_pos
+        = static_cast<size_t>(std::ranges::find_if(rank_buffer,
+                                                   [](uint8_t rank)
+                                                   {
+                                                     return rank > 3;
+                                                   })
+                              - rank_buffer.begin());
+      throw std::invalid_argument(std::format(": ntHash lanes require a "
+                                              "sequence without wildcards, "
+                                              "but position {} contains the "
+                                              "character '{}'",
+                                              start + wildcard_pos,
+                                              sequence[start +
+                                                       wildcard_pos]));
+    }
+    fwd_hash_values.resize(num_qgrams);
+    if (with_rc)
+    {
+      rc_hash_values.resize(num_qgrams);
+    }
+    /* Each lane starts with the hash value of a complete q-gram. If the
+       segments are short, this does not pay off and all q-grams are
+       hashed by the scalar method. */
+    const size_t segment_length
+      = num_qgrams / num_lanes >= min_segment_factor * qgram_length
+          ? num_qgrams / num_lanes
+          : 0;
+    if (segment_length > 0)
+    {
+      std::array<const uint8_t *,num_lanes> lane_ranks;
+      for (size_t lane = 0; lane < num_lanes; lane++)
+      {
+        lane_ranks[lane] = rank_buffer.data() + lane * segment_length;
+      }
+      fwd_block.resize(num_lanes * segment_length);
+      if (with_rc)
+      {
+        rc_block.resize(num_lanes * segment_length);
+      }
+      lanes_hash(lane_ranks, segment_length, fwd_block.data(),
+                 with_rc ? rc_block.data() : nullptr, nullptr);
+      for (size_t lane = 0; lane < num_lanes; lane++)
+      {
+        uint64_t *const fwd_dest = fwd_hash_values.data()
+                                   + lane * segment_length;
+        for (size_t step = 0; step < segment_length; step++)
+        {
+          fwd_dest[step] = fwd_block[step * num_lanes + lane];
+        }
+        if (with_rc)
+        {
+          uint64_t *const rc_dest = rc_hash_values.data()
+                                    + lane * segment_length;
+          for (size_t step = 0; step < segment_length; step++)
+          {
+            rc_dest[step] = rc_block[step * num_lanes + lane];
+          }
+        }
+      }
+    }
+    const size_t scalar_start = num_lanes * segment_length;
+    if (scalar_start < num_qgrams)
+    {
+      const uint8_t *const ranks = rank_buffer.data();
+      auto [fwd, rc]
+        = NThashTransformer::first_hash_value_pair_get(ranks + scalar_start,
+                                                       qgram_length);
+      for (size_t pos = scalar_start; /* Nothing */; pos++)
+      {
+        fwd_hash_values[pos] = fwd;
+        if (with_rc)
+        {
+          rc_hash_values[pos] = rc;
+        }
+        if (pos + 1 == num_qgrams)
+        {
+          break;
+        }
+        const uint8_t out_rank = ranks[pos];
+        const uint8_t in_rank = ranks[pos + qgram_length];
+        fwd = transformer.next_hash_value_get(out_rank, fwd, in_rank);
+        rc = transformer.next_compl_hash_value_get(
+               static_cast<uint8_t>(3 - out_rank), rc,
+               static_cast<uint8_t>(3 - in_rank));
+      }
+    }
+    return num_qgrams;
+  }
+
+  /* the number of q-grams hashed by the last call of chunk_hash */
+  [[nodiscard]] size_t num_qgrams_get(void) const noexcept
+  {
+    return num_qgrams;
+  }
+
+  /* the hash values of the q-grams of the last chunk in the order of
+     their positions */
+  [[nodiscard]] const uint64_t *fwd_hash_values_get(void) const noexcept
+  {
+    return fwd_hash_values.data();
+  }
+
+  [[nodiscard]] const uint64_t *rc_hash_values_get(void) const noexcept
+  {
+    return rc_hash_values.data();
+  }
+
+  /* Stores the ntHash values of the q-grams of sequence in the order of
+     their positions in fwd_out and, if rc_out or canonical_out is not
+     nullptr, the hash values of the reverse complements or the canonical
+     hash values. */
+  void hash_values_get(const char *sequence,
+                       size_t seqlen,
+                       uint64_t *fwd_out,
+                       uint64_t *rc_out,
+                       uint64_t *canonical_out)
+  {
+    if (seqlen < qgram_length)
+    {
+      return;
+    }
+    const bool with_rc = rc_out != nullptr or canonical_out != nullptr;
+    for (size_t start = 0; start + qgram_length <= seqlen;
+         start += num_qgrams)
+    {
+      chunk_hash(sequence, seqlen, start, with_rc);
+      std::copy(fwd_hash_values.begin(),
+                fwd_hash_values.begin() + num_qgrams, fwd_out + start);
+      if (rc_out != nullptr)
+      {
+        std::copy(rc_hash_values.begin(),
+                  rc_hash_values.begin() + num_qgrams, rc_out + start);
+      }
+      if (canonical_out != nullptr)
+      {
+        for (size_t idx = 0; idx < num_qgrams; idx++)
+        {
+          canonical_out[start + idx] = std::min(fwd_hash_values[idx],
+                                                rc_hash_values[idx]);
+        }
+      }
+    }
+  }
+};
+
+/* A replacement for QgramNtHashFwdIterator4 (with_rc = false) and
+   QgramNtHashIterator4 (with_rc = true) for wildcard free sequences,
+   which computes the hash values chunk by chunk with GttlNtHashLanes.
+   So it can be used as template argument for ntCard, the enumeration of
+   minimizers and HashedQgramsGeneric. As the first hash value of each
+   lane is computed by the scalar method, this pays off for sequences
+   which are much longer than the number of lanes. */
+
+template<bool with_rc,size_t num_lanes = 2 * GttlNtHashVector::width>
+class QgramNtHashLanesIteratorGeneric
+{
+  public:
+  using Transformer = NThashTransformer;
+  static constexpr const bool possible_false_positive_matches
+    = NThashTransformer::possible_false_positive_matches;
+  static constexpr const GttlAlphabet<alphabet::nucleotides_upper_lower,4>
+    alphabet{};
+  static constexpr const bool handle_both_strands = with_rc;
+
+  private:
+  using ValueType = std::conditional_t<with_rc,
+                                       std::pair<uint64_t,uint64_t>,
+                                       std::pair<uint64_t,uint8_t>>;
+  GttlNtHashLanes<num_lanes> nthash_lanes,
+                             fill_lanes;
+  const char *sequence;
+  size_t seqlen,
+         fill_chunk_start, /* the first q-gram hashed by fill_lanes */
+         fill_next; /* the q-gram to be delivered next by fill */
+
+  struct Iterator
+  {
+    private:
+      GttlNtHashLanes<num_lanes> *nthash_lanes;
+      const char *sequence;
+      size_t seqlen, chunk_start, chunk_end, pos;
+      const uint64_t *fwd_hash_values, *rc_hash_values;
+
+      void chunk_next(void)
+      {
+        chunk_start = pos;
+        chunk_end = chunk_start
+                    + nthash_lanes->chunk_hash(sequence, seqlen, chunk_start,
+                                               with_rc);
+        fwd_hash_values = nthash_lanes->fwd_hash_values_get();
+        rc_hash_values = nthash_lanes->rc_hash_values_get();
+      }
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = ValueType;
+      using difference_type = size_t;
+
+      Iterator(GttlNtHashLanes<num_lanes> *_nthash_lanes,
+               const char *_sequence, size_t _seqlen, size_t _pos)
+        : nthash_lanes(_nthash_lanes)
+        , sequence(_sequence)
+        , seqlen(_seqlen)
+        , chunk_start(_pos)
+        , chunk_end(_pos)
+        , pos(_pos)
+        , fwd_hash_values(nullptr)
+        , rc_hash_values(nullptr)
+      {
+        if (pos + nthash_lanes->qgram_length_get() <= seqlen)
+        {
+          chunk_next();
+        }
+      }
+      ValueType operator*() const noexcept
+      {
+        const size_t idx = pos - chunk_start;
+        if constexpr (with_rc)
+        {
+          return {fwd_hash_values[idx], rc_hash_values[idx]};
+        } else
+        {
+          return {fwd_hash_values[idx], uint8_t(0)};
+        }
+      }
+      Iterator& operator++() /* prefix increment*/
+      {
+        pos++;
+        if (pos == chunk_end and
+            pos + nthash_lanes->qgram_length_get() <= seqlen)
+        {
+          chunk_next();
+        }
+        return *this;
+      }
+      bool operator != (const Iterator& other) const noexcept
+      {
+        return pos != other.pos;
+      }
+  };
+
+  public:
+  QgramNtHashLanesIteratorGeneric(size_t qgram_length,
+                                  const char *_sequence,
+                                  size_t _seqlen)
+    : nthash_lanes(qgram_length)
+    , fill_lanes(qgram_length)
+    , sequence(_sequence)
+    , seqlen(_seqlen)
+    , fill_chunk_start(0)
+    , fill_next(0)
+  {}
+  Iterator begin(void)
+  {
+    return Iterator(&nthash_lanes, sequence, seqlen, 0);
+  }
+  Iterator end(void)
+  {
+    const size_t qgram_length = nthash_lanes.qgram_length_get();
+    return Iterator(&nthash_lanes, sequence, seqlen,
+                    seqlen >= qgram_length ? seqlen - qgram_length + 1 : 0);
+  }
+  /* Stores the hash values of the next at most max q-grams in fwd_out
+     and, if rc_out is not nullptr, in rc_out. Returns the number of
+     q-grams, which is 0 if all q-grams have been delivered. The hash
+     values are computed for a complete chunk, independently of max, and
+     delivered by the following calls, so that the first hash value of
+     each lane is only computed once per chunk. Either all calls must
+     supply rc_out or none. */
+  size_t fill(uint64_t *fwd_out, uint64_t *rc_out, size_t max)
+  {
+    size_t stored = 0;
+    while (stored < max and
+           fill_next + fill_lanes.qgram_length_get() <= seqlen)
+    {
+      if (fill_next == fill_chunk_start + fill_lanes.num_qgrams_get())
+      {
+        fill_chunk_start = fill_next;
+        fill_lanes.chunk_hash(sequence, seqlen, fill_next,
+                              rc_out != nullptr);
+      }
+      const size_t offset = fill_next - fill_chunk_start;
+      const size_t available
+        = std::min(max - stored, fill_lanes.num_qgrams_get() - offset);
+      std::copy(fill_lanes.fwd_hash_values_get() + offset,
+                fill_lanes.fwd_hash_values_get() + offset + available,
+                fwd_out + stored);
+      if (rc_out != nullptr)
+      {
+        std::copy(fill_lanes.rc_hash_values_get() + offset,
+                  fill_lanes.rc_hash_values_get() + offset + available,
+                  rc_out + stored);
+      }
+      stored += available;
+      fill_next += available;
+    }
+    return stored;
+  }
+  size_t fill(uint64_t *out, size_t max)
+  {
+    return fill(out, nullptr, max);
+  }
+};
+
+using QgramNtHashLanesFwdIterator4 = QgramNtHashLanesIteratorGeneric<false>;
+using QgramNtHashLanesIterator4 = QgramNtHashLanesIteratorGeneric<true>;
+#endif
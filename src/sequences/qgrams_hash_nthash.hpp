@@ -44,6 +44,13 @@ using QgramNtHashIterator4
                               4,
                               NThashTransformer>;
 
+template<uint8_t undefined_rank>
+using QgramNtHashIteratorGenericNoTransform
+  = QgramRecHashValueIterator<alphabet::nucleotides_upper_lower,
+                              undefined_rank,
+                              NThashTransformer,
+                              uint8_t>;
+
 
 template <uint8_t undefined_rank>
 using QgramNtHashAAFwdIteratorGeneric =
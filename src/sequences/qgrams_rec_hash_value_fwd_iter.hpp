@@ -16,6 +16,7 @@
 */
 #ifndef QGRAMS_REC_HASH_VALUE_FWD_ITER_HPP
 #define QGRAMS_REC_HASH_VALUE_FWD_ITER_HPP
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
@@ -38,6 +39,7 @@ template<const char *_char_spec,
 class QgramRecHashValueFwdIterator
 {
   public:
+  using Transformer = QgramTransformer;
   static constexpr const bool possible_false_positive_matches
     = QgramTransformer::possible_false_positive_matches;
   static constexpr const GttlAlphabet<_char_spec,_undefined_rank> alphabet{};
@@ -130,10 +132,23 @@ class QgramRecHashValueFwdIterator
     const SequenceBaseType *sequence;
     size_t seqlen;
     CyclicBuffer_uint8 current_window;
+    size_t fill_next;          /* the q-gram to be delivered next by fill */
+    uint64_t fill_hash_value;  /* the hash value of q-gram fill_next - 1 */
 #ifndef NDEBUG
     const uint64_t max_integer_code;
     uint8_t qgram_buffer[MAX_QGRAM_LENGTH];
 #endif
+    static uint8_t rank_get(SequenceBaseType cc) noexcept
+    {
+      if constexpr (std::is_same_v<SequenceBaseType,char>)
+      {
+        return alphabet.char_to_rank(cc);
+      } else
+      {
+        static_assert(std::is_same_v<SequenceBaseType,uint8_t>);
+        return cc;
+      }
+    }
   public:
     QgramRecHashValueFwdIterator(size_t _qgram_length,
                                  const SequenceBaseType *_sequence,
@@ -142,6 +157,8 @@ class QgramRecHashValueFwdIterator
       , qgram_length(_qgram_length)
       , sequence(_sequence)
       , seqlen(_seqlen)
+      , fill_next(0)
+      , fill_hash_value(0)
 #ifndef NDEBUG
       , max_integer_code(qgram_length == 32 ? UINT64_MAX
                                             : (std::pow(alpha_size,
@@ -186,6 +203,47 @@ class QgramRecHashValueFwdIterator
     {
       return Iterator(current_window, sequence + seqlen, qgram_transformer);
     }
+    /* Stores the hash values of the next at most max q-grams of the
+       sequence in out and returns their number, which is 0 if all
+       q-grams have been delivered. The hash values are the same as
+       delivered by the iterator, but the wildcards in the q-grams are not
+       counted. So fill should be applied to sequences without wildcards,
+       e.g. the ranges delivered by NtCardRanger. */
+    size_t fill(uint64_t *out, size_t max)
+    {
+      if (qgram_length > seqlen)
+      {
+        return 0;
+      }
+      const size_t end = std::min(seqlen - qgram_length + 1, fill_next + max);
+      const size_t start = fill_next;
+      uint64_t hash_value = fill_hash_value;
+      size_t pos = start;
+      if (pos == 0 and pos < end)
+      {
+        for (const SequenceBaseType *qgram_ptr = sequence + qgram_length - 1;
+             qgram_ptr >= sequence; qgram_ptr--)
+        {
+          current_window.prepend(rank_get(*qgram_ptr));
+        }
+        hash_value = qgram_transformer.first_fwd_hash_value_get(
+                                         current_window.pointer_to_array(),
+                                         qgram_length);
+        out[0] = hash_value;
+        pos++;
+      }
+      for (/* Nothing */; pos < end; pos++)
+      {
+        hash_value = qgram_transformer.next_hash_value_get(
+                       rank_get(sequence[pos - 1]),
+                       hash_value,
+                       rank_get(sequence[pos + qgram_length - 1]));
+        out[pos - start] = hash_value;
+      }
+      fill_next = end;
+      fill_hash_value = hash_value;
+      return end - start;
+    }
     /* The following functions are for qgram integer codes only */
     std::pair<uint64_t,uint8_t> qgram_encode(const SequenceBaseType *qgram)
     {
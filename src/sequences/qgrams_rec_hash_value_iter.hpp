@@ -16,12 +16,14 @@
 */
 #ifndef QGRAMS_REC_HASH_VALUE_ITER_HPP
 #define QGRAMS_REC_HASH_VALUE_ITER_HPP
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cassert>
 #include <cmath>
 #include <iterator>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include "utilities/cyclic_buffer.hpp"
 #include "sequences/alphabet.hpp"
@@ -29,14 +31,18 @@
 #include "sequences/complement_uint8.hpp"
 
 /* Implementation of iterator class follows concept described in
-   https://davidgorski.ca/posts/stl-iterators/ */
+   https://davidgorski.ca/posts/stl-iterators/
+   If SequenceBaseType is uint8_t, the sequence consists of ranks rather
+   than characters, i.e. it was encoded before. */
 
 template<const char *_char_spec,
          uint8_t _undefined_rank,
-         class QgramTransformer>
+         class QgramTransformer,
+         typename SequenceBaseType = char>
 class QgramRecHashValueIterator
 {
   public:
+  using Transformer = QgramTransformer;
   static constexpr const bool possible_false_positive_matches
     = QgramTransformer::possible_false_positive_matches;
   static constexpr const GttlAlphabet<_char_spec,_undefined_rank> alphabet{};
@@ -50,7 +56,6 @@ class QgramRecHashValueIterator
   private:
 
   static constexpr const size_t alpha_size = alphabet.size();
-  using SequenceBaseType = char;
   using CyclicBuffer_uint8 = CyclicBuffer<uint8_t,MAX_QGRAM_LENGTH>;
 
   struct Iterator
@@ -99,7 +104,7 @@ class QgramRecHashValueIterator
       {
         if (!last_qgram_was_processed)
         {
-          const uint8_t new_rank = alphabet.char_to_rank(*next_char_ptr);
+          const uint8_t new_rank = rank_get(*next_char_ptr);
           const uint8_t old_rank = current_window.shift(new_rank);
           hash_value = qgram_transformer.next_hash_value_get(old_rank,
                                                              hash_value,
@@ -130,9 +135,23 @@ class QgramRecHashValueIterator
     size_t seqlen;
     CyclicBuffer_uint8 current_window;
     uint64_t max_integer_code;
+    size_t fill_next;          /* the q-gram to be delivered next by fill */
+    uint64_t fill_hash_value, fill_compl_hash_value; /* of q-gram
+                                                         fill_next - 1 */
 #ifndef NDEBUG
     uint8_t qgram_buffer[MAX_QGRAM_LENGTH];
 #endif
+    static uint8_t rank_get(SequenceBaseType cc) noexcept
+    {
+      if constexpr (std::is_same_v<SequenceBaseType,char>)
+      {
+        return alphabet.char_to_rank(cc);
+      } else
+      {
+        static_assert(std::is_same_v<SequenceBaseType,uint8_t>);
+        return cc;
+      }
+    }
   public:
     QgramRecHashValueIterator(size_t _qgram_length,
                               const SequenceBaseType *_sequence,
@@ -141,6 +160,9 @@ class QgramRecHashValueIterator
       , qgram_length(_qgram_length)
       , sequence(_sequence)
       , seqlen(_seqlen)
+      , fill_next(0)
+      , fill_hash_value(0)
+      , fill_compl_hash_value(0)
     {
       assert(qgram_length <= 32);
       max_integer_code = qgram_length == 32
@@ -157,8 +179,7 @@ class QgramRecHashValueIterator
         for (const SequenceBaseType *qgram_ptr = sequence + qgram_length - 1;
              qgram_ptr >= sequence; qgram_ptr--)
         {
-          const uint8_t rank = alphabet.char_to_rank(*qgram_ptr);
-          current_window.prepend(rank);
+          current_window.prepend(rank_get(*qgram_ptr));
         }
         std::tie(this_hash_value,
                  this_compl_hash_value)
@@ -183,6 +204,69 @@ class QgramRecHashValueIterator
                       current_window,
                       sequence + seqlen);
     }
+    /* Stores the hash values of the next at most max q-grams of the
+       sequence in fwd_out and, if rc_out is not nullptr, the hash values
+       of their reverse complements in rc_out. Returns the number of
+       q-grams, which is 0 if all q-grams have been delivered. The hash
+       values are the same as delivered by the iterator. */
+    size_t fill(uint64_t *fwd_out, uint64_t *rc_out, size_t max)
+    {
+      if (qgram_length > seqlen)
+      {
+        return 0;
+      }
+      const size_t end = std::min(seqlen - qgram_length + 1, fill_next + max);
+      const size_t start = fill_next;
+      uint64_t hash_value = fill_hash_value,
+               compl_hash_value = fill_compl_hash_value;
+      size_t pos = start;
+      if (pos == 0 and pos < end)
+      {
+        for (const SequenceBaseType *qgram_ptr = sequence + qgram_length - 1;
+             qgram_ptr >= sequence; qgram_ptr--)
+        {
+          current_window.prepend(rank_get(*qgram_ptr));
+        }
+        std::tie(hash_value, compl_hash_value)
+          = qgram_transformer.first_hash_value_pair_get(
+                                 current_window.pointer_to_array(),
+                                 qgram_length);
+        fwd_out[0] = hash_value;
+        if (rc_out != nullptr)
+        {
+          rc_out[0] = compl_hash_value;
+        }
+        pos++;
+      }
+      for (/* Nothing */; pos < end; pos++)
+      {
+        const uint8_t old_rank = rank_get(sequence[pos - 1]);
+        const uint8_t new_rank = rank_get(sequence[pos + qgram_length - 1]);
+        hash_value = qgram_transformer.next_hash_value_get(old_rank,
+                                                           hash_value,
+                                                           new_rank);
+        compl_hash_value
+          = qgram_transformer.next_compl_hash_value_get(
+               complement_uint8(old_rank),
+               compl_hash_value,
+               complement_uint8(new_rank));
+        fwd_out[pos - start] = hash_value;
+        if (rc_out != nullptr)
+        {
+          rc_out[pos - start] = compl_hash_value;
+        }
+      }
+      fill_next = end;
+      fill_hash_value = hash_value;
+      fill_compl_hash_value = compl_hash_value;
+      return end - start;
+    }
+    /* Stores the forward hash values of the next at most max q-grams
+       in out, see above */
+    size_t fill(uint64_t *out, size_t max)
+    {
+      return fill(out, nullptr, max);
+    }
     /* The following functions are for qgram invertible integer codes only */
     uint64_t qgram_encode(const SequenceBaseType *qgram)
     {
@@ -191,7 +275,7 @@ class QgramRecHashValueIterator
       for (const SequenceBaseType *qgram_ptr = qgram + qgram_length - 1;
            qgram_ptr >= qgram; qgram_ptr--)
       {
-        const uint8_t rank = alphabet.char_to_rank(*qgram_ptr);
+        const uint8_t rank = rank_get(*qgram_ptr);
         current_window.prepend(rank);
         code += mult * static_cast<uint64_t>(rank);
         mult *= alpha_size;
@@ -205,7 +289,7 @@ class QgramRecHashValueIterator
       for (const SequenceBaseType *qgram_ptr = qgram;
            qgram_ptr < qgram + qgram_length; qgram_ptr++)
       {
-        const uint8_t rank = alphabet.char_to_rank(*qgram_ptr);
+        const uint8_t rank = rank_get(*qgram_ptr);
         code += mult * static_cast<uint64_t>(rank);
         mult *= alpha_size;
       }
@@ -233,8 +317,7 @@ class QgramRecHashValueIterator
     {
       for (size_t idx = 0; idx < qgram_length; idx++)
       {
-        uint8_t rank = alphabet.char_to_rank(orig_qgram[idx]);
-        assert(rank == mapped_qgram[idx]);
+        assert(rank_get(orig_qgram[idx]) == mapped_qgram[idx]);
       }
     }
 #endif
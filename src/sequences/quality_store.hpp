@@ -0,0 +1,144 @@
+#ifndef QUALITY_STORE_HPP
+#define QUALITY_STORE_HPP
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* A compact store for the quality strings of FASTQ entries. The
+   phred scores are reduced to the 8 bins of the Illumina binning scheme,
+   which are represented by the phred scores 2, 6, 15, 22, 27, 33, 37
+   and 40:
+
+   phred score  0-2 3-9 10-19 20-24 25-29 30-34 35-39 >=40
+   represented   2   6   15    22    27    33    37    40
+
+   As consecutive scores mostly fall into the same bin, the sequence of
+   bins is run length encoded: each byte stores a bin in the 3 most
+   significant bits and the length of the run minus 1 in the 5 least
+   significant bits. So a quality string requires at most one byte per
+   character and usually much less. The quality strings are numbered in
+   the order they are appended, which is the order of the sequences,
+   if the store is attached to a GttlMultiseq. */
+
+class GttlQualityStore
+{
+  static constexpr const size_t num_bins = 8;
+  static constexpr const int run_bits = 5;
+  static constexpr const size_t max_run = size_t(1) << run_bits;
+  static constexpr const std::array<uint8_t,num_bins> representatives
+    {2, 6, 15, 22, 27, 33, 37, 40};
+
+  uint8_t phred_offset;
+  std::array<uint8_t,UCHAR_MAX+1> char2bin;
+  std::vector<uint8_t> runs;
+  std::vector<size_t> run_offsets; /* first run of each quality string */
+  size_t total_length;
+
+  static constexpr uint8_t phred_score2bin(size_t phred_score) noexcept
+  {
+    if (phred_score < 3) return 0;
+    if (phred_score < 10) return 1;
+    if (phred_score < 20) return 2;
+    if (phred_score < 25) return 3;
+    if (phred_score < 30) return 4;
+    if (phred_score < 35) return 5;
+    if (phred_score < 40) return 6;
+    return 7;
+  }
+
+  void append_run(uint8_t bin, size_t run_length)
+  {
+    assert(bin < num_bins);
+    while (run_length > 0)
+    {
+      const size_t this_run = run_length < max_run ? run_length : max_run;
+      runs.push_back(static_cast<uint8_t>((bin << run_bits) | (this_run - 1)));
+      run_length -= this_run;
+    }
+  }
+
+  public:
+  explicit GttlQualityStore(uint8_t _phred_offset = 33)
+    : phred_offset(_phred_offset)
+    , char2bin({})
+    , runs({})
+    , run_offsets({0})
+    , total_length(0)
+  {
+    for (size_t cc = 0; cc <= UCHAR_MAX; cc++)
+    {
+      char2bin[cc] = phred_score2bin(cc < phred_offset ? 0
+                                                       : cc - phred_offset);
+    }
+  }
+
+  void append(std::string_view quality)
+  {
+    size_t idx = 0;
+    while (idx < quality.size())
+    {
+      const uint8_t bin = char2bin[static_cast<uint8_t>(quality[idx])];
+      size_t end = idx + 1;
+      while (end < quality.size() and
+             char2bin[static_cast<uint8_t>(quality[end])] == bin)
+      {
+        end++;
+      }
+      append_run(bin, end - idx);
+      idx = end;
+    }
+    run_offsets.push_back(runs.size());
+    total_length += quality.size();
+  }
+
+  /* the number of quality strings stored */
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return run_offsets.size() - 1;
+  }
+
+  /* appends the binned quality string with number idx to the
+     given string */
+  void decode(size_t idx, std::string *quality) const
+  {
+    assert(idx < size());
+    for (size_t run_idx = run_offsets[idx]; run_idx < run_offsets[idx + 1];
+         run_idx++)
+    {
+      const uint8_t run = runs[run_idx];
+      quality->append(static_cast<size_t>(run & (max_run - 1)) + 1,
+                      static_cast<char>(representatives[run >> run_bits]
+                                        + phred_offset));
+    }
+  }
+
+  [[nodiscard]] std::string decode(size_t idx) const
+  {
+    std::string quality{};
+    decode(idx, &quality);
+    return quality;
+  }
+
+  [[nodiscard]] uint8_t phred_offset_get(void) const noexcept
+  {
+    return phred_offset;
+  }
+
+  /* the number of characters of all quality strings */
+  [[nodiscard]] size_t total_length_get(void) const noexcept
+  {
+    return total_length;
+  }
+
+  [[nodiscard]] size_t size_in_bytes(void) const noexcept
+  {
+    return sizeof(GttlQualityStore) + runs.size() * sizeof(uint8_t)
+           + run_offsets.size() * sizeof(size_t);
+  }
+};
+#endif
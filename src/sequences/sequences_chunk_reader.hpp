@@ -0,0 +1,233 @@
+#ifndef SEQUENCES_CHUNK_READER_HPP
+#define SEQUENCES_CHUNK_READER_HPP
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <ios>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "utilities/gttl_file_open.hpp"
+
+/* Reads sequences in FASTA or FASTQ format from a (possibly gzipped) file
+   which cannot be memory mapped or be read twice, as e.g. the standard
+   input (denoted by the file name -) or a named pipe. The input is
+   delivered in chunks of about chunk_size bytes, each of which consists of
+   complete FASTA or FASTQ entries. So each chunk can be processed by
+   a GttlFastAGenerator or GttlFastQGenerator constructed from a string_view,
+   just like the parts delivered by SequencesSplit for memory mapped files.
+   The method next is thread safe, so that several threads can process
+   different chunks while another thread reads the next chunk, without
+   ever seeking in the input. The format is determined from the first
+   non-white space character of the input, as the name of the input
+   gives no hint. FASTQ entries are expected to consist of four lines. */
+
+class GttlSequencesChunkReader
+{
+  GttlFpType in_fp;
+  std::string input_name;
+  size_t chunk_size;
+  std::string pending; /* read, but not delivered */
+  bool input_exhausted;
+  bool fasta_format;
+  size_t chunk_number;
+  size_t scanned,          /* prefix of pending scanned for boundaries */
+         scanned_newlines, /* number of newlines in scanned prefix */
+         last_entry_end;   /* end of last entry in scanned prefix */
+  std::mutex reader_mutex;
+
+  /* returns false iff no more data could be read */
+  bool read_block(void)
+  {
+    if (input_exhausted)
+    {
+      return false;
+    }
+    const size_t old_size = pending.size();
+    pending.resize(old_size + chunk_size);
+    const size_t bytes_read = gttl_fp_type_read(pending.data() + old_size,
+                                                sizeof(char),
+                                                chunk_size,
+                                                in_fp);
+    pending.resize(old_size + bytes_read);
+    if (bytes_read == 0)
+    {
+      input_exhausted = true;
+      return false;
+    }
+    return true;
+  }
+
+  /* extends the scan of pending for entry boundaries to the data read
+     since the previous call and returns the length of the longest prefix
+     of pending consisting of complete entries, or 0 if there is no such
+     prefix. As pending always begins with an entry, each newline
+     of a FASTQ entry with a number divisible by 4 ends an entry. */
+  [[nodiscard]] size_t complete_entries_length(void) noexcept
+  {
+    if (input_exhausted)
+    {
+      return pending.size();
+    }
+    while (scanned < pending.size())
+    {
+      const char *const newline
+        = static_cast<const char *>(std::memchr(pending.data() + scanned,
+                                                '\n',
+                                                pending.size() - scanned));
+      if (newline == nullptr)
+      {
+        scanned = pending.size();
+        break;
+      }
+      const size_t idx = static_cast<size_t>(newline - pending.data());
+      if (fasta_format)
+      {
+        if (idx + 1 == pending.size())
+        {
+          /* next char not read yet, so check again after next read */
+          scanned = idx;
+          break;
+        }
+        if (pending[idx + 1] == '>')
+        {
+          last_entry_end = idx + 1;
+        }
+      } else
+      {
+        if (++scanned_newlines % 4 == 0)
+        {
+          last_entry_end = idx + 1;
+        }
+      }
+      scanned = idx + 1;
+    }
+    return last_entry_end;
+  }
+
+  void determine_format(void)
+  {
+    while (true)
+    {
+      const size_t first = pending.find_first_not_of(" \t\r\n");
+      if (first != std::string::npos)
+      {
+        if (pending[first] != '>' and pending[first] != '@')
+        {
+          throw std::ios_base::failure(
+                  std::format(": input {} is neither in FASTA nor in "
+                              "FASTQ format", input_name));
+        }
+        fasta_format = pending[first] == '>';
+        pending.erase(0, first);
+        return;
+      }
+      pending.clear();
+      if (not read_block())
+      {
+        return;
+      }
+    }
+  }
+
+  public:
+  static constexpr const size_t default_chunk_size = size_t(1) << 22;
+
+  GttlSequencesChunkReader(GttlFpType _in_fp,
+                           const std::string &_input_name,
+                           size_t _chunk_size = default_chunk_size)
+    : in_fp(_in_fp)
+    , input_name(_input_name)
+    , chunk_size(_chunk_size)
+    , pending({})
+    , input_exhausted(false)
+    , fasta_format(true)
+    , chunk_number(0)
+    , scanned(0)
+    , scanned_newlines(0)
+    , last_entry_end(0)
+  {
+    assert(chunk_size > 0);
+    if (in_fp == nullptr)
+    {
+      throw std::ios_base::failure(std::format(": cannot open file {}",
+                                               input_name));
+    }
+    determine_format();
+  }
+
+  explicit GttlSequencesChunkReader(const std::string &inputfile,
+                                    size_t _chunk_size = default_chunk_size)
+    : GttlSequencesChunkReader(gttl_fp_type_open(inputfile.c_str(), "rb"),
+                               inputfile,
+                               _chunk_size)
+  {}
+
+  GttlSequencesChunkReader(const GttlSequencesChunkReader&) = delete;
+  GttlSequencesChunkReader& operator=(const GttlSequencesChunkReader&)
+    = delete;
+
+  ~GttlSequencesChunkReader(void)
+  {
+    gttl_fp_type_close(in_fp);
+  }
+
+  [[nodiscard]] bool fasta_format_get(void) const noexcept
+  {
+    return fasta_format;
+  }
+
+  /* the data read so far, but not yet delivered, which allows to inspect
+     the beginning of the input before the first call of next */
+  [[nodiscard]] std::string_view pending_get(void) const noexcept
+  {
+    return std::string_view(pending);
+  }
+
+  /* stores the next chunk in chunk and returns the number of the chunk,
+     counting from 0, so that the original order of the chunks can be
+     restored. Returns false as first component if the input is
+     exhausted */
+  std::pair<bool,size_t> next(std::string &chunk)
+  {
+    const std::lock_guard<std::mutex> lock(reader_mutex);
+    size_t cut = 0;
+    while (true)
+    {
+      if (pending.size() >= chunk_size)
+      {
+        cut = complete_entries_length();
+        if (cut > 0)
+        {
+          break;
+        }
+      }
+      if (not read_block())
+      {
+        cut = pending.size();
+        break;
+      }
+    }
+    if (cut == 0)
+    {
+      return {false, chunk_number};
+    }
+    if (cut == pending.size())
+    {
+      chunk.swap(pending);
+      pending.clear();
+    } else
+    {
+      chunk.assign(pending, 0, cut);
+      pending.erase(0, cut);
+    }
+    assert(scanned >= cut or cut == chunk.size());
+    scanned = scanned >= cut ? scanned - cut : 0;
+    scanned_newlines %= 4;
+    last_entry_end = 0;
+    return {true, chunk_number++};
+  }
+};
+#endif
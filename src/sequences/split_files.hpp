@@ -4,11 +4,42 @@
 #include <cassert>
 #include <cstddef>
 #include <cmath>
-#include <sstream>
 #include <string>
 #include <string_view>
-#include "threading/thread_pool_unknown_tasks.hpp"
-#include "utilities/write_output_file.hpp"
+#include <utility>
+#include "utilities/parallel_gzip_writer.hpp"
+
+/*
+** Append the entry si of a FastQGenerator or FastAGenerator to the
+** output buffer in the format of the input.
+*/
+template <class SequenceGeneratorClass, class SequenceEntry>
+static void split_files_append_entry(std::string &s_out,
+                                     const SequenceEntry *si)
+{
+  const std::string_view &sequence = si->sequence_get();
+  const std::string_view &header = si->header_get();
+
+  if constexpr (SequenceGeneratorClass::is_fastq_generator)
+  {
+    s_out += '@';
+  } else
+  {
+    s_out += '>';
+  }
+  s_out.append(header);
+  s_out += '\n';
+  s_out.append(sequence);
+  s_out += '\n';
+
+  if constexpr (SequenceGeneratorClass::is_fastq_generator)
+  {
+    const std::string_view &quality = si->quality_get();
+    s_out.append("+\n");
+    s_out.append(quality);
+    s_out += '\n';
+  }
+}
 
 /*
 ** Split a FastQGenerator or FastAGenerator into fragments of a given length (of
@@ -20,6 +51,10 @@
 ** files.
 ** This is because any non-empty sequence will always be longer than 0
 ** characters.
+** Each part is collected in a buffer which is then moved to a
+** GttlParallelGzipWriter. This compresses blocks of gzip_block_size
+** bytes of all parts with n_threads threads and writes each part as a
+** multi-member gzip file.
 */
 template <class SequenceGeneratorClass>
 void split_into_parts_length(SequenceGeneratorClass &seq_gen,
@@ -27,37 +62,23 @@ void split_into_parts_length(SequenceGeneratorClass &seq_gen,
                              size_t part_length,
                              size_t compression_level,
                              size_t n_threads,
-                             size_t padding_length = 2)
+                             size_t padding_length = 2,
+                             size_t gzip_block_size
+                               = GttlParallelGzipWriter::default_block_size)
 {
   size_t part_number = 1;
   size_t length_iterated = 0;
-  std::ostringstream s_out;
-  ThreadPoolUnknownTasks tp(n_threads);
+  std::string s_out;
+  GttlParallelGzipWriter writer(compression_level, n_threads,
+                                gzip_block_size);
   const std::string output_file_suffix{SequenceGeneratorClass::
                                          is_fastq_generator ? ".fastq"
                                                             : ".fasta"};
 
   for (const auto *si : seq_gen)
   {
-    const std::string_view &sequence = si->sequence_get();
-    const std::string_view &header = si->header_get();
-
-    if constexpr (SequenceGeneratorClass::is_fastq_generator)
-    {
-      s_out << "@";
-    } else
-    {
-      s_out << ">";
-    }
-    s_out << header << '\n' << sequence << '\n';
-
-    if constexpr (SequenceGeneratorClass::is_fastq_generator)
-    {
-      const std::string_view &quality = si->quality_get();
-      s_out << "+\n" << quality << '\n';
-    }
-
-    length_iterated += sequence.size();
+    split_files_append_entry<SequenceGeneratorClass>(s_out, si);
+    length_iterated += si->sequence_get().size();
 
     if (length_iterated >= part_length)
     {
@@ -69,26 +90,18 @@ void split_into_parts_length(SequenceGeneratorClass &seq_gen,
                         : "");
       }
       fname_out += std::to_string(part_number) + output_file_suffix;
-      if (n_threads == 1)
-      {
-        write_to_output_file(fname_out, s_out.str(), compression_level);
-      } else
-      {
-        // This is an example of how one might wait until enqueueing would lead
-        // to at most 3 items in the queue
-        // while (tp.get_size() > 2)
-        //   std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        tp.enqueue([fname_out, capture0 = s_out.str(), compression_level] {
-          write_to_output_file(fname_out, capture0, compression_level);
-        });
-      }
-
-      s_out.str("");
+      // The buffer is moved into the writer, which splits it into blocks
+      // compressed by n_threads threads. So we start with a new buffer
+      // of the same capacity for the next part.
+      const size_t previous_capacity = s_out.capacity();
+      writer.write(std::move(fname_out), std::move(s_out));
+      s_out = std::string{};
+      s_out.reserve(previous_capacity);
       length_iterated = 0;
       part_number++;
     }
   }
-  if (not s_out.str().empty())
+  if (not s_out.empty())
   {
     std::string fname_out = base_name;
     for(size_t i = 1; i <= padding_length; i++)
@@ -98,15 +111,7 @@ void split_into_parts_length(SequenceGeneratorClass &seq_gen,
                     : "");
     }
     fname_out += std::to_string(part_number) + output_file_suffix;
-    if (n_threads == 1)
-    {
-      write_to_output_file(fname_out, s_out.str(), compression_level);
-    } else
-    {
-      tp.enqueue([fname_out, capture0 = s_out.str(), compression_level] {
-        write_to_output_file(fname_out, capture0, compression_level);
-      });
-    }
+    writer.write(std::move(fname_out), std::move(s_out));
   }
 }
 
@@ -119,72 +124,42 @@ void split_into_num_sequences(SequenceGeneratorClass &seq_gen,
                               const std::string &base_name,
                               size_t seqs_per_file,
                               size_t compression_level,
-                              size_t n_threads)
+                              size_t n_threads,
+                              size_t gzip_block_size
+                                = GttlParallelGzipWriter::default_block_size)
 {
-  ThreadPoolUnknownTasks tp(n_threads);
+  GttlParallelGzipWriter writer(compression_level, n_threads,
+                                gzip_block_size);
   size_t part_number = 1;
   size_t seqs_iterated = 0;
   const std::string output_file_suffix{SequenceGeneratorClass::
                                          is_fastq_generator ? ".fastq"
                                                             : ".fasta"};
-  std::ostringstream s_out;
+  std::string s_out;
   for (const auto *si : seq_gen)
   {
-    const std::string_view &sequence = si->sequence_get();
-    const std::string_view &header = si->header_get();
-
-    if constexpr (SequenceGeneratorClass::is_fastq_generator)
-    {
-      s_out << "@";
-    } else
-    {
-      s_out << ">";
-    }
-
-    s_out << header << '\n' << sequence << '\n';
-
-    if constexpr (SequenceGeneratorClass::is_fastq_generator)
-    {
-      const std::string_view &quality = si->quality_get();
-      s_out << "+\n" << quality << '\n';
-    }
-
+    split_files_append_entry<SequenceGeneratorClass>(s_out, si);
     seqs_iterated++;
 
     if (seqs_iterated >= seqs_per_file)
     {
-      const std::string fname_out = base_name + (part_number <= 9 ? "0" : "")
-                                   + std::to_string(part_number)
-                                    .append(output_file_suffix);
-      if (n_threads == 1)
-      {
-        write_to_output_file(fname_out, s_out.str(), compression_level);
-      } else
-      {
-        tp.enqueue([fname_out, capture0 = s_out.str(), compression_level] {
-          write_to_output_file(fname_out, capture0, compression_level);
-        });
-      }
-
-      s_out.str("");
+      std::string fname_out = base_name + (part_number <= 9 ? "0" : "")
+                              + std::to_string(part_number)
+                               .append(output_file_suffix);
+      const size_t previous_capacity = s_out.capacity();
+      writer.write(std::move(fname_out), std::move(s_out));
+      s_out = std::string{};
+      s_out.reserve(previous_capacity);
       seqs_iterated = 0;
       part_number++;
     }
   }
-  if (not s_out.str().empty())
+  if (not s_out.empty())
   {
-    const std::string fname_out = base_name + (part_number <= 9 ? "0" : "")
-                                 + std::to_string(part_number)
-                                 + output_file_suffix;
-    if (n_threads == 1)
-    {
-      write_to_output_file(fname_out, s_out.str(), compression_level);
-    } else
-    {
-      tp.enqueue([fname_out, capture0 = s_out.str(), compression_level] {
-        write_to_output_file(fname_out, capture0, compression_level);
-      });
-    }
+    std::string fname_out = base_name + (part_number <= 9 ? "0" : "")
+                            + std::to_string(part_number)
+                            + output_file_suffix;
+    writer.write(std::move(fname_out), std::move(s_out));
   }
 }
 
@@ -199,7 +174,9 @@ void split_into_num_files(SequenceGeneratorClass &seq_gen,
                           const std::string &base_name,
                           size_t part_num,
                           size_t compression_level,
-                          size_t n_threads)
+                          size_t n_threads,
+                          size_t gzip_block_size
+                            = GttlParallelGzipWriter::default_block_size)
 {
   size_t total_length = 0;
   for (const auto *si : seq_gen)
@@ -210,7 +187,8 @@ void split_into_num_files(SequenceGeneratorClass &seq_gen,
   const size_t part_len = (total_length + part_num - 1)/ part_num;
   seq_gen.reset();
   split_into_parts_length(seq_gen, base_name, part_len, compression_level,
-                          n_threads, static_cast<size_t>(std::log10(part_num)));
+                          n_threads, static_cast<size_t>(std::log10(part_num)),
+                          gzip_block_size);
 }
 
 #endif // SPLIT_FILES_HPP
@@ -3,8 +3,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <cassert>
+#include <algorithm>
+#include <atomic>
 #include <exception>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 #include <cmath>
 #include <format>
@@ -12,6 +16,7 @@
 #include "utilities/runtime_class.hpp"
 #include "utilities/constexpr_for.hpp"
 #include "utilities/multibitvector.hpp"
+#include "threading/thread_pool_var.hpp"
 #include "sequences/char_range.hpp"
 #include "sequences/char_finder.hpp"
 #include "sequences/qgrams_hash_invint.hpp"
@@ -30,6 +35,24 @@ class Unwords
     , multibitvector(number_of_all_qgrams)
     , sequences_total_length(0)
     {}
+  /* the unwords of length _qgram_length, where the bits set in occurring
+     are the integer codes of the q-grams occurring in the sequences */
+  Unwords(size_t alphabetsize,size_t _qgram_length,
+          const Multibitvector<false> &occurring,
+          size_t _sequences_total_length)
+    : Unwords(alphabetsize,_qgram_length)
+  {
+    assert(occurring.size() == number_of_all_qgrams);
+    for (size_t integer_code = 0; integer_code < number_of_all_qgrams;
+         integer_code++)
+    {
+      if (occurring[integer_code])
+      {
+        multibitvector.set(integer_code);
+      }
+    }
+    sequences_total_length = _sequences_total_length;
+  }
   [[nodiscard]] size_t qgram_length_get(void) const noexcept
   {
     return qgram_length;
@@ -173,6 +196,124 @@ static const Unwords *unwords_binary_search(size_t qgram_length_max,
   return last_successful_unwords;
 }
 
+/* Determines the unwords of all lengths from 1 to qgram_length_max in a
+   single pass over the sequences, which are stored in memory. The ranges
+   of the sequences without wildcards are split into chunks of
+   chunk_length positions, overlapping by qgram_length_max-1 positions,
+   so that each q-gram is contained in a chunk. The chunks are distributed
+   over num_threads threads. For each length q there is one bit set,
+   shared by all threads, in which the bits of the integer codes of the
+   q-grams are set by atomic operations, so the space requirement of
+   sum_{q=1}^{qgram_length_max} alphabetsize^q bits does not depend on
+   the number of threads. As all q-grams of length q occur if all q-grams
+   of length q+1 occur, the lengths for which the bit sets are already
+   complete are skipped. The result are the unwords of the smallest length
+   for which there are unwords, or nullptr if there is no such length. */
+template<class CharRanger, class InvertibleIntcodeIterator,
+         bool reverse_complement_option>
+static const Unwords *unwords_single_pass(size_t qgram_length_max,
+                                          size_t alphabetsize,
+                                          const std::vector<std::string>
+                                            &sequences,
+                                          size_t num_threads,
+                                          size_t chunk_length
+                                            = size_t{1} << 20)
+{
+  assert(qgram_length_max > 0 && num_threads > 0 && chunk_length > 0);
+  std::vector<std::pair<const char *,size_t>> chunks{};
+  size_t sequences_total_length = 0;
+  for (auto const &sequence : sequences)
+  {
+    CharRanger ranger(sequence.data(),sequence.size());
+    for (auto const &&range : ranger)
+    {
+      const size_t this_length = std::get<1>(range);
+      const char *const substring = sequence.data() + std::get<0>(range);
+      sequences_total_length += this_length;
+      for (size_t start = 0; start < this_length; start += chunk_length)
+      {
+        const size_t remaining = this_length - start;
+        chunks.emplace_back(substring + start,
+                            std::min(remaining,
+                                     chunk_length + qgram_length_max - 1));
+        if (remaining <= chunk_length + qgram_length_max - 1)
+        {
+          break;
+        }
+      }
+    }
+  }
+  std::vector<size_t> number_of_all_qgrams{};
+  for (size_t qgram_length = 1; qgram_length <= qgram_length_max;
+       qgram_length++)
+  {
+    number_of_all_qgrams.push_back(std::pow(alphabetsize,qgram_length));
+  }
+  /* occurring[q-1] are the q-grams occurring in the chunks processed so
+     far and all q-grams of length at most complete occur in them */
+  std::vector<Multibitvector<false>> occurring{};
+  occurring.reserve(qgram_length_max);
+  for (auto this_number : number_of_all_qgrams)
+  {
+    occurring.emplace_back(this_number);
+  }
+  std::atomic<size_t> complete{0};
+  if (not chunks.empty())
+  {
+    gttl_thread_pool_var(num_threads,
+                         chunks.size(),
+                         [&](size_t, size_t chunk_num)
+                         {
+      const char *const substring = std::get<0>(chunks[chunk_num]);
+      const size_t this_length = std::get<1>(chunks[chunk_num]);
+      size_t this_complete = complete.load(std::memory_order_relaxed);
+      for (size_t qgram_length = this_complete + 1;
+           qgram_length <= qgram_length_max; qgram_length++)
+      {
+        Multibitvector<false> &this_occurring = occurring[qgram_length - 1];
+        InvertibleIntcodeIterator qgiter(qgram_length,substring,this_length);
+        for (auto const &&code_pair : qgiter)
+        {
+          this_occurring.set_concurrently(std::get<0>(code_pair));
+          if constexpr (reverse_complement_option)
+          {
+            this_occurring.set_concurrently(std::get<1>(code_pair));
+          }
+        }
+      }
+      /* counting the bits is only worth it if the bit set is not much
+         larger than the chunk */
+      while (this_complete < qgram_length_max &&
+             number_of_all_qgrams[this_complete] <= 64 * this_length &&
+             occurring[this_complete].count_concurrently()
+               == number_of_all_qgrams[this_complete])
+      {
+        this_complete++;
+      }
+      size_t previous_complete = complete.load(std::memory_order_relaxed);
+      while (previous_complete < this_complete &&
+             not complete.compare_exchange_weak(previous_complete,
+                                                this_complete,
+                                                std::memory_order_relaxed))
+      {
+        /* Nothing */
+      }
+    });
+  }
+  for (size_t qgram_length = 1; qgram_length <= qgram_length_max;
+       qgram_length++)
+  {
+    if (occurring[qgram_length - 1].count()
+        < number_of_all_qgrams[qgram_length - 1])
+    {
+      return new Unwords(alphabetsize,qgram_length,
+                         occurring[qgram_length - 1],
+                         sequences_total_length);
+    }
+  }
+  return nullptr;
+}
+
 static constexpr const char_finder::NucleotideFinder unw_nucleotide_finder{};
 static constexpr const char_finder::AminoacidFinder unw_aminoacid_finder{};
 
@@ -218,6 +359,54 @@ static const Unwords *unwords_finder(bool is_protein_sequence,
   return unwords;
 }
 
+/* the same as unwords_finder, but the unwords are determined by
+   unwords_single_pass */
+static inline const Unwords *unwords_single_pass_finder(
+                                   bool is_protein_sequence,
+                                   bool reverse_complement,
+                                   size_t qgram_length_max,
+                                   const std::vector<std::string> &sequences,
+                                   size_t num_threads,
+                                   size_t chunk_length)
+{
+  const Unwords *unwords = nullptr;
+  if (!is_protein_sequence)
+  {
+    constexpr_for<0,1+1,1>([&](auto compile_time_reverse_complement)
+    {
+      if (compile_time_reverse_complement
+          == static_cast<int>(reverse_complement))
+      {
+        using NucleotideRanger = GttlCharRange<char_finder::NucleotideFinder,
+                                               unw_nucleotide_finder,
+                                               true, false>;
+        unwords = unwords_single_pass<NucleotideRanger,
+                                      InvertibleIntegercode2Iterator4,
+                                      compile_time_reverse_complement>
+                                     (qgram_length_max,
+                                      4,
+                                      sequences,
+                                      num_threads,
+                                      chunk_length);
+      }
+    });
+  } else
+  {
+    using AminoacidRanger = GttlCharRange<char_finder::AminoacidFinder,
+                                          unw_aminoacid_finder,
+                                          true, false>;
+    unwords = unwords_single_pass<AminoacidRanger,
+                                  InvertibleIntegercodeIterator20,
+                                  false>
+                                 (qgram_length_max,
+                                  20,
+                                  sequences,
+                                  num_threads,
+                                  chunk_length);
+  }
+  return unwords;
+}
+
 static inline size_t estimate_qgram_length_max(
                                         size_t upper_bound_sequence_length,
                                         size_t alphabetsize)
@@ -7,6 +7,7 @@
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 #include "threading/threadsafe_queue.hpp"
 
@@ -64,6 +65,12 @@ class ThreadPoolUnknownTasks
     tasks_changed.notify_one();
   }
 
+  void enqueue(FunctionType &&task)
+  {
+    tsq.enqueue(std::move(task));
+    tasks_changed.notify_one();
+  }
+
   [[nodiscard]] size_t size_of_queue(void) const
   {
     return tsq.size();
@@ -65,6 +65,12 @@ class ThreadsafeQueue
     the_queue.push(item);
   }
 
+  void enqueue(T &&item)
+  {
+    const std::scoped_lock<std::mutex> lock(q_mutex);
+    the_queue.push(std::move(item));
+  }
+
   std::optional<T> dequeue(void)
   {
     const std::scoped_lock<std::mutex> lock(q_mutex);
@@ -72,7 +78,7 @@ class ThreadsafeQueue
     {
       return {};
     }
-    T tmp = the_queue.front();
+    T tmp = std::move(the_queue.front());
     the_queue.pop();
     return tmp;
   }
@@ -42,6 +42,18 @@ class Bitvector
       value.fetch_or(the_bit(idx), std::memory_order_seq_cst) & the_bit(idx)
     );
   }
+  /* sets the bit by an atomic operation, so that several threads can set
+     bits of the same word. The word is only modified if the bit is not
+     yet set, so that words whose bits are already set are only read. */
+  void set_concurrently(size_t idx) noexcept requires (not thread_safe)
+  {
+    assert(idx < bits);
+    std::atomic_ref<uint64_t> word(value);
+    if ((word.load(std::memory_order_relaxed) & the_bit(idx)) == 0)
+    {
+      word.fetch_or(the_bit(idx), std::memory_order_relaxed);
+    }
+  }
   void reset(size_t idx) requires (not thread_safe)
   {
     assert(idx < bits);
@@ -100,6 +112,15 @@ class Bitvector
   {
     return std::popcount(value.load(std::memory_order_relaxed));
   }
+  /* the same as count, but the word may be modified by set_concurrently
+     at the same time */
+  [[nodiscard]] size_t count_concurrently(void)
+    const noexcept requires (not thread_safe)
+  {
+    return std::popcount(std::atomic_ref<uint64_t>(const_cast<uint64_t &>
+                                                     (value))
+                           .load(std::memory_order_relaxed));
+  }
   [[nodiscard]] std::string to_string(void)
     const noexcept requires (not thread_safe)
   {
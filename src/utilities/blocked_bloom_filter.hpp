@@ -6,10 +6,14 @@
 #define BLOCKED_BLOOM_FILTER_HPP
 
 #include "utilities/bitvector.hpp"
+#include "utilities/bloom_filter_file.hpp"
 #include "utilities/bloom_filter_hash_function.hpp"
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 constexpr size_t BlockedBloomFilterBlockSize = 512;
@@ -55,12 +59,18 @@ class BlockedBloomFilter
       return true;
     }
   };
-  std::vector<Block> blocks;
+  BloomFilterWords<Block> blocks;
   size_t num_hash_functions;
 
+  BlockedBloomFilter(BloomFilterWords<Block> &&_blocks,
+                     size_t _num_hash_functions)
+    : blocks(std::move(_blocks))
+    , num_hash_functions(_num_hash_functions)
+  { }
+
  public:
   BlockedBloomFilter(uint64_t num_blocks, size_t _num_hash_functions)
-    : blocks(std::vector<Block>(num_blocks))
+    : blocks(BloomFilterWords<Block>(num_blocks))
     , num_hash_functions(_num_hash_functions)
   { }
 
@@ -87,6 +97,36 @@ class BlockedBloomFilter
   {
     return num_hash_functions;
   }
+
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::blocked_bloom_filter,
+                            blocks.size() * BlockedBloomFilterBlockSize,
+                            num_hash_functions_get(), 1, 0,
+                            {blocks.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the blocks are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static BlockedBloomFilter load(const std::string &filename,
+                                               bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::blocked_bloom_filter);
+    const size_t num_blocks
+      = file->header_get().num_bits / BlockedBloomFilterBlockSize;
+    return BlockedBloomFilter(BloomFilterWords<Block>(file, 0, num_blocks,
+                                                      not memory_map),
+                              file->header_get().num_hash_functions);
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return blocks.is_mapped();
+  }
 };
 
 #endif // BLOCKED_BLOOM_FILTER_HPP
@@ -6,11 +6,15 @@
 #define BLOOM_FILTER_HPP
 
 #include "utilities/bitvector.hpp"
+#include "utilities/bloom_filter_file.hpp"
 #include "utilities/bloom_filter_hash_function.hpp"
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
 #include <numbers>
+#include <string>
+#include <utility>
 #include <vector>
 
 template <bool thread_safe = true>
@@ -20,7 +24,7 @@ class BloomFilter
   double ln_error; /* only used in one case */
   size_t num_hash_functions;
   size_t num_bits;
-  std::vector<Bitvector<thread_safe>> data_vec;
+  BloomFilterWords<Bitvector<thread_safe>> data_vec;
   bool set_bit(uint64_t idx)
   {
     return data_vec[idx / 64].set_bit(idx % 64);
@@ -33,6 +37,13 @@ class BloomFilter
            ((-1.0 * d_number_of_elements * d_num_hash_functions) /
             std::log(1.0 - std::pow(error, 1.0/d_num_hash_functions)));
   }
+  BloomFilter(size_t _num_bits, size_t _num_hash_functions,
+              BloomFilterWords<Bitvector<thread_safe>> &&_data_vec)
+    : ln_error(0.0)
+    , num_hash_functions(_num_hash_functions)
+    , num_bits(_num_bits)
+    , data_vec(std::move(_data_vec))
+  { }
 
   public:
   [[nodiscard]] bool get_bit(uint64_t index) const
@@ -44,7 +55,7 @@ class BloomFilter
     : ln_error(0.0)
     , num_hash_functions(_num_hash_functions)
     , num_bits(_num_bits)
-    , data_vec(std::vector<Bitvector<thread_safe>>((num_bits + 63) / 64))
+    , data_vec(BloomFilterWords<Bitvector<thread_safe>>((num_bits + 63) / 64))
   { }
 
   BloomFilter(double error, size_t number_of_elements)
@@ -54,7 +65,7 @@ class BloomFilter
     , num_hash_functions(static_cast<size_t>(ln_error * -std::numbers::log2e))
     , num_bits(static_cast<size_t>(static_cast<double>(number_of_elements) *
                                    ln_error * -2.081368))
-    , data_vec(std::vector<Bitvector<thread_safe>>((num_bits + 63) / 64))
+    , data_vec(BloomFilterWords<Bitvector<thread_safe>>((num_bits + 63) / 64))
   { }
 
   BloomFilter(double error, size_t number_of_elements,
@@ -64,7 +75,7 @@ class BloomFilter
     , num_bits(num_bits_3args(error,
                               static_cast<double>(number_of_elements),
                               static_cast<double>(_num_hash_functions)))
-    , data_vec(std::vector<Bitvector<thread_safe>>((num_bits + 63) / 64))
+    , data_vec(BloomFilterWords<Bitvector<thread_safe>>((num_bits + 63) / 64))
   { }
 
   [[nodiscard]] size_t num_bits_get(void) const
@@ -107,6 +118,34 @@ class BloomFilter
     return num_hash_functions;
   }
 
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename, BloomFilterFileType::bloom_filter,
+                            num_bits, num_hash_functions, 1, 0,
+                            {data_vec.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the bits are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static BloomFilter load(const std::string &filename,
+                                        bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::bloom_filter);
+    const size_t file_num_bits = file->header_get().num_bits;
+    return BloomFilter(file_num_bits, file->header_get().num_hash_functions,
+                       BloomFilterWords<Bitvector<thread_safe>>(
+                         file, 0, (file_num_bits + 63) / 64,
+                         not memory_map));
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return data_vec.is_mapped();
+  }
+
   void stats(void) const
   {
     printf("Bloom filter size: %zu bytes\n", size_in_bytes());
@@ -0,0 +1,325 @@
+#ifndef BLOOM_FILTER_FILE_HPP
+#define BLOOM_FILTER_FILE_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <ios>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "utilities/gttl_mmap.hpp"
+
+/* The common binary layout of the Bloom filters. A file consists of
+
+   - a header of 64 bytes, specifying the type of the filter, the number
+     of bits of each filter (of each bin for interleaved Bloom filters),
+     the number of hash functions, the number of bins, the seed of the
+     hash functions and the number of bytes of the payload,
+   - the payload, i.e. the words of the filter as stored in memory, where
+     each segment of the payload is padded to a multiple of 64 bytes.
+
+   All values are stored in the byte order of the machine. As the header
+   has 64 bytes and the memory map of a file is page aligned, each segment
+   of the payload is aligned to 64 bytes and can be used as the words of
+   a read-only filter without copying them. The hash functions of the
+   filters do not depend on a seed yet, so the seed is always 0. */
+
+static constexpr const char bloom_filter_file_magic[8]
+  = {'G','T','T','L','B','L','M','1'};
+static constexpr const uint32_t bloom_filter_file_version = 2;
+static constexpr const size_t bloom_filter_file_alignment = 64;
+
+enum class BloomFilterFileType : uint32_t
+{
+  bloom_filter = 1,
+  blocked_bloom_filter = 2,
+  one_hashing_blocked_bloom_filter = 3,
+  split_block_bloom_filter = 4,
+  single_interleaved_bloom_filter = 5,
+  interleaved_bloom_filter = 6,
+  interleaved_bloom_filter2 = 7
+};
+
+struct BloomFilterFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t type;
+  uint64_t num_bits;
+  uint64_t num_hash_functions;
+  uint64_t bins;
+  uint64_t seed;
+  uint64_t qgram_length; /* only used by InterleavedBloomFilter2 */
+  uint64_t payload_bytes;
+};
+
+static_assert(sizeof(BloomFilterFileHeader) == 64);
+
+[[nodiscard]] static inline size_t bloom_filter_file_padded(size_t bytes)
+                                                            noexcept
+{
+  return (bytes + bloom_filter_file_alignment - 1)
+         & ~(bloom_filter_file_alignment - 1);
+}
+
+/* writes the header with the given type and sizes and the segments
+   of the payload to filename */
+static inline void bloom_filter_file_write(
+                     const std::string &filename,
+                     BloomFilterFileType type,
+                     size_t num_bits,
+                     size_t num_hash_functions,
+                     size_t bins,
+                     size_t qgram_length,
+                     const std::vector<std::span<const std::byte>> &segments)
+{
+  BloomFilterFileHeader header{};
+  std::memcpy(header.magic,bloom_filter_file_magic,
+              sizeof bloom_filter_file_magic);
+  header.version = bloom_filter_file_version;
+  header.type = static_cast<uint32_t>(type);
+  header.num_bits = static_cast<uint64_t>(num_bits);
+  header.num_hash_functions = static_cast<uint64_t>(num_hash_functions);
+  header.bins = static_cast<uint64_t>(bins);
+  header.seed = 0;
+  header.qgram_length = static_cast<uint64_t>(qgram_length);
+  header.payload_bytes = 0;
+  for (auto &segment : segments)
+  {
+    header.payload_bytes += bloom_filter_file_padded(segment.size());
+  }
+  FILE *const out_fp = std::fopen(filename.c_str(),"wb");
+  if (out_fp == nullptr)
+  {
+    throw std::ios_base::failure(std::format(": cannot create Bloom filter "
+                                             "file {}", filename));
+  }
+  static constexpr const std::byte padding[bloom_filter_file_alignment]{};
+  bool written = std::fwrite(&header, sizeof header, 1, out_fp) == 1;
+  for (auto &segment : segments)
+  {
+    const size_t padding_bytes
+      = bloom_filter_file_padded(segment.size()) - segment.size();
+    written = written and
+              std::fwrite(segment.data(), 1, segment.size(), out_fp)
+                == segment.size() and
+              std::fwrite(padding, 1, padding_bytes, out_fp) == padding_bytes;
+  }
+  if (std::fclose(out_fp) != 0 or not written)
+  {
+    throw std::ios_base::failure(std::format(": cannot write Bloom filter "
+                                             "file {}", filename));
+  }
+}
+
+/* a memory map of a Bloom filter file of the given type, whose header is
+   checked */
+class BloomFilterFile
+{
+  std::string filename;
+  const Gttlmmap<uint8_t> mapped_file;
+  BloomFilterFileHeader header;
+
+  public:
+  BloomFilterFile(const std::string &_filename, BloomFilterFileType type)
+    : filename(_filename)
+    , mapped_file(_filename.c_str())
+    , header({})
+  {
+    if (mapped_file.size() < sizeof header)
+    {
+      throw std::runtime_error(std::format(": file {} is not a Bloom filter "
+                                           "file", filename));
+    }
+    std::memcpy(&header, mapped_file.ptr(), sizeof header);
+    if (std::memcmp(header.magic,bloom_filter_file_magic,
+                    sizeof bloom_filter_file_magic) != 0)
+    {
+      throw std::runtime_error(std::format(": file {} is not a Bloom filter "
+                                           "file", filename));
+    }
+    if (header.version != bloom_filter_file_version)
+    {
+      throw std::runtime_error(std::format(": Bloom filter file {} has "
+                                           "version {}, but version {} is "
+                                           "required", filename,
+                                           header.version,
+                                           bloom_filter_file_version));
+    }
+    if (header.type != static_cast<uint32_t>(type))
+    {
+      throw std::runtime_error(std::format(": Bloom filter file {} stores "
+                                           "a filter of type {}, but type {} "
+                                           "is expected", filename,
+                                           header.type,
+                                           static_cast<uint32_t>(type)));
+    }
+    if (header.seed != 0)
+    {
+      throw std::runtime_error(std::format(": Bloom filter file {} uses "
+                                           "hash functions with seed {}, "
+                                           "which are not supported",
+                                           filename, header.seed));
+    }
+    if (mapped_file.size() != sizeof header + header.payload_bytes)
+    {
+      throw std::runtime_error(std::format(": Bloom filter file {} has size "
+                                           "{}, which is inconsistent with "
+                                           "its header", filename,
+                                           mapped_file.size()));
+    }
+  }
+
+  BloomFilterFile(const BloomFilterFile &) = delete;
+  BloomFilterFile &operator=(const BloomFilterFile &) = delete;
+
+  [[nodiscard]] const BloomFilterFileHeader &header_get(void) const noexcept
+  {
+    return header;
+  }
+
+  /* the num_bytes bytes of the payload at the given offset, which must
+     be a multiple of alignment */
+  [[nodiscard]] const std::byte *payload_get(size_t offset, size_t num_bytes,
+                                             size_t alignment) const
+  {
+    if (offset + num_bytes > header.payload_bytes)
+    {
+      throw std::runtime_error(std::format(": the payload of Bloom filter "
+                                           "file {} has {} bytes, which is "
+                                           "inconsistent with its header",
+                                           filename, header.payload_bytes));
+    }
+    assert(offset % alignment == 0);
+    static_cast<void>(alignment);
+    return reinterpret_cast<const std::byte *>(mapped_file.ptr())
+           + sizeof header + offset;
+  }
+};
+
+/* The words of a Bloom filter, which are either owned by the filter or
+   are the words of the payload of a memory mapped Bloom filter file,
+   which cannot be modified. */
+template<class Word>
+class BloomFilterWords
+{
+  std::vector<Word> owned;
+  std::shared_ptr<const BloomFilterFile> mapped_file;
+  Word *words;
+  size_t num_words;
+
+  public:
+  explicit BloomFilterWords(size_t _num_words)
+    : owned(std::vector<Word>(_num_words))
+    , mapped_file(nullptr)
+    , words(owned.data())
+    , num_words(_num_words)
+  { }
+
+  /* the _num_words words at the given offset of the payload of the
+     file, which are copied to memory if copy is true */
+  BloomFilterWords(const std::shared_ptr<const BloomFilterFile> &file,
+                   size_t offset, size_t _num_words, bool copy)
+    : owned()
+    , mapped_file(nullptr)
+    , words(nullptr)
+    , num_words(_num_words)
+  {
+    const std::byte *const payload
+      = file->payload_get(offset, num_words * sizeof(Word), alignof(Word));
+    if (copy)
+    {
+      owned = std::vector<Word>(num_words);
+      /* the words are trivially copyable, except for std::atomic */
+      std::memcpy(static_cast<void *>(owned.data()), payload,
+                  num_words * sizeof(Word));
+      words = owned.data();
+    } else
+    {
+      mapped_file = file;
+      words = const_cast<Word *>(reinterpret_cast<const Word *>(payload));
+    }
+  }
+
+  BloomFilterWords(const BloomFilterWords &other)
+    : owned(other.owned)
+    , mapped_file(other.mapped_file)
+    , words(other.is_mapped() ? other.words : owned.data())
+    , num_words(other.num_words)
+  { }
+
+  BloomFilterWords(BloomFilterWords &&other) = default;
+
+  BloomFilterWords &operator=(const BloomFilterWords &other)
+  {
+    if (this != &other)
+    {
+      owned = other.owned;
+      mapped_file = other.mapped_file;
+      words = other.is_mapped() ? other.words : owned.data();
+      num_words = other.num_words;
+    }
+    return *this;
+  }
+
+  BloomFilterWords &operator=(BloomFilterWords &&other) = default;
+
+  [[nodiscard]] bool is_mapped(void) const noexcept
+  {
+    return mapped_file != nullptr;
+  }
+
+  void writable_check(void) const
+  {
+    if (is_mapped())
+    {
+      throw std::runtime_error(": cannot modify a Bloom filter whose words "
+                               "are memory mapped from a file");
+    }
+  }
+
+  /* the words of a memory mapped file are read-only, so the access for
+     modifying them throws an exception */
+  [[nodiscard]] Word &operator[](size_t idx)
+  {
+    assert(idx < num_words);
+    writable_check();
+    return words[idx];
+  }
+
+  [[nodiscard]] const Word &operator[](size_t idx) const noexcept
+  {
+    assert(idx < num_words);
+    return words[idx];
+  }
+
+  [[nodiscard]] Word *data(void)
+  {
+    writable_check();
+    return words;
+  }
+
+  [[nodiscard]] const Word *data(void) const noexcept
+  {
+    return words;
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return num_words;
+  }
+
+  /* the words as a segment of the payload of a Bloom filter file */
+  [[nodiscard]] std::span<const std::byte> bytes(void) const noexcept
+  {
+    return {reinterpret_cast<const std::byte *>(words),
+            num_words * sizeof(Word)};
+  }
+};
+#endif
@@ -0,0 +1,250 @@
+#ifndef CONCURRENT_COUNT_TABLE_HPP
+#define CONCURRENT_COUNT_TABLE_HPP
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "utilities/splitmix64.hpp"
+
+/* A hash table counting the occurrences of 64 bit keys, which can be
+   filled by several threads at the same time without locking. The
+   table uses open addressing: a key is stored in the bucket determined
+   by a hash of the key or, if this is full, in one of the next
+   max_probe_buckets - 1 buckets. Each bucket occupies one cache line
+   and stores slots_per_bucket pairs of key and count. A slot is claimed
+   for a key by a compare-and-swap operation on the empty key, while the
+   counts are incremented by atomic additions. If no slot is available
+   within the probed buckets, the key is counted in an overflow table
+   protected by a mutex. The number of buckets is determined from the
+   expected number of distinct keys, such that the load factor is at
+   most 0.5. If this is exceeded, more keys end up in the overflow
+   table. To avoid this, keys can be added in rounds, after each of
+   which grow is called if grow_needed is true. The key UINT64_MAX is
+   reserved to mark empty slots, which is no restriction for the integer
+   codes of k-mers with k < 32. */
+
+class GttlConcurrentCountTable
+{
+  public:
+  static constexpr const uint64_t empty_key = UINT64_MAX;
+  private:
+  static constexpr const size_t slots_per_bucket = 4;
+  static constexpr const size_t max_probe_buckets = 16;
+  struct Slot
+  {
+    std::atomic<uint64_t> key{empty_key};
+    std::atomic<uint64_t> count{0};
+  };
+  struct alignas(64) Bucket
+  {
+    Slot slots[slots_per_bucket];
+  };
+  static_assert(sizeof(Bucket) == 64);
+
+  std::vector<Bucket> buckets;
+  size_t bucket_mask;
+  std::atomic<size_t> occupied_slots;
+  std::unordered_map<uint64_t,uint64_t> overflow;
+  std::mutex overflow_mutex;
+
+  [[nodiscard]] static size_t buckets_number_for(size_t expected_keys)
+                                                 noexcept
+  {
+    return std::bit_ceil(std::max(size_t(1),
+                                  (2 * expected_keys + slots_per_bucket - 1)
+                                    / slots_per_bucket));
+  }
+
+  bool slots_add(uint64_t key, uint64_t count) noexcept
+  {
+    /* the keys are not randomly distributed */
+    size_t bucket_idx
+      = static_cast<size_t>(gttl_splitmix64_finalize(key)) & bucket_mask;
+    const size_t probes = std::min(max_probe_buckets, buckets.size());
+    for (size_t probe = 0; probe < probes; probe++)
+    {
+      for (auto &slot : buckets[bucket_idx].slots)
+      {
+        uint64_t stored_key = slot.key.load(std::memory_order_acquire);
+        if (stored_key == empty_key)
+        {
+          if (slot.key.compare_exchange_strong(stored_key, key,
+                                               std::memory_order_acq_rel))
+          {
+            occupied_slots.fetch_add(1, std::memory_order_relaxed);
+            slot.count.fetch_add(count, std::memory_order_relaxed);
+            return true;
+          }
+          /* another thread has claimed the slot, stored_key now is the
+             key stored by this thread */
+        }
+        if (stored_key == key)
+        {
+          slot.count.fetch_add(count, std::memory_order_relaxed);
+          return true;
+        }
+      }
+      bucket_idx = (bucket_idx + 1) & bucket_mask;
+    }
+    return false;
+  }
+
+  public:
+  explicit GttlConcurrentCountTable(size_t expected_keys)
+    : buckets(buckets_number_for(expected_keys))
+    , bucket_mask(buckets.size() - 1)
+    , occupied_slots(0)
+    , overflow({})
+  {}
+
+  GttlConcurrentCountTable(const GttlConcurrentCountTable &) = delete;
+  GttlConcurrentCountTable &operator=(const GttlConcurrentCountTable &)
+    = delete;
+
+  /* can be called by several threads at the same time */
+  void add(uint64_t key, uint64_t count = 1)
+  {
+    assert(key != empty_key);
+    if (not slots_add(key, count))
+    {
+      const std::lock_guard<std::mutex> overflow_lock(overflow_mutex);
+      overflow[key] += count;
+    }
+  }
+
+  /* the count of key; must not be called while keys are added */
+  [[nodiscard]] uint64_t count_get(uint64_t key) const noexcept
+  {
+    assert(key != empty_key);
+    size_t bucket_idx
+      = static_cast<size_t>(gttl_splitmix64_finalize(key)) & bucket_mask;
+    const size_t probes = std::min(max_probe_buckets, buckets.size());
+    for (size_t probe = 0; probe < probes; probe++)
+    {
+      for (auto &slot : buckets[bucket_idx].slots)
+      {
+        const uint64_t stored_key = slot.key.load(std::memory_order_relaxed);
+        if (stored_key == key)
+        {
+          return slot.count.load(std::memory_order_relaxed);
+        }
+        if (stored_key == empty_key)
+        {
+          return 0;
+        }
+      }
+      bucket_idx = (bucket_idx + 1) & bucket_mask;
+    }
+    const auto found = overflow.find(key);
+    return found == overflow.end() ? 0 : found->second;
+  }
+
+  /* rehashes all keys into a table with enough buckets for
+     expected_keys distinct keys, but at least twice as many buckets as
+     before. Must not be called while keys are added. */
+  void grow(size_t expected_keys)
+  {
+    std::vector<Bucket> old_buckets(std::max(buckets_number_for(expected_keys),
+                                             2 * buckets.size()));
+    old_buckets.swap(buckets);
+    bucket_mask = buckets.size() - 1;
+    occupied_slots.store(0, std::memory_order_relaxed);
+    std::unordered_map<uint64_t,uint64_t> old_overflow{};
+    old_overflow.swap(overflow);
+    for (auto &bucket : old_buckets)
+    {
+      for (auto &slot : bucket.slots)
+      {
+        const uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if (key != empty_key)
+        {
+          add(key, slot.count.load(std::memory_order_relaxed));
+        }
+      }
+    }
+    for (auto &[key, count] : old_overflow)
+    {
+      add(key, count);
+    }
+  }
+
+  /* calls process(key, count) for all keys in an unspecified order; must
+     not be called while keys are added */
+  template<class Processor>
+  void dump(Processor process) const
+  {
+    for (auto &bucket : buckets)
+    {
+      for (auto &slot : bucket.slots)
+      {
+        const uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if (key != empty_key)
+        {
+          process(key, slot.count.load(std::memory_order_relaxed));
+        }
+      }
+    }
+    for (auto &[key, count] : overflow)
+    {
+      process(key, count);
+    }
+  }
+
+  /* the pairs of key and count in ascending order of the keys */
+  [[nodiscard]] std::vector<std::pair<uint64_t,uint64_t>> sorted_dump(void)
+                                                             const
+  {
+    std::vector<std::pair<uint64_t,uint64_t>> key_count_pairs{};
+    key_count_pairs.reserve(size());
+    dump([&key_count_pairs](uint64_t key, uint64_t count)
+         {
+           key_count_pairs.emplace_back(key, count);
+         });
+    std::ranges::sort(key_count_pairs);
+    return key_count_pairs;
+  }
+
+  /* the histogram of the counts: element c with 0 < c < max_count is
+     the number of keys occurring exactly c times, element max_count is
+     the number of keys occurring at least max_count times */
+  [[nodiscard]] std::vector<size_t> histogram(size_t max_count) const
+  {
+    std::vector<size_t> counts_histogram(max_count + 1, 0);
+    dump([&counts_histogram,max_count](uint64_t, uint64_t count)
+         {
+           counts_histogram[std::min(static_cast<size_t>(count),
+                                     max_count)]++;
+         });
+    return counts_histogram;
+  }
+
+  /* the number of distinct keys */
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return occupied_slots.load(std::memory_order_relaxed) + overflow.size();
+  }
+
+  /* true if the load factor exceeds 0.5, so that grow should be called
+     before adding more keys */
+  [[nodiscard]] bool grow_needed(void) const noexcept
+  {
+    return 2 * size() > capacity_get();
+  }
+
+  [[nodiscard]] size_t overflow_size_get(void) const noexcept
+  {
+    return overflow.size();
+  }
+
+  [[nodiscard]] size_t capacity_get(void) const noexcept
+  {
+    return buckets.size() * slots_per_bucket;
+  }
+};
+#endif
@@ -0,0 +1,231 @@
+#ifndef COUNT_MIN_TABLE_HPP
+#define COUNT_MIN_TABLE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/* A count-min sketch estimating the number of occurrences of hash values.
+   It consists of depth rows of 2^width_bits counters. A hash value
+   increments one counter in each row, at an index derived from the hash
+   value by double hashing. The minimum of these counters is an upper
+   bound of the number of occurrences and overestimates it by at most
+   e * F1 / 2^width_bits with probability 1 - exp(-depth), where F1 is
+   the number of hash values added. In addition, the sketch keeps the
+   heavy_hitters_number hash values with the largest estimates seen so
+   far. As NtTable and BinaryNtTable, the class can be used as TableClass
+   in ntcard.hpp. When merging the tables of several threads, the
+   estimates of the candidates are recomputed from the merged counters.
+   A hash value which is frequent in the whole input but not among the
+   most frequent ones of any thread may be missed. */
+
+class CountMinTable
+{
+  public:
+  using CountType = uint32_t;
+  using HeavyHitter = std::pair<uint64_t,CountType>;
+  private:
+  size_t depth,
+         width_bits,
+         heavy_hitters_number;
+  uint64_t width_mask;
+  size_t qgram_count,
+         sequences_number;
+  std::vector<CountType> counters;
+  /* the candidates for the heavy hitters and the smallest estimate among
+     them, if there are heavy_hitters_number candidates, or 0 */
+  std::vector<HeavyHitter> heavy_hitters;
+  CountType heavy_hitters_min_count;
+
+  [[nodiscard]] static bool heavy_hitter_greater(const HeavyHitter &a,
+                                                 const HeavyHitter &b)
+                                                 noexcept
+  {
+    return a.second > b.second or (a.second == b.second and a.first < b.first);
+  }
+
+  [[nodiscard]] size_t counter_index(uint64_t hash, size_t row) const noexcept
+  {
+    const uint64_t second_hash = (hash >> 32) | uint64_t(1);
+    return (row << width_bits) +
+           static_cast<size_t>((hash + row * second_hash) & width_mask);
+  }
+
+  void heavy_hitters_min_count_update(void) noexcept
+  {
+    heavy_hitters_min_count = 0;
+    if (heavy_hitters.size() == heavy_hitters_number)
+    {
+      heavy_hitters_min_count
+        = std::ranges::min_element(heavy_hitters,{},
+                                   &HeavyHitter::second)->second;
+    }
+  }
+
+  void heavy_hitter_update(uint64_t hash, CountType estimate)
+  {
+    for (auto &heavy_hitter : heavy_hitters)
+    {
+      if (heavy_hitter.first == hash)
+      {
+        heavy_hitter.second = estimate;
+        heavy_hitters_min_count_update();
+        return;
+      }
+    }
+    if (heavy_hitters.size() < heavy_hitters_number)
+    {
+      heavy_hitters.emplace_back(hash, estimate);
+    } else
+    {
+      *std::ranges::min_element(heavy_hitters,{},&HeavyHitter::second)
+        = HeavyHitter(hash, estimate);
+    }
+    heavy_hitters_min_count_update();
+  }
+
+  public:
+  CountMinTable(size_t _depth, size_t _width_bits,
+                size_t _heavy_hitters_number)
+    : depth(_depth)
+    , width_bits(_width_bits)
+    , heavy_hitters_number(_heavy_hitters_number)
+    , width_mask((uint64_t(1) << _width_bits) - 1)
+    , qgram_count(0)
+    , sequences_number(0)
+    , counters({})
+    , heavy_hitters({})
+    , heavy_hitters_min_count(0)
+  {
+    if (depth == 0 or depth > 16)
+    {
+      throw std::invalid_argument(std::format("depth {} of count-min sketch "
+                                              "is not in the range from 1 to "
+                                              "16", depth));
+    }
+    if (width_bits < 4 or width_bits > 32)
+    {
+      throw std::invalid_argument(std::format("width_bits {} of count-min "
+                                              "sketch is not in the range "
+                                              "from 4 to 32", width_bits));
+    }
+    counters.resize(depth << width_bits, 0);
+    heavy_hitters.reserve(heavy_hitters_number);
+  }
+
+  void add_hash(uint64_t hash)
+  {
+    qgram_count++;
+    CountType estimate = std::numeric_limits<CountType>::max();
+    for (size_t row = 0; row < depth; row++)
+    {
+      CountType &counter = counters[counter_index(hash, row)];
+      counter += (counter < std::numeric_limits<CountType>::max());
+      estimate = std::min(estimate, counter);
+    }
+    if (heavy_hitters_number > 0 and estimate > heavy_hitters_min_count)
+    {
+      heavy_hitter_update(hash, estimate);
+    }
+  }
+
+  [[nodiscard]] CountType count_estimate(uint64_t hash) const noexcept
+  {
+    CountType estimate = std::numeric_limits<CountType>::max();
+    for (size_t row = 0; row < depth; row++)
+    {
+      estimate = std::min(estimate, counters[counter_index(hash, row)]);
+    }
+    return estimate;
+  }
+
+  void merge(const CountMinTable &other)
+  {
+    assert(depth == other.depth and width_bits == other.width_bits and
+           heavy_hitters_number == other.heavy_hitters_number);
+    for (size_t idx = 0; idx < counters.size(); idx++)
+    {
+      /* saturating addition, which is vectorized by the compiler */
+      const CountType sum = counters[idx] + other.counters[idx];
+      counters[idx] = sum < counters[idx]
+                        ? std::numeric_limits<CountType>::max()
+                        : sum;
+    }
+    for (auto &heavy_hitter : other.heavy_hitters)
+    {
+      if (std::ranges::find(heavy_hitters, heavy_hitter.first,
+                            &HeavyHitter::first) == heavy_hitters.end())
+      {
+        heavy_hitters.push_back(heavy_hitter);
+      }
+    }
+    for (auto &heavy_hitter : heavy_hitters)
+    {
+      heavy_hitter.second = count_estimate(heavy_hitter.first);
+    }
+    std::ranges::sort(heavy_hitters, heavy_hitter_greater);
+    if (heavy_hitters.size() > heavy_hitters_number)
+    {
+      heavy_hitters.resize(heavy_hitters_number);
+    }
+    heavy_hitters_min_count_update();
+    qgram_count += other.qgram_count;
+    sequences_number += other.sequences_number;
+  }
+
+  /* the candidates for the most frequent hash values with their
+     estimated counts, in descending order of the counts and ascending
+     order of the hash values for equal counts */
+  [[nodiscard]] std::vector<HeavyHitter> heavy_hitters_get(void) const
+  {
+    std::vector<HeavyHitter> sorted_heavy_hitters(heavy_hitters);
+    for (auto &heavy_hitter : sorted_heavy_hitters)
+    {
+      heavy_hitter.second = count_estimate(heavy_hitter.first);
+    }
+    std::ranges::sort(sorted_heavy_hitters, heavy_hitter_greater);
+    return sorted_heavy_hitters;
+  }
+
+  /* linear counting over the rows: the number of distinct hash values is
+     estimated from the fraction of counters which are 0. This is only
+     accurate if F0 is not much larger than 2^width_bits */
+  [[nodiscard]] double estimate_F0(void) const
+  {
+    const double width = static_cast<double>(width_mask) + 1.0;
+    double sum = 0.0;
+    for (size_t row = 0; row < depth; row++)
+    {
+      const auto row_begin = counters.begin() + (row << width_bits);
+      const size_t zero_counters
+        = static_cast<size_t>(std::count(row_begin,
+                                         row_begin + (size_t(1) << width_bits),
+                                         CountType(0)));
+      sum += width * std::log(width /
+                              static_cast<double>(std::max(zero_counters,
+                                                           size_t(1))));
+    }
+    return sum / static_cast<double>(depth);
+  }
+
+  [[nodiscard]] size_t F1_count_get(void) const noexcept { return qgram_count; }
+
+  void sequences_number_set(size_t _sequences_number)
+  {
+    assert(sequences_number == 0);
+    sequences_number = _sequences_number;
+  }
+
+  [[nodiscard]] size_t sequences_number_get(void) const noexcept
+  {
+    return sequences_number;
+  }
+};
+#endif
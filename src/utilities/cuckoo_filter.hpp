@@ -0,0 +1,471 @@
+#ifndef CUCKOO_FILTER_HPP
+#define CUCKOO_FILTER_HPP
+
+#include "utilities/bloom_filter_hash_function.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/* A counting cuckoo filter: each value is represented by a fingerprint of
+   16 bits, which is stored in one of two buckets of 8 slots. The first
+   bucket is determined by the hash value, the second by the first bucket
+   and the fingerprint, so that the alternative bucket of a stored
+   fingerprint can be computed when it has to be relocated. In contrast
+   to a Bloom filter, values can be removed, and each slot stores, besides
+   the fingerprint, a counter of 16 bits, so that the number of
+   insertions minus the number of removals of a value can be estimated.
+   The estimate may be too large due to other values with the same
+   fingerprint in one of the two buckets, which happens with probability
+   about 16/2^16 for a full filter. A counter reaching 2^16-1 is not
+   modified anymore. The slots of a bucket are compared with a
+   fingerprint by one AVX2 instruction. If all slots of both buckets are
+   occupied, fingerprints are relocated along a path of random slots
+   ending in a bucket with an empty slot. The moves are performed from the
+   end of the path, so that each fingerprint is always stored in at least
+   one slot. If no such path is found, insert returns false.
+
+   If thread_safe is true, several threads can insert and remove values at
+   the same time. The buckets are divided into num_stripes stripes, each
+   protected by a mutex. An insertion or removal only locks the stripes of
+   its two buckets, so threads modifying different buckets do not wait for
+   each other. A relocation moves fingerprints between arbitrary buckets
+   and is therefore performed while all stripes are locked. Queries do not
+   lock: the slots are read and written by atomic operations, and a query
+   which does not find a value during a relocation is repeated. */
+
+template <bool thread_safe>
+class CuckooFilter
+{
+ private:
+  static constexpr const size_t slots_per_bucket = 8;
+  static constexpr const size_t max_kicks = 500;
+  static constexpr const uint32_t fingerprint_mask = 0xFFFFU;
+  static constexpr const uint32_t count_one = uint32_t(1) << 16;
+  static constexpr const uint32_t count_max = 0xFFFFU;
+  struct alignas(32) Bucket
+  {
+    uint32_t slots[slots_per_bucket];
+  };
+  using Slots = std::array<uint32_t,slots_per_bucket>;
+  static constexpr const size_t num_stripes = 256;
+  struct alignas(64) Stripe
+  {
+    std::mutex mutex;
+  };
+
+  /* locks, in ascending order to avoid deadlocks, the stripes of two
+     buckets or all stripes */
+  class StripesLock
+  {
+   private:
+    std::vector<Stripe> &stripes;
+    size_t first_stripe,
+           last_stripe,
+           step;
+
+   public:
+    StripesLock(std::vector<Stripe> &_stripes, uint64_t bucket0,
+                uint64_t bucket1)
+      : stripes(_stripes)
+      , first_stripe(std::min(bucket0 % num_stripes, bucket1 % num_stripes))
+      , last_stripe(std::max(bucket0 % num_stripes, bucket1 % num_stripes))
+      , step(std::max(last_stripe - first_stripe, size_t(1)))
+    {
+      for (size_t idx = first_stripe; idx <= last_stripe; idx += step)
+      {
+        stripes[idx].mutex.lock();
+      }
+    }
+
+    explicit StripesLock(std::vector<Stripe> &_stripes)
+      : stripes(_stripes)
+      , first_stripe(0)
+      , last_stripe(num_stripes - 1)
+      , step(1)
+    {
+      for (size_t idx = first_stripe; idx <= last_stripe; idx += step)
+      {
+        stripes[idx].mutex.lock();
+      }
+    }
+
+    ~StripesLock(void)
+    {
+      for (size_t idx = first_stripe; idx <= last_stripe; idx += step)
+      {
+        stripes[idx].mutex.unlock();
+      }
+    }
+
+    StripesLock(const StripesLock &) = delete;
+    StripesLock &operator=(const StripesLock &) = delete;
+  };
+
+  std::vector<Bucket> buckets;
+  uint64_t bucket_mask;
+  uint64_t random_state;
+  /* only used if thread_safe is true. relocations is odd while a
+     relocation is performed */
+  std::vector<Stripe> stripes;
+  std::atomic<uint64_t> relocations;
+
+  [[nodiscard]] static uint32_t fingerprint(uint64_t hash_value) noexcept
+  {
+    const uint32_t fp = static_cast<uint32_t>(hash_value >> 48);
+    return fp == 0 ? uint32_t(1) : fp;
+  }
+
+  [[nodiscard]] uint64_t alternative_bucket(uint64_t bucket, uint32_t fp)
+                                            const noexcept
+  {
+    return (bucket ^ (static_cast<uint64_t>(fp) * UINT64_C(0x5bd1e995)))
+           & bucket_mask;
+  }
+
+  [[nodiscard]] static uint32_t slot_count(uint32_t slot) noexcept
+  {
+    return slot >> 16;
+  }
+
+  [[nodiscard]] uint32_t slot_load(const uint32_t &slot) const noexcept
+  {
+    if constexpr (thread_safe)
+    {
+      return std::atomic_ref<uint32_t>(const_cast<uint32_t &>(slot))
+               .load(std::memory_order_acquire);
+    } else
+    {
+      return slot;
+    }
+  }
+
+  void slot_store(uint32_t *slot, uint32_t value) noexcept
+  {
+    if constexpr (thread_safe)
+    {
+      std::atomic_ref<uint32_t>(*slot).store(value,
+                                             std::memory_order_release);
+    } else
+    {
+      *slot = value;
+    }
+  }
+
+  bool slot_replace(uint32_t *slot, uint32_t expected, uint32_t desired)
+                    noexcept
+  {
+    if constexpr (thread_safe)
+    {
+      return std::atomic_ref<uint32_t>(*slot)
+               .compare_exchange_strong(expected, desired,
+                                        std::memory_order_acq_rel);
+    } else
+    {
+      if (*slot != expected)
+      {
+        return false;
+      }
+      *slot = desired;
+      return true;
+    }
+  }
+
+  [[nodiscard]] Slots bucket_slots(uint64_t bucket) const noexcept
+  {
+    Slots slots;
+    for (size_t idx = 0; idx < slots_per_bucket; idx++)
+    {
+      slots[idx] = slot_load(buckets[bucket].slots[idx]);
+    }
+    return slots;
+  }
+
+  /* bit idx is set if the fingerprint of slot idx is fp, where the
+     fingerprint of an empty slot is 0 */
+  [[nodiscard]] static uint32_t fingerprint_matches(const Slots &slots,
+                                                    uint32_t fp) noexcept
+  {
+#ifdef __AVX2__
+    const __m256i fingerprints
+      = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                                              (slots.data())),
+                         _mm256_set1_epi32(static_cast<int>(
+                                             fingerprint_mask)));
+    const __m256i matches
+      = _mm256_cmpeq_epi32(fingerprints,
+                           _mm256_set1_epi32(static_cast<int>(fp)));
+    return static_cast<uint32_t>(_mm256_movemask_ps(
+                                   _mm256_castsi256_ps(matches)));
+#else
+    uint32_t matches = 0;
+    for (size_t idx = 0; idx < slots_per_bucket; idx++)
+    {
+      matches |= static_cast<uint32_t>((slots[idx] & fingerprint_mask) == fp)
+                 << idx;
+    }
+    return matches;
+#endif
+  }
+
+  /* the sum of the counts of the slots of both buckets with fingerprint
+     fp, at most count_max */
+  [[nodiscard]] uint32_t count_in_buckets(uint64_t bucket0, uint64_t bucket1,
+                                          uint32_t fp) const noexcept
+  {
+    uint32_t count = 0;
+    for (const uint64_t bucket : {bucket0, bucket1})
+    {
+      const Slots slots = bucket_slots(bucket);
+      for (uint32_t matches = fingerprint_matches(slots, fp); matches != 0;
+           matches &= matches - 1)
+      {
+        count += slot_count(slots[std::countr_zero(matches)]);
+      }
+    }
+    return std::min(count, count_max);
+  }
+
+  /* decrements the count of a slot with fingerprint fp in one of the
+     buckets, a slot whose count reaches 0 becomes empty */
+  bool remove_in_buckets(uint64_t bucket0, uint64_t bucket1, uint32_t fp)
+  {
+    for (const uint64_t bucket : {bucket0, bucket1})
+    {
+      const Slots slots = bucket_slots(bucket);
+      for (uint32_t matches = fingerprint_matches(slots, fp); matches != 0;
+           matches &= matches - 1)
+      {
+        uint32_t *const slot
+          = &buckets[bucket].slots[std::countr_zero(matches)];
+        for (uint32_t value_slot = slots[std::countr_zero(matches)];
+             (value_slot & fingerprint_mask) == fp;
+             value_slot = slot_load(*slot))
+        {
+          if (slot_count(value_slot) == count_max or
+              slot_replace(slot, value_slot,
+                           slot_count(value_slot) == 1
+                             ? 0
+                             : value_slot - count_one))
+          {
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  /* increments the count of a slot with fingerprint fp or stores fp with
+     count 1 in an empty slot of one of the buckets */
+  bool insert_without_relocation(uint64_t bucket0, uint64_t bucket1,
+                                 uint32_t fp) noexcept
+  {
+    for (const uint32_t wanted : {fp, uint32_t(0)})
+    {
+      for (const uint64_t bucket : {bucket0, bucket1})
+      {
+        const Slots slots = bucket_slots(bucket);
+        for (uint32_t matches = fingerprint_matches(slots, wanted);
+             matches != 0; matches &= matches - 1)
+        {
+          uint32_t *const slot
+            = &buckets[bucket].slots[std::countr_zero(matches)];
+          /* the slot may have been modified by another thread since it
+             was read, so it is reloaded in case of failure */
+          for (uint32_t value = slots[std::countr_zero(matches)];
+               (value & fingerprint_mask) == wanted;
+               value = slot_load(*slot))
+          {
+            if (wanted == 0)
+            {
+              if (slot_replace(slot, 0, count_one | fp))
+              {
+                return true;
+              }
+            } else
+            {
+              if (slot_count(value) == count_max or
+                  slot_replace(slot, value, value + count_one))
+              {
+                return true;
+              }
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] uint64_t random_next(void) noexcept
+  {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+  }
+
+  /* stores fp in bucket0 or bucket1 after relocating the fingerprints of a
+     path of slots, each to its alternative bucket */
+  bool insert_with_relocation(uint64_t bucket0, uint64_t bucket1,
+                              uint32_t fp)
+  {
+    std::vector<std::pair<uint64_t,size_t>> path{};
+    uint64_t bucket = (random_next() & 1) ? bucket0 : bucket1;
+    for (size_t kick = 0; kick < max_kicks; kick++)
+    {
+      const size_t slot_idx = random_next() % slots_per_bucket;
+      if (std::ranges::find(path, std::make_pair(bucket, slot_idx))
+          != path.end())
+      {
+        continue;
+      }
+      path.emplace_back(bucket, slot_idx);
+      const uint32_t moved = slot_load(buckets[bucket].slots[slot_idx]);
+      bucket = alternative_bucket(bucket, moved & fingerprint_mask);
+      const uint32_t empty_slots = fingerprint_matches(bucket_slots(bucket),
+                                                       0);
+      if (empty_slots != 0)
+      {
+        if constexpr (thread_safe)
+        {
+          relocations.fetch_add(1, std::memory_order_acq_rel);
+        }
+        uint32_t *destination
+          = &buckets[bucket].slots[std::countr_zero(empty_slots)];
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+          uint32_t *const source = &buckets[it->first].slots[it->second];
+          slot_store(destination, slot_load(*source));
+          destination = source;
+        }
+        slot_store(destination, count_one | fp);
+        if constexpr (thread_safe)
+        {
+          relocations.fetch_add(1, std::memory_order_acq_rel);
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+ public:
+  /* a filter with space for capacity different values */
+  explicit CuckooFilter(uint64_t capacity)
+    : buckets(std::vector<Bucket>(std::bit_ceil(std::max(
+                                    uint64_t(1),
+                                    static_cast<uint64_t>(
+                                      static_cast<double>(capacity) /
+                                      (0.95 * slots_per_bucket)) + 1)),
+                                  Bucket{}))
+    , bucket_mask(buckets.size() - 1)
+    , random_state(UINT64_C(0x9e3779b97f4a7c15))
+    , stripes(thread_safe ? num_stripes : 0)
+    , relocations(0)
+  { }
+
+  /* increments the count of value. Returns false if the filter is too
+     full to store a new value */
+  bool insert(uint64_t value)
+  {
+    const uint64_t hash_value = hash_function(value, 0);
+    const uint32_t fp = fingerprint(hash_value);
+    const uint64_t bucket0 = hash_value & bucket_mask;
+    const uint64_t bucket1 = alternative_bucket(bucket0, fp);
+    if constexpr (thread_safe)
+    {
+      {
+        const StripesLock lock(stripes, bucket0, bucket1);
+        if (insert_without_relocation(bucket0, bucket1, fp))
+        {
+          return true;
+        }
+      }
+      const StripesLock lock(stripes);
+      return insert_without_relocation(bucket0, bucket1, fp) or
+             insert_with_relocation(bucket0, bucket1, fp);
+    } else
+    {
+      return insert_without_relocation(bucket0, bucket1, fp) or
+             insert_with_relocation(bucket0, bucket1, fp);
+    }
+  }
+
+  /* decrements the count of value. Returns false if value is not
+     contained */
+  bool remove(uint64_t value)
+  {
+    const uint64_t hash_value = hash_function(value, 0);
+    const uint32_t fp = fingerprint(hash_value);
+    const uint64_t bucket0 = hash_value & bucket_mask;
+    const uint64_t bucket1 = alternative_bucket(bucket0, fp);
+    if constexpr (thread_safe)
+    {
+      const StripesLock lock(stripes, bucket0, bucket1);
+      return remove_in_buckets(bucket0, bucket1, fp);
+    } else
+    {
+      return remove_in_buckets(bucket0, bucket1, fp);
+    }
+  }
+
+  /* the estimated number of insertions minus removals of value */
+  [[nodiscard]] uint32_t count(uint64_t value) const
+  {
+    const uint64_t hash_value = hash_function(value, 0);
+    const uint32_t fp = fingerprint(hash_value);
+    const uint64_t bucket0 = hash_value & bucket_mask;
+    const uint64_t bucket1 = alternative_bucket(bucket0, fp);
+    if constexpr (thread_safe)
+    {
+      while (true)
+      {
+        const uint64_t before = relocations.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+          const uint32_t this_count = count_in_buckets(bucket0, bucket1, fp);
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (this_count > 0 or
+              relocations.load(std::memory_order_relaxed) == before)
+          {
+            return this_count;
+          }
+        }
+        /* another thread moves fingerprints, so instead of spinning,
+           the processor is given up to let it finish the relocation */
+        std::this_thread::yield();
+      }
+    } else
+    {
+      return count_in_buckets(bucket0, bucket1, fp);
+    }
+  }
+
+  [[nodiscard]] bool contains(uint64_t value) const
+  {
+    return count(value) > 0;
+  }
+
+  [[nodiscard]] size_t size_in_bytes(void) const
+  {
+    return buckets.size() * sizeof(Bucket);
+  }
+
+  [[nodiscard]] size_t num_hash_functions_get(void) const
+  {
+    return 1;
+  }
+};
+
+#endif // CUCKOO_FILTER_HPP
@@ -0,0 +1,308 @@
+#ifndef FIELD_PARSER_HPP
+#define FIELD_PARSER_HPP
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "utilities/gttl_file_open.hpp"
+
+/*
+** Allocation free parsing of lines consisting of a fixed number of columns.
+** The types of the columns are specified at compile time as the template
+** parameters Fields, e.g.
+**   GttlFieldParser<' ',true,size_t,size_t,std::string_view>
+** parses lines with exactly three columns, the first two of which are
+** converted to size_t using std::from_chars.
+** Columns of type std::string_view refer to the parsed line and are only
+** valid as long as the line is. If sep is ' ', columns are separated
+** by runs of blanks (i.e. spaces and tabulators) and leading blanks are
+** skipped, as done for whitespace separated files. Otherwise each
+** occurrence of sep separates two columns, as in TSV-files.
+** If exact_columns is false, lines may contain additional columns which
+** are ignored.
+** Lines which cannot be parsed lead to a std::runtime_error.
+*/
+
+template<char sep,bool exact_columns,class... Fields>
+class GttlFieldParser
+{
+  static_assert(sizeof...(Fields) > 0);
+  static constexpr bool is_blank(char cc) noexcept
+  {
+    if constexpr (sep == ' ')
+    {
+      return cc == ' ' or cc == '\t';
+    } else
+    {
+      return cc == sep;
+    }
+  }
+  static const char *skip_blanks(const char *ptr, const char *end) noexcept
+  {
+    if constexpr (sep == ' ')
+    {
+      while (ptr < end and is_blank(*ptr))
+      {
+        ptr++;
+      }
+    }
+    return ptr;
+  }
+  static const char *field_end(const char *ptr, const char *end) noexcept
+  {
+    if constexpr (sep == ' ')
+    {
+      while (ptr < end and not is_blank(*ptr))
+      {
+        ptr++;
+      }
+      return ptr;
+    } else
+    {
+      const void *found = std::memchr(ptr, sep, end - ptr);
+      return found == nullptr ? end : static_cast<const char *>(found);
+    }
+  }
+  template<class T>
+  static void convert(std::string_view field, size_t column, T &value)
+  {
+    if constexpr (std::is_same_v<T,std::string_view>)
+    {
+      value = field;
+    } else
+    {
+      if constexpr (std::is_same_v<T,std::string>)
+      {
+        value = std::string(field);
+      } else
+      {
+        static_assert(std::is_arithmetic_v<T>);
+        const char *const end = field.data() + field.size();
+        const auto [ptr, ec] = std::from_chars(field.data(), end, value);
+        if (ec != std::errc() or ptr != end)
+        {
+          throw std::runtime_error(std::format(": cannot convert \"{}\" in "
+                                               "column {} to a number",
+                                               field, column + 1));
+        }
+      }
+    }
+  }
+
+  public:
+  using Tuple = std::tuple<Fields...>;
+  static constexpr const size_t num_columns = sizeof...(Fields);
+
+  [[nodiscard]] static size_t columns_count(std::string_view line) noexcept
+  {
+    const char *ptr = line.data();
+    const char *const end = line.data() + line.size();
+    size_t count = 0;
+    ptr = skip_blanks(ptr, end);
+    if constexpr (sep == ' ')
+    {
+      while (ptr < end)
+      {
+        count++;
+        ptr = skip_blanks(field_end(ptr, end), end);
+      }
+      return count;
+    } else
+    {
+      return 1 + static_cast<size_t>(std::count(ptr, end, sep));
+    }
+  }
+
+  static void parse(std::string_view line, Tuple &values)
+  {
+    if (not line.empty() and line.back() == '\r')
+    {
+      line.remove_suffix(1);
+    }
+    const char *ptr = skip_blanks(line.data(), line.data() + line.size());
+    const char *const end = line.data() + line.size();
+    bool exhausted = false;
+    size_t column = 0;
+    const auto next_field = [&](auto &value)
+    {
+      if (exhausted or (sep == ' ' and ptr == end))
+      {
+        throw std::runtime_error(std::format(": line has {} columns, but {} "
+                                             "are expected",
+                                             columns_count(line),
+                                             num_columns));
+      }
+      const char *const f_end = field_end(ptr, end);
+      convert(std::string_view(ptr, static_cast<size_t>(f_end - ptr)),
+              column++, value);
+      if (f_end == end)
+      {
+        exhausted = true;
+      } else
+      {
+        ptr = skip_blanks(f_end + 1, end);
+      }
+    };
+    std::apply([&](auto &...value) { (next_field(value), ...); }, values);
+    if constexpr (exact_columns)
+    {
+      if (not exhausted and (sep != ' ' or ptr < end))
+      {
+        throw std::runtime_error(std::format(": line has {} columns, but {} "
+                                             "are expected",
+                                             columns_count(line),
+                                             num_columns));
+      }
+    }
+  }
+
+  [[nodiscard]] static Tuple parse(std::string_view line)
+  {
+    Tuple values;
+    parse(line, values);
+    return values;
+  }
+};
+
+/*
+** Reads a possibly gzipped file in chunks of buf_size bytes and parses
+** all complete lines of the current chunk with the given FieldParser
+** (an instance of GttlFieldParser). Each call of next_batch() delivers
+** the vector of tuples of one chunk. So lines are never copied into
+** std::string objects. Empty lines and lines beginning with # are
+** skipped. Columns of type std::string_view refer to the internal buffer
+** and are only valid until the next call of next_batch().
+** An empty batch signals the end of the input.
+*/
+
+template<class FieldParser,size_t buf_size = (size_t(1) << 16)>
+class GttlFieldsBatchReader
+{
+  using Tuple = typename FieldParser::Tuple;
+  GttlFpType file;
+  std::vector<char> buffer;
+  size_t buffer_end;     /* number of valid bytes in buffer */
+  size_t consumed;       /* number of bytes parsed in previous batch */
+  size_t line_number;
+  bool file_exhausted;
+  std::vector<Tuple> batch;
+
+  void parse_line(const char *line_start, const char *line_end)
+  {
+    line_number++;
+    if (line_start == line_end or *line_start == '#' or
+        (*line_start == '\r' and line_start + 1 == line_end))
+    {
+      return;
+    }
+    try
+    {
+      batch.emplace_back();
+      FieldParser::parse(std::string_view(line_start,
+                                          static_cast<size_t>(line_end -
+                                                              line_start)),
+                         batch.back());
+    }
+    catch (const std::runtime_error &err)
+    {
+      throw std::runtime_error(std::format(": line {}{}", line_number,
+                                           err.what()));
+    }
+  }
+
+  public:
+  explicit GttlFieldsBatchReader(const char *inputfile)
+    : file(gttl_fp_type_open(inputfile, "rb"))
+    , buffer(buf_size)
+    , buffer_end(0)
+    , consumed(0)
+    , line_number(0)
+    , file_exhausted(false)
+    , batch({})
+  {
+    if (file == nullptr)
+    {
+      throw std::ios_base::failure(std::format(": cannot open file {}",
+                                               inputfile));
+    }
+  }
+
+  GttlFieldsBatchReader(const GttlFieldsBatchReader&) = delete;
+  GttlFieldsBatchReader& operator=(const GttlFieldsBatchReader&) = delete;
+
+  ~GttlFieldsBatchReader(void)
+  {
+    gttl_fp_type_close(file);
+  }
+
+  const std::vector<Tuple> &next_batch(void)
+  {
+    batch.clear();
+    while (batch.empty())
+    {
+      /* move the incomplete line at the end of the buffer to the front */
+      assert(consumed <= buffer_end);
+      std::memmove(buffer.data(), buffer.data() + consumed,
+                   buffer_end - consumed);
+      buffer_end -= consumed;
+      consumed = 0;
+      if (file_exhausted)
+      {
+        if (buffer_end > 0)
+        {
+          parse_line(buffer.data(), buffer.data() + buffer_end);
+          consumed = buffer_end;
+          continue;
+        }
+        break;
+      }
+      if (buffer_end == buffer.size())
+      {
+        /* line longer than the buffer */
+        buffer.resize(2 * buffer.size());
+      }
+      const size_t bytes_read = gttl_fp_type_read(buffer.data() + buffer_end,
+                                                  sizeof(char),
+                                                  buffer.size() - buffer_end,
+                                                  file);
+      if (bytes_read == 0)
+      {
+        file_exhausted = true;
+        continue;
+      }
+      const char *line_start = buffer.data();
+      const char *const end = buffer.data() + buffer_end + bytes_read;
+      buffer_end += bytes_read;
+      while (true)
+      {
+        const char *const newline
+          = static_cast<const char *>(std::memchr(line_start, '\n',
+                                                  end - line_start));
+        if (newline == nullptr)
+        {
+          break;
+        }
+        parse_line(line_start, newline);
+        line_start = newline + 1;
+      }
+      consumed = static_cast<size_t>(line_start - buffer.data());
+    }
+    return batch;
+  }
+
+  [[nodiscard]] size_t line_number_get(void) const noexcept
+  {
+    return line_number;
+  }
+};
+#endif
@@ -4,9 +4,11 @@
 #ifdef __GNUC__
 #define GTTL_IS_LIKELY(X) __builtin_expect((X),1)
 #define GTTL_IS_UNLIKELY(X) __builtin_expect((X),0)
+#define GTTL_PREFETCH(ADDR) __builtin_prefetch(ADDR)
 #else
 #define GTTL_IS_LIKELY(X) (X)
 #define GTTL_IS_UNLIKELY(X) (X)
+#define GTTL_PREFETCH(ADDR) (void) (ADDR)
 #endif
 
 #endif
@@ -1,8 +1,16 @@
 #ifndef GTTL_FILE_OPEN_HPP
 #define GTTL_FILE_OPEN_HPP
 
+#ifdef _WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+#include <sys/stat.h>
+#include <cassert>
 #include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <stdexcept>
 #include <utility>
@@ -10,13 +18,68 @@
 #include "utilities/file_size.hpp"
 #include "utilities/has_gzip_header.hpp"
 
+/* The file name - denotes the standard input when opening a file for
+   reading and the standard output when opening a file for writing.
+   The corresponding file descriptor is duplicated, so that closing the
+   returned file pointer does not close the standard input or output.
+   As pipes cannot be rewound, gttl_fp_type_reset and gttl_fp_type_rewind
+   do not work for such files. */
+
+static inline bool gttl_is_standard_input(const char *file_name) noexcept
+{
+  return std::strcmp(file_name, "-") == 0;
+}
+
+static inline bool gttl_is_standard_input(const std::string &file_name)
+  noexcept
+{
+  return file_name == "-";
+}
+
+/* returns true if the input cannot be memory mapped or read more
+   than once, i.e. it is the standard input or not a regular file, such as
+   a named pipe or a file descriptor of a process substitution. */
+static inline bool gttl_is_stream_input(const std::string &file_name)
+  noexcept
+{
+  if (gttl_is_standard_input(file_name))
+  {
+    return true;
+  }
+  struct stat buf;
+  return stat(file_name.c_str(), &buf) == 0 and not S_ISREG(buf.st_mode);
+}
+
+static inline int gttl_standard_stream_fd_dup(const char *mode) noexcept
+{
+  return dup(std::strchr(mode, 'r') != nullptr ? fileno(stdin)
+                                               : fileno(stdout));
+}
+
 #ifndef GTTL_WITHOUT_ZLIB
 #include <cstring>
 #include <cassert>
 #include <zlib.h>
 
 using GttlFpType = gzFile;
-inline const auto gttl_fp_type_open = &gzopen;
+
+inline gzFile gttl_fp_type_open(const char *file_name, const char *mode)
+{
+  if (gttl_is_standard_input(file_name))
+  {
+    const int fd = gttl_standard_stream_fd_dup(mode);
+    return fd == -1 ? nullptr : gzdopen(fd, mode);
+  }
+  return gzopen(file_name, mode);
+}
+
+/* the file pointer takes ownership of fd, i.e. fd is closed by
+   gttl_fp_type_close */
+inline gzFile gttl_fp_type_fdopen(int fd, const char *mode)
+{
+  return gzdopen(fd, mode);
+}
+
 inline const auto gttl_fp_type_close = &gzclose;
 inline const auto gttl_fp_type_gets = &gzgets;
 inline const auto gttl_fp_type_getc = &gzgetc;
@@ -36,7 +99,22 @@ inline size_t gttl_fp_type_read(void* buf, size_t size, size_t count, gzFile fp)
 #else
 #include <ios>
 using GttlFpType = FILE *;
-inline const auto gttl_fp_type_open = &std::fopen;
+
+inline FILE *gttl_fp_type_open(const char *file_name, const char *mode)
+{
+  if (gttl_is_standard_input(file_name))
+  {
+    const int fd = gttl_standard_stream_fd_dup(mode);
+    return fd == -1 ? nullptr : fdopen(fd, mode);
+  }
+  return std::fopen(file_name, mode);
+}
+
+inline FILE *gttl_fp_type_fdopen(int fd, const char *mode)
+{
+  return fdopen(fd, mode);
+}
+
 inline const auto gttl_fp_type_close = &std::fclose;
 inline const auto gttl_fp_type_gets = &std::fgetc;
 inline const auto gttl_fp_type_is_eof = &std::feof;
@@ -66,6 +144,13 @@ static inline std::vector<BaseType>
   bool append_sequences = false;
   for(auto &&inputfile : inputfiles)
   {
+    /* the size of a pipe or a character device is not known in advance
+       and its first bytes cannot be inspected without consuming them */
+    if (gttl_is_stream_input(inputfile))
+    {
+      append_sequences = true;
+      break;
+    }
     if (has_gzip_header(inputfile.c_str()))
     {
 #ifdef GTTL_WITHOUT_ZLIB
@@ -89,7 +174,34 @@ static inline std::vector<BaseType>
   size_t file_counter = 0;
   for (auto &&inputfile : inputfiles)
   {
-    if (has_gzip_header(inputfile.c_str()))
+    if (gttl_is_stream_input(inputfile))
+    {
+      assert(append_sequences);
+      const GttlFpType fp = gttl_fp_type_open(inputfile.c_str(), "rb");
+      if (fp == nullptr)
+      {
+        throw std::runtime_error(gttl_is_standard_input(inputfile)
+                                   ? std::string("Failed to open standard "
+                                                 "input")
+                                   : std::string("Failed to open file ")
+                                     + inputfile);
+      }
+      while (true)
+      {
+        constexpr const size_t buf_size = size_t(1) << 16;
+        concatenated_content.resize(offset + buf_size/sizeof(BaseType));
+        const size_t bytes_read
+          = gttl_fp_type_read(concatenated_content.data() + offset,
+                              sizeof(char), buf_size, fp);
+        concatenated_content.resize(offset + bytes_read/sizeof(BaseType));
+        if (bytes_read == 0)
+        {
+          break;
+        }
+        offset += bytes_read/sizeof(BaseType);
+      }
+      gttl_fp_type_close(fp);
+    } else if (has_gzip_header(inputfile.c_str()))
     {
 #ifndef GTTL_WITHOUT_ZLIB
       gzFile const fp = gzopen(inputfile.c_str(), "rb");
@@ -182,10 +182,12 @@ class GttlLineGenerator
     return true;
   }
 
+  /* skips the next line and stores its length in *length_ptr. Like
+     read_from_file, a last line which is not terminated by a newline
+     counts as a line, so that the last quality line of a FASTQ file
+     without a final newline is not lost when the qualities are skipped */
   bool discard_line(size_t* length_ptr)
   {
-    char ch = EOF;
-
     assert(length_ptr != nullptr and *length_ptr == 0);
     while (true)
     {
@@ -194,21 +196,25 @@ class GttlLineGenerator
         if (not refill_file_buffer())
         {
           all_files_exhausted = true;
-          return false;
+          return *length_ptr > 0;
         }
       }
 
-      ch = file_buf_span[file_buf_pos];
-      if (ch == '\n')
+      const char* const next_newline
+        = static_cast<char*>(std::memchr(file_buf_span.data() + file_buf_pos,
+                                         '\n',
+                                         file_buf_end - file_buf_pos));
+      if (next_newline != nullptr)
       {
-        file_buf_pos++;
-        break;
+        const size_t line_len
+          = next_newline - (file_buf_span.data() + file_buf_pos);
+        *length_ptr += line_len;
+        file_buf_pos += line_len + 1;
+        return true;
       }
-
-      file_buf_pos++;
-      (*length_ptr)++;
+      *length_ptr += file_buf_end - file_buf_pos;
+      file_buf_pos = file_buf_end;
     }
-    return (ch != EOF);
   }
 
   public:
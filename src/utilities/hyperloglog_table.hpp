@@ -0,0 +1,164 @@
+#ifndef HYPERLOGLOG_TABLE_HPP
+#define HYPERLOGLOG_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#else
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/* A HyperLogLog sketch estimating the number of distinct hash values,
+   i.e. F0, with 2^precision registers of one byte. The lower precision
+   bits of a hash value select the register, which stores the maximum
+   number of leading zeros plus one of the remaining bits. The relative
+   standard error of the estimate is about 1.04/sqrt(2^precision), e.g.
+   0.8% for precision 14, which requires 16 KB. As NtTable and
+   BinaryNtTable, the class can be used as TableClass in ntcard.hpp. The
+   tables of several threads are merged by the maximum of the registers. */
+
+class HyperLogLogTable
+{
+  private:
+  size_t precision;
+  size_t qgram_count,
+         sequences_number;
+  std::vector<uint8_t> registers;
+
+  /* registers[idx] = max(registers[idx],other_registers[idx]) */
+  static void registers_max(uint8_t *registers, const uint8_t *other_registers,
+                            size_t len) noexcept
+  {
+    size_t idx = 0;
+#ifdef __AVX2__
+    for (/* Nothing */; idx + 32 <= len; idx += 32)
+    {
+      const __m256i vec
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                               (registers + idx));
+      const __m256i other_vec
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                               (other_registers + idx));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(registers + idx),
+                          _mm256_max_epu8(vec, other_vec));
+    }
+#else
+#ifdef __SSE2__
+    for (/* Nothing */; idx + 16 <= len; idx += 16)
+    {
+      const __m128i vec
+        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(registers + idx));
+      const __m128i other_vec
+        = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                            (other_registers + idx));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(registers + idx),
+                       _mm_max_epu8(vec, other_vec));
+    }
+#else
+#ifdef __ARM_NEON
+    for (/* Nothing */; idx + 16 <= len; idx += 16)
+    {
+      vst1q_u8(registers + idx, vmaxq_u8(vld1q_u8(registers + idx),
+                                         vld1q_u8(other_registers + idx)));
+    }
+#endif
+#endif
+#endif
+    for (/* Nothing */; idx < len; idx++)
+    {
+      registers[idx] = std::max(registers[idx], other_registers[idx]);
+    }
+  }
+
+  public:
+  explicit HyperLogLogTable(size_t _precision)
+    : precision(_precision)
+    , qgram_count(0)
+    , sequences_number(0)
+    , registers({})
+  {
+    if (precision < 4 or precision > 24)
+    {
+      throw std::invalid_argument(std::format("precision {} of HyperLogLog "
+                                              "sketch is not in the range "
+                                              "from 4 to 24", precision));
+    }
+    registers.resize(size_t(1) << precision, 0);
+  }
+
+  void add_hash(uint64_t hash)
+  {
+    qgram_count++;
+    const size_t idx = static_cast<size_t>(hash &
+                                           ((uint64_t(1) << precision) - 1));
+    /* one plus the number of leading zeros of the remaining
+       64 - precision bits, which is at most 65 - precision */
+    const uint8_t rank
+      = static_cast<uint8_t>(std::countl_zero(hash >> precision)
+                             - static_cast<int>(precision) + 1);
+    registers[idx] = std::max(registers[idx], rank);
+  }
+
+  void merge(const HyperLogLogTable &other)
+  {
+    assert(precision == other.precision);
+    registers_max(registers.data(), other.registers.data(), registers.size());
+    qgram_count += other.qgram_count;
+    sequences_number += other.sequences_number;
+  }
+
+  [[nodiscard]] double estimate_F0(void) const
+  {
+    const double m = static_cast<double>(registers.size());
+    const double alpha = registers.size() == 16
+                           ? 0.673
+                           : (registers.size() == 32
+                                ? 0.697
+                                : (registers.size() == 64
+                                     ? 0.709
+                                     : 0.7213/(1.0 + 1.079/m)));
+    double sum = 0.0;
+    size_t zero_registers = 0;
+    for (auto rank : registers)
+    {
+      sum += std::ldexp(1.0, -static_cast<int>(rank));
+      zero_registers += (rank == 0);
+    }
+    const double estimate = alpha * m * m / sum;
+    /* linear counting for small cardinalities */
+    if (estimate <= 2.5 * m and zero_registers > 0)
+    {
+      return m * std::log(m / static_cast<double>(zero_registers));
+    }
+    return estimate;
+  }
+
+  [[nodiscard]] size_t F1_count_get(void) const noexcept { return qgram_count; }
+
+  [[nodiscard]] size_t precision_get(void) const noexcept
+  {
+    return precision;
+  }
+
+  void sequences_number_set(size_t _sequences_number)
+  {
+    assert(sequences_number == 0);
+    sequences_number = _sequences_number;
+  }
+
+  [[nodiscard]] size_t sequences_number_get(void) const noexcept
+  {
+    return sequences_number;
+  }
+};
+#endif
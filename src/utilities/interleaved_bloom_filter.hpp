@@ -5,37 +5,62 @@
 #ifndef INTERLEAVED_BLOOM_FILTER_HPP
 #define INTERLEAVED_BLOOM_FILTER_HPP
 
+#include "sequences/char_finder.hpp"
+#include "sequences/char_range.hpp"
+#include "sequences/gttl_multiseq.hpp"
 #include "sequences/multiseq_factory.hpp"
-#include "utilities/bloom_filter.hpp"
+#include "sequences/nthash_lanes.hpp"
+#include "sequences/qgrams_hash_nthash.hpp"
+#include "threading/thread_pool_var.hpp"
+#include "utilities/bloom_filter_file.hpp"
 #include "utilities/bloom_filter_hash_function.hpp"
+#include "utilities/gcc_builtin.hpp"
 #include "utilities/multibitvector.hpp"
+#include "utilities/splitmix64.hpp"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <climits>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <format>
+#include <memory>
 #include <numbers>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 template <class T>
 class SingleInterleavedBloomFilter
 {
-  // This gives it access to the private set_bit function
-  friend class InterleavedBloomFilter2;
  private:
+  // This gives it access to the constructor for the words of a file
+  friend class InterleavedBloomFilter;
   const size_t num_hash_functions;
-  std::vector<T> data;
+  BloomFilterWords<T> data;
+
+  SingleInterleavedBloomFilter(size_t _num_hash_functions,
+                               BloomFilterWords<T> &&_data)
+    : num_hash_functions(_num_hash_functions)
+    , data(std::move(_data))
+  { }
 
-  void set_bit(size_t bin, size_t pos)
-  {
-    data[pos] |= (static_cast<T>(1)) << bin;
-  }
  public:
   SingleInterleavedBloomFilter(uint64_t num_bits, size_t _num_hash_functions)
     : num_hash_functions(_num_hash_functions)
-    , data(std::vector<T>(num_bits))
+    , data(BloomFilterWords<T>(num_bits))
   { }
 
-
   void insert(size_t bin, uint64_t value)
   {
     for (size_t idx = 0; idx < num_hash_functions; idx++)
@@ -79,6 +104,45 @@ class SingleInterleavedBloomFilter
   {
     return num_hash_functions;
   }
+
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::
+                              single_interleaved_bloom_filter,
+                            data.size(), num_hash_functions,
+                            sizeof(T) * CHAR_BIT, 0, {data.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the words are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static SingleInterleavedBloomFilter load(
+                                                   const std::string &filename,
+                                                   bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::single_interleaved_bloom_filter);
+    const BloomFilterFileHeader &header = file->header_get();
+    if (header.bins != sizeof(T) * CHAR_BIT)
+    {
+      throw std::runtime_error(std::format(": Bloom filter file {} stores "
+                                           "{} bins per word, but {} are "
+                                           "expected", filename,
+                                           header.bins,
+                                           sizeof(T) * CHAR_BIT));
+    }
+    return SingleInterleavedBloomFilter(header.num_hash_functions,
+                                        BloomFilterWords<T>(file, 0,
+                                                            header.num_bits,
+                                                            not memory_map));
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return data.is_mapped();
+  }
 };
 
 class InterleavedBloomFilter
@@ -87,6 +151,10 @@ class InterleavedBloomFilter
   std::vector<SingleInterleavedBloomFilter<uint64_t>> bloom_filter;
   size_t bins;
 
+  explicit InterleavedBloomFilter(size_t _bins)
+    : bins(_bins)
+  { }
+
  public:
   InterleavedBloomFilter(size_t bins, size_t num_bits,
                          size_t num_hash_functions)
@@ -134,7 +202,7 @@ class InterleavedBloomFilter
     {
       const uint64_t local_result = bloom_filter.at(idx).contains(value);
       // printf("local_result: %064lb\n", local_result);
-      for (size_t j = 0; j < std::min<size_t>(64, idx * 64 - bins); j++)
+      for (size_t j = 0; j < std::min<size_t>(64, bins - idx * 64); j++)
       {
         if (((local_result >> j) & 1) == 1)
         {
@@ -164,114 +232,510 @@ class InterleavedBloomFilter
     }
     return max;
   }
+
+  /* the payload consists of the numbers of bits of the filters of 64 bins
+     each, followed by the words of these filters */
+  void serialize(const std::string &filename) const
+  {
+    std::vector<uint64_t> num_bits_table{};
+    std::vector<std::span<const std::byte>> segments{{}};
+    for (const auto &single_filter : bloom_filter)
+    {
+      num_bits_table.push_back(single_filter.num_bits_get());
+      segments.push_back(single_filter.data.bytes());
+    }
+    segments[0] = std::as_bytes(std::span<const uint64_t>(num_bits_table));
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::interleaved_bloom_filter,
+                            individual_size() / sizeof(uint64_t),
+                            bloom_filter.empty()
+                              ? 0
+                              : bloom_filter[0].num_hash_functions_get(),
+                            bins, 0, segments);
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the words are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static InterleavedBloomFilter load(const std::string &filename,
+                                                   bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::interleaved_bloom_filter);
+    const BloomFilterFileHeader &header = file->header_get();
+    const size_t num_filters = (header.bins + 63) / 64;
+    const uint64_t *const num_bits_table
+      = reinterpret_cast<const uint64_t *>(
+          file->payload_get(0, num_filters * sizeof(uint64_t),
+                            alignof(uint64_t)));
+    InterleavedBloomFilter ibf(header.bins);
+    size_t offset = bloom_filter_file_padded(num_filters * sizeof(uint64_t));
+    for (size_t idx = 0; idx < num_filters; idx++)
+    {
+      ibf.bloom_filter.push_back(SingleInterleavedBloomFilter<uint64_t>(
+                                   header.num_hash_functions,
+                                   BloomFilterWords<uint64_t>(
+                                     file, offset, num_bits_table[idx],
+                                     not memory_map)));
+      offset += bloom_filter_file_padded(num_bits_table[idx]
+                                         * sizeof(uint64_t));
+    }
+    return ibf;
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return not bloom_filter.empty() and bloom_filter[0].is_memory_mapped();
+  }
 };
 
+static constexpr const char_finder::NucleotideFinder ibf_nucleotide_finder{};
+using InterleavedBloomFilterRanger
+  = GttlCharRange<char_finder::NucleotideFinder, ibf_nucleotide_finder,
+                  true, false>;
+
+/* An interleaved Bloom filter of bins Bloom filters, which all consist of
+   num_bits bits and use the same num_hash_functions hash functions. It is
+   stored as one matrix of num_bits rows of words_per_row words each,
+   where bit b % 64 of word b / 64 of a row belongs to bin b. So the bins
+   possibly containing a value are given by the conjunction of the
+   num_hash_functions rows selected by the value, which is computed with
+   AVX2 for four words, i.e. 256 bins, at a time. num_bits is determined
+   by the bin of the factory with the longest sequences and the given
+   false positive rate. If a q-gram length is given, the bins are filled
+   with the canonical ntHash values of the q-grams of the sequences of the
+   parts of the factory by num_threads threads. Each task fills the 64
+   bins stored in one word column of the matrix, so that no two threads
+   modify the same word and no atomic operations are required. Only if
+   there are fewer word columns than threads, each task fills one bin,
+   setting the bits by atomic operations. A CountingAgent counts, for a
+   batch of values or the q-grams of a sequence, how many of them each bin
+   contains, as required for distributing reads to bins. */
+
 class InterleavedBloomFilter2
 {
  private:
-  std::vector<SingleInterleavedBloomFilter<uint64_t>> bloom_filter_vec;
-  size_t bins;
-  BloomFilter<false> insert_bloom_filter;
-  bool insert_bloom_filter_is_valid = false;
-  size_t current_insert = 0;
+  static constexpr const size_t max_hash_functions = 16;
+  static constexpr const size_t hash_buffer_size = 256;
+  size_t bins,
+         words_per_row,
+         num_bits,
+         num_hash_functions,
+         qgram_length;
+  BloomFilterWords<uint64_t> matrix;
 
- public:
-  InterleavedBloomFilter2(GttlMultiseqFactory* multiseq_factory, double error)
-      : bins(multiseq_factory->size()),
-        insert_bloom_filter(BloomFilter<false>(size_t{0}, size_t{0}))
+  /* the offsets of the rows selected by value in the matrix, obtained by
+     double hashing and mapping the hash values to the range of rows by a
+     multiplication instead of a modulo operation */
+  void row_offsets(uint64_t value, size_t *offsets) const noexcept
   {
-    for (size_t idx = 0; idx < (bins + 63) / 64; idx++)
+    const uint64_t hash_value = gttl_splitmix64_finalize(value);
+    const uint64_t second_hash
+      = ((hash_value << 32) | (hash_value >> 32)) | uint64_t(1);
+    for (size_t idx = 0; idx < num_hash_functions; idx++)
     {
-      size_t num_bits = 0;
-      size_t num_hash_functions = 0;
-      for (size_t j = 0; j < std::min(size_t{64}, bins - idx * 64); j++)
-      {
-        const size_t number_of_elements = multiseq_factory->at(idx * 64 + j)
-                                            ->sequences_total_length_get();
-        const double ln_error = std::log(error);
+      const uint64_t this_hash = hash_value + idx * second_hash;
+      const size_t row
+        = static_cast<size_t>((static_cast<__uint128_t>(this_hash) *
+                               num_bits) >> 64);
+      offsets[idx] = row * words_per_row;
+      GTTL_PREFETCH(matrix.data() + offsets[idx]);
+    }
+  }
 
-        num_hash_functions =
-            std::max<size_t>(num_hash_functions,
-                             ln_error * -std::numbers::log2e);
-        num_bits = std::max<size_t>(
-            num_bits,
-            (static_cast<double>(number_of_elements)) * ln_error * -2.081368);
+  template<bool concurrent>
+  void insert_bits(size_t bin, uint64_t value)
+  {
+    assert(bin < bins);
+    std::array<size_t,max_hash_functions> offsets;
+    row_offsets(value, offsets.data());
+    const uint64_t mask = uint64_t(1) << (bin % 64);
+    for (size_t idx = 0; idx < num_hash_functions; idx++)
+    {
+      uint64_t &word = matrix[offsets[idx] + bin / 64];
+      if constexpr (concurrent)
+      {
+        std::atomic_ref<uint64_t> atomic_word(word);
+        /* the atomic operation is only required if the bit is not set */
+        if ((atomic_word.load(std::memory_order_relaxed) & mask) == 0)
+        {
+          atomic_word.fetch_or(mask, std::memory_order_relaxed);
+        }
+      } else
+      {
+        word |= mask;
       }
-      bloom_filter_vec.emplace_back(num_bits, num_hash_functions);
     }
   }
 
-  void insert(size_t bin, uint64_t value)
+  /* stores the conjunction of the rows selected by value in conjunction,
+     which must have space for words_per_row words */
+  void rows_conjunction(uint64_t value, uint64_t *conjunction) const
   {
-    if (insert_bloom_filter_is_valid && bin != current_insert)
+    std::array<size_t,max_hash_functions> offsets;
+    row_offsets(value, offsets.data());
+    const uint64_t *const rows = matrix.data();
+    size_t word_idx = 0;
+#ifdef __AVX2__
+    for (/* Nothing */; word_idx + 4 <= words_per_row; word_idx += 4)
     {
-      flush_insert_bloom_filter();
+      __m256i result
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                               (rows + offsets[0] + word_idx));
+      for (size_t idx = 1; idx < num_hash_functions; idx++)
+      {
+        result = _mm256_and_si256(result,
+                                  _mm256_loadu_si256(
+                                    reinterpret_cast<const __m256i *>
+                                      (rows + offsets[idx] + word_idx)));
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(conjunction + word_idx),
+                          result);
     }
-    if (!insert_bloom_filter_is_valid)
+#endif
+    for (/* Nothing */; word_idx < words_per_row; word_idx++)
     {
-      const size_t num_bits = bloom_filter_vec.at(bin / 64).num_bits_get();
-      const size_t num_hash_functions
-        = bloom_filter_vec.at(bin / 64).num_hash_functions_get();
-      insert_bloom_filter = BloomFilter<false>(num_bits, num_hash_functions);
-      current_insert = bin;
-      insert_bloom_filter_is_valid = true;
+      uint64_t result = rows[offsets[0] + word_idx];
+      for (size_t idx = 1; idx < num_hash_functions; idx++)
+      {
+        result &= rows[offsets[idx] + word_idx];
+      }
+      conjunction[word_idx] = result;
     }
-    insert_bloom_filter.insert(value);
   }
 
-  Multibitvector<true> contains(uint64_t value)
+  /* applies process to the canonical ntHash values of all q-grams of
+     sequence not containing a wildcard */
+  template<class Process>
+  static void qgram_hash_values_apply(size_t qgram_length,
+                                      const char *sequence, size_t seqlen,
+                                      Process process)
   {
-    if (insert_bloom_filter_is_valid)
-    {
-      flush_insert_bloom_filter();
-    }
-    Multibitvector<true> result(bins);
-    for (size_t idx = 0; idx < (bins + 63) / 64; idx++)
+    std::array<uint64_t,hash_buffer_size> fwd_hash_values;
+    std::array<uint64_t,hash_buffer_size> rc_hash_values;
+    const InterleavedBloomFilterRanger ranger(sequence, seqlen);
+    for (auto const &&range : ranger)
     {
-      const uint64_t local_result = bloom_filter_vec.at(idx).contains(value);
-      // printf("local_result: %064lb\n", local_result);
-      for (size_t j = 0; j < std::min<size_t>(64, idx * 64 - bins); j++)
+      const size_t this_length = std::get<1>(range);
+      if (this_length < qgram_length)
       {
-        if (((local_result >> j) & 1) == 1)
+        continue;
+      }
+      QgramNtHashLanesIterator4 qgiter(qgram_length,
+                                       sequence + std::get<0>(range),
+                                       this_length);
+      while (true)
+      {
+        const size_t count = qgiter.fill(fwd_hash_values.data(),
+                                         rc_hash_values.data(),
+                                         hash_buffer_size);
+        if (count == 0)
         {
-          result.set(idx * 64 + j);
+          break;
+        }
+        for (size_t idx = 0; idx < count; idx++)
+        {
+          process(std::min(fwd_hash_values[idx], rc_hash_values[idx]));
         }
       }
     }
-    return result;
   }
 
-  [[nodiscard]] size_t size() const
+  InterleavedBloomFilter2(size_t _bins, size_t _num_bits,
+                          size_t _num_hash_functions, size_t _qgram_length,
+                          BloomFilterWords<uint64_t> &&_matrix)
+    : bins(_bins)
+    , words_per_row(std::max(size_t(1), (_bins + 63) / 64))
+    , num_bits(_num_bits)
+    , num_hash_functions(_num_hash_functions)
+    , qgram_length(_qgram_length)
+    , matrix(std::move(_matrix))
   {
-    size_t sum = 0;
-    for (const auto & idx : bloom_filter_vec)
+    if (num_hash_functions == 0 or num_hash_functions > max_hash_functions)
     {
-      sum += idx.size();
+      throw std::runtime_error(std::format(": {} hash functions are not "
+                                           "possible for interleaved Bloom "
+                                           "filter, the maximum is {}",
+                                           num_hash_functions,
+                                           max_hash_functions));
     }
-    return sum;
   }
 
-  [[nodiscard]] size_t individual_size() const
+  template<bool concurrent>
+  void bin_fill(size_t bin, const GttlMultiseq *multiseq)
   {
-    size_t max = 0;
-    for (const auto & idx : bloom_filter_vec)
+    for (size_t seqnum = 0; seqnum < multiseq->sequences_number_get();
+         seqnum++)
     {
-      max = std::max(max, idx.size());
+      qgram_hash_values_apply(qgram_length,
+                              multiseq->sequence_ptr_get(seqnum),
+                              multiseq->sequence_length_get(seqnum),
+                              [this, bin] (uint64_t hash_value)
+                              {
+                                insert_bits<concurrent>(bin, hash_value);
+                              });
     }
-    return max;
   }
 
-  void flush_insert_bloom_filter(void)
+ public:
+  /* an empty filter with one bin for each part of the factory */
+  InterleavedBloomFilter2(const GttlMultiseqFactory *multiseq_factory,
+                          double error)
+    : bins(multiseq_factory->size())
+    , words_per_row(std::max(size_t(1), (bins + 63) / 64))
+    , num_bits(0)
+    , num_hash_functions(0)
+    , qgram_length(0)
+    , matrix(BloomFilterWords<uint64_t>(0))
+  {
+    if (error <= 0.0 or error >= 1.0)
+    {
+      throw std::invalid_argument(std::format(": false positive rate {} of "
+                                              "interleaved Bloom filter is "
+                                              "not in the range from 0 to 1 "
+                                              "(exclusive)", error));
+    }
+    size_t max_number_of_elements = 0;
+    for (size_t bin = 0; bin < bins; bin++)
+    {
+      max_number_of_elements
+        = std::max(max_number_of_elements,
+                   multiseq_factory->at(bin)->sequences_total_length_get());
+    }
+    const double ln_error = std::log(error);
+    num_hash_functions
+      = std::clamp(static_cast<size_t>(ln_error * -std::numbers::log2e),
+                   size_t(1), max_hash_functions);
+    num_bits
+      = std::max(size_t(64),
+                 static_cast<size_t>(std::ceil(
+                   static_cast<double>(max_number_of_elements) *
+                   ln_error * -2.081368)));
+    matrix = BloomFilterWords<uint64_t>(num_bits * words_per_row);
+  }
+
+  /* a filter with one bin for each part of the factory, containing the
+     q-grams of the sequences of the part */
+  InterleavedBloomFilter2(const GttlMultiseqFactory *multiseq_factory,
+                          double error, size_t _qgram_length,
+                          size_t num_threads)
+    : InterleavedBloomFilter2(multiseq_factory, error)
+  {
+    if (_qgram_length == 0 or _qgram_length > 32)
+    {
+      throw std::invalid_argument(std::format(": q-gram length {} is not "
+                                              "possible for interleaved "
+                                              "Bloom filter, it must be in "
+                                              "the range from 1 to 32",
+                                              _qgram_length));
+    }
+    qgram_length = _qgram_length;
+    if (num_threads <= 1)
+    {
+      for (size_t bin = 0; bin < bins; bin++)
+      {
+        bin_fill<false>(bin, multiseq_factory->at(bin));
+      }
+    } else if (words_per_row >= num_threads)
+    {
+      gttl_thread_pool_var(num_threads, words_per_row,
+                           [this, multiseq_factory] (size_t, size_t word_idx)
+                           {
+                             const size_t last_bin
+                               = std::min(bins, 64 * (word_idx + 1));
+                             for (size_t bin = 64 * word_idx;
+                                  bin < last_bin; bin++)
+                             {
+                               bin_fill<false>(bin,
+                                               multiseq_factory->at(bin));
+                             }
+                           });
+    } else
+    {
+      gttl_thread_pool_var(num_threads, bins,
+                           [this, multiseq_factory] (size_t, size_t bin)
+                           {
+                             bin_fill<true>(bin, multiseq_factory->at(bin));
+                           });
+    }
+  }
+
+  void insert(size_t bin, uint64_t value)
+  {
+    insert_bits<false>(bin, value);
+  }
+
+  [[nodiscard]] Multibitvector<true> contains(uint64_t value) const
+  {
+    std::vector<uint64_t> conjunction(words_per_row);
+    rows_conjunction(value, conjunction.data());
+    Multibitvector<true> result(bins);
+    for (size_t word_idx = 0; word_idx < words_per_row; word_idx++)
+    {
+      for (uint64_t bits = conjunction[word_idx]; bits != 0;
+           bits &= bits - 1)
+      {
+        result.set(word_idx * 64 + std::countr_zero(bits));
+      }
+    }
+    return result;
+  }
+
+  /* the minimum number of q-grams of a sequence with num_qgrams q-grams,
+     which are also q-grams of a sequence differing from it by at most
+     errors substitutions, insertions or deletions, according to the
+     q-gram lemma, but at least 1 */
+  [[nodiscard]] static size_t qgram_lemma_threshold(size_t num_qgrams,
+                                                    size_t qgram_length,
+                                                    size_t errors) noexcept
   {
-    for (size_t idx = 0; idx < insert_bloom_filter.num_bits_get(); idx++)
+    return num_qgrams > errors * qgram_length
+             ? num_qgrams - errors * qgram_length
+             : size_t(1);
+  }
+
+  /* counts the number of values of a batch contained in each bin. Each
+     thread uses its own agent for the same filter. */
+  class CountingAgent
+  {
+   private:
+    const InterleavedBloomFilter2 *ibf;
+    std::vector<uint64_t> conjunction,
+                          hash_values;
+    std::vector<uint32_t> counts;
+    std::vector<size_t> selected_bins;
+
+   public:
+    explicit CountingAgent(const InterleavedBloomFilter2 *_ibf)
+      : ibf(_ibf)
+      , conjunction(std::vector<uint64_t>(_ibf->words_per_row))
+      , hash_values({})
+      , counts(std::vector<uint32_t>(_ibf->words_per_row * 64))
+      , selected_bins({})
+    { }
+
+    /* element b of the result is the number of values contained in bin b.
+       Only the first bins elements are meaningful. */
+    const std::vector<uint32_t> &bulk_count(std::span<const uint64_t> values)
+    {
+      std::ranges::fill(counts, 0);
+      for (auto value : values)
+      {
+        ibf->rows_conjunction(value, conjunction.data());
+        for (size_t word_idx = 0; word_idx < conjunction.size(); word_idx++)
+        {
+          for (uint64_t bits = conjunction[word_idx]; bits != 0;
+               bits &= bits - 1)
+          {
+            counts[word_idx * 64 + std::countr_zero(bits)]++;
+          }
+        }
+      }
+      return counts;
+    }
+
+    /* as before for the canonical ntHash values of the q-grams of
+       sequence, using the q-gram length of the filter */
+    const std::vector<uint32_t> &bulk_count(const char *sequence,
+                                            size_t seqlen)
+    {
+      assert(ibf->qgram_length > 0);
+      hash_values.clear();
+      qgram_hash_values_apply(ibf->qgram_length, sequence, seqlen,
+                              [this] (uint64_t hash_value)
+                              {
+                                hash_values.push_back(hash_value);
+                              });
+      return bulk_count(hash_values);
+    }
+
+    /* the number of q-grams counted by the last call of bulk_count for a
+       sequence */
+    [[nodiscard]] size_t qgrams_number_get(void) const noexcept
     {
-      if (insert_bloom_filter.get_bit(idx))
+      return hash_values.size();
+    }
+
+    /* the bins with a count of at least threshold in the last call of
+       bulk_count, in ascending order */
+    const std::vector<size_t> &bins_select(size_t threshold)
+    {
+      selected_bins.clear();
+      for (size_t bin = 0; bin < ibf->bins; bin++)
       {
-        bloom_filter_vec.at(current_insert / 64)
-                        .set_bit(current_insert % 64, idx);
+        if (counts[bin] >= threshold)
+        {
+          selected_bins.push_back(bin);
+        }
       }
+      return selected_bins;
     }
-    insert_bloom_filter_is_valid = false;
+  };
+
+  [[nodiscard]] size_t size(void) const
+  {
+    return matrix.size() * sizeof(uint64_t);
+  }
+
+  /* the size of the Bloom filters of 64 bins */
+  [[nodiscard]] size_t individual_size(void) const
+  {
+    return num_bits * sizeof(uint64_t);
+  }
+
+  [[nodiscard]] size_t bins_get(void) const noexcept
+  {
+    return bins;
+  }
+
+  [[nodiscard]] size_t num_bits_get(void) const noexcept
+  {
+    return num_bits;
+  }
+
+  [[nodiscard]] size_t num_hash_functions_get(void) const noexcept
+  {
+    return num_hash_functions;
+  }
+
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::interleaved_bloom_filter2,
+                            num_bits, num_hash_functions, bins, qgram_length,
+                            {matrix.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the matrix is not copied to memory, but the filter is read-only and
+     accesses the memory map of the file, so that queries can start
+     immediately */
+  [[nodiscard]] static InterleavedBloomFilter2 load(
+                                                   const std::string &filename,
+                                                   bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::interleaved_bloom_filter2);
+    const BloomFilterFileHeader &header = file->header_get();
+    const size_t words_per_row = std::max(size_t(1), (header.bins + 63) / 64);
+    return InterleavedBloomFilter2(header.bins, header.num_bits,
+                                   header.num_hash_functions,
+                                   header.qgram_length,
+                                   BloomFilterWords<uint64_t>(
+                                     file, 0, header.num_bits * words_per_row,
+                                     not memory_map));
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return matrix.is_mapped();
   }
 };
 
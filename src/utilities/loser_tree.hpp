@@ -0,0 +1,128 @@
+#ifndef LOSER_TREE_HPP
+#define LOSER_TREE_HPP
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/* A loser tree (tournament tree) for merging num_sequences sorted
+   sequences of keys. Each internal node stores the index of the sequence
+   which lost the comparison at this node, the root additionally stores
+   the overall winner, i.e. the sequence with the smallest current key.
+   After the key of the winner was replaced by the next key of its
+   sequence (or the sequence was exhausted), only the path from the leaf
+   of the winner to the root is replayed, which requires
+   log_2(num_sequences) comparisons. Equal keys are delivered in the
+   order of the sequence indexes. */
+
+template<typename KeyType>
+class GttlLoserTree
+{
+  size_t num_sequences, num_leaves;
+  std::vector<size_t> tree; /* tree[0] is the winner */
+  std::vector<KeyType> keys;
+  std::vector<bool> active;
+
+  [[nodiscard]] bool beats(size_t a, size_t b) const noexcept
+  {
+    if (a >= num_sequences or not active[a])
+    {
+      return false;
+    }
+    if (b >= num_sequences or not active[b])
+    {
+      return true;
+    }
+    return keys[a] < keys[b] or (keys[a] == keys[b] and a < b);
+  }
+
+  size_t build(size_t node)
+  {
+    if (node >= num_leaves)
+    {
+      return node - num_leaves;
+    }
+    const size_t left_winner = build(2 * node);
+    const size_t right_winner = build(2 * node + 1);
+    if (beats(left_winner, right_winner))
+    {
+      tree[node] = right_winner;
+      return left_winner;
+    }
+    tree[node] = left_winner;
+    return right_winner;
+  }
+
+  void replay(void) noexcept
+  {
+    size_t winner = tree[0];
+    for (size_t node = (winner + num_leaves)/2; node > 0; node /= 2)
+    {
+      if (beats(tree[node], winner))
+      {
+        std::swap(tree[node], winner);
+      }
+    }
+    tree[0] = winner;
+  }
+
+  public:
+  explicit GttlLoserTree(size_t _num_sequences)
+    : num_sequences(_num_sequences)
+    , num_leaves(std::bit_ceil(std::max(_num_sequences, size_t(2))))
+    , tree(num_leaves, 0)
+    , keys(_num_sequences)
+    , active(_num_sequences, false)
+  {}
+
+  /* sets the first key of sequence seqnum; all sequences for which this
+     is not called before calling init are considered to be empty */
+  void key_set(size_t seqnum, KeyType key) noexcept
+  {
+    assert(seqnum < num_sequences);
+    keys[seqnum] = key;
+    active[seqnum] = true;
+  }
+
+  void init(void)
+  {
+    tree[0] = build(1);
+  }
+
+  [[nodiscard]] bool empty(void) const noexcept
+  {
+    return tree[0] >= num_sequences or not active[tree[0]];
+  }
+
+  [[nodiscard]] size_t winner_get(void) const noexcept
+  {
+    assert(not empty());
+    return tree[0];
+  }
+
+  [[nodiscard]] KeyType winner_key_get(void) const noexcept
+  {
+    assert(not empty());
+    return keys[tree[0]];
+  }
+
+  /* the sequence of the winner delivers its next key */
+  void winner_replace(KeyType key) noexcept
+  {
+    assert(not empty());
+    keys[tree[0]] = key;
+    replay();
+  }
+
+  /* the sequence of the winner is exhausted */
+  void winner_remove(void) noexcept
+  {
+    assert(not empty());
+    active[tree[0]] = false;
+    replay();
+  }
+};
+#endif
@@ -142,8 +142,11 @@ static void lsb_radix_sort(uint8_t *array,
                            int remaining_bits,
                            bool reversed_byte_order)
 {
-  const int last_byte_index = remaining_bits / CHAR_BIT +
-                              ((remaining_bits % CHAR_BIT) != 0 ? 1 : 0);
+  /* the index of the last byte containing one of the sort bits, counted
+     from the first byte of the unit, i.e. including the bytes already
+     sorted */
+  const int last_byte_index
+    = (bits_already_sorted + remaining_bits + CHAR_BIT - 1)/CHAR_BIT - 1;
   const SinglePassSorter<uint8_t> func = lsb_radix_sort_single_pass<
                                uint8_t,
                                first_pass_msb_bits,
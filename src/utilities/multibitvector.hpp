@@ -44,6 +44,15 @@ class Multibitvector
     }
     multibitvector[idx >> bitvector_log].set(idx & bitvector_mask);
   }
+  /* sets a bit such that several threads can set bits at the same time,
+     see Bitvector::set_concurrently */
+  void set_concurrently(size_t idx) noexcept
+  {
+    static_assert(not track_count);
+    assert(idx < num_bits);
+    multibitvector[idx >> bitvector_log].set_concurrently(idx
+                                                          & bitvector_mask);
+  }
   void reset(size_t idx) noexcept
   {
     assert(idx < num_bits);
@@ -98,6 +107,18 @@ class Multibitvector
   {
     return !(*this == rhs);
   }
+  /* the same as count, but bits may be set by set_concurrently at the
+     same time */
+  [[nodiscard]] size_t count_concurrently(void) const noexcept
+  {
+    static_assert(not track_count);
+    size_t this_count = 0;
+    for (size_t idx = 0; idx < num_bitvectors; idx++)
+    {
+      this_count += multibitvector[idx].count_concurrently();
+    }
+    return this_count;
+  }
   [[nodiscard]] size_t count(void) const noexcept
   {
     if constexpr (track_count)
@@ -9,6 +9,14 @@
 #include <stdexcept>
 #include <vector>
 #include <limits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#else
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#endif
+#include "threading/thread_pool_var.hpp"
 
 class NtTableResult
 {
@@ -64,6 +72,110 @@ class NtTable
          sequences_number;
   std::vector<CountType> table;
 
+  /* adds the len counts in src to the counts in dest, saturating at
+     CountTypeMax */
+  static void counts_saturating_add(CountType *dest, const CountType *src,
+                                    size_t len) noexcept
+  {
+    static_assert(sizeof(CountType) == 2);
+    size_t idx = 0;
+#ifdef __AVX2__
+    for (/* Nothing */; idx + 16 <= len; idx += 16)
+    {
+      const __m256i dest_vec
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dest + idx));
+      const __m256i src_vec
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + idx));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + idx),
+                          _mm256_adds_epu16(dest_vec, src_vec));
+    }
+#else
+#ifdef __SSE2__
+    for (/* Nothing */; idx + 8 <= len; idx += 8)
+    {
+      const __m128i dest_vec
+        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dest + idx));
+      const __m128i src_vec
+        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + idx));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + idx),
+                       _mm_adds_epu16(dest_vec, src_vec));
+    }
+#else
+#ifdef __ARM_NEON
+    for (/* Nothing */; idx + 8 <= len; idx += 8)
+    {
+      vst1q_u16(dest + idx, vqaddq_u16(vld1q_u16(dest + idx),
+                                       vld1q_u16(src + idx)));
+    }
+#endif
+#endif
+#endif
+    for (/* Nothing */; idx < len; idx++)
+    {
+      if (dest[idx] < CountTypeMax - src[idx])
+      {
+        dest[idx] += src[idx];
+      } else // overflow
+      {
+        dest[idx] = CountTypeMax;
+      }
+    }
+  }
+
+  /* splits the index space of the table into slices and calls
+     process_slice(thd, from, to) for each slice [from,to), using
+     num_threads threads */
+  template<class SliceProcessor>
+  void slices_process(size_t num_threads, SliceProcessor process_slice) const
+  {
+    /* the slices cover whole cache lines */
+    static constexpr const size_t slice_alignment = 64/sizeof(CountType);
+    const size_t num_slices = num_threads <= 1 ? 1 : 4 * num_threads;
+    const size_t slice_size
+      = std::max(slice_alignment,
+                 ((table.size() + num_slices - 1)/num_slices
+                  + slice_alignment - 1)/slice_alignment * slice_alignment);
+    const size_t num_tasks = (table.size() + slice_size - 1)/slice_size;
+    gttl_thread_pool_var(std::max(size_t(1),std::min(num_threads,num_tasks)),
+                         num_tasks,
+                         [&process_slice, slice_size, this]
+                         (size_t thd, size_t task_num)
+                         {
+                           const size_t from = task_num * slice_size;
+                           process_slice(thd, from,
+                                         std::min(from + slice_size,
+                                                  table.size()));
+                         });
+  }
+
+  /* element t is the number of counters with value t */
+  [[nodiscard]] std::vector<size_t> counts_distribution(size_t num_threads)
+                                                         const
+  {
+    std::vector<std::vector<size_t>> thread_distributions
+      (std::max(size_t(1),num_threads),
+       std::vector<size_t>(CountTypeMax + 1, 0));
+    slices_process(num_threads,
+                   [&thread_distributions,this]
+                   (size_t thd, size_t from, size_t to)
+                   {
+                     std::vector<size_t> &distribution
+                       = thread_distributions[thd];
+                     for (size_t idx = from; idx < to; idx++)
+                     {
+                       distribution[table[idx]]++;
+                     }
+                   });
+    for (size_t thd = 1; thd < thread_distributions.size(); thd++)
+    {
+      for (size_t t = 0; t <= CountTypeMax; t++)
+      {
+        thread_distributions[0][t] += thread_distributions[thd][t];
+      }
+    }
+    return thread_distributions[0];
+  }
+
  public:
   NtTable(size_t _s, size_t _r)
     : s_value(_s)
@@ -89,29 +201,50 @@ class NtTable
   {
     assert(s_value == other.s_value and r_value == other.r_value and
            table.size() == other.table.size());
+    counts_saturating_add(table.data(), other.table.data(), table.size());
+    qgram_count += other.qgram_count;
+    sequences_number += other.sequences_number;
+  }
 
-    for (size_t idx = 0; idx < table.size(); idx++)
+  /* merges all other tables into this table. Each of the num_threads
+     threads adds the counters of all other tables in a slice of the
+     index space, so that no synchronization is required */
+  void merge(const std::vector<const NtTable *> &others, size_t num_threads)
+  {
+    slices_process(num_threads,
+                   [&others,this](size_t, size_t from, size_t to)
+                   {
+                     for (auto other : others)
+                     {
+                       assert(s_value == other->s_value and
+                              r_value == other->r_value and
+                              table.size() == other->table.size());
+                       counts_saturating_add(table.data() + from,
+                                             other->table.data() + from,
+                                             to - from);
+                     }
+                   });
+    for (auto other : others)
     {
-      if (table[idx] < CountTypeMax - other.table[idx])
-      {
-        table[idx] += other.table[idx];
-      } else // overflow
-      {
-        table[idx] = CountTypeMax;
-      }
+      qgram_count += other->qgram_count;
+      sequences_number += other->sequences_number;
     }
-    qgram_count += other.qgram_count;
-    sequences_number += other.sequences_number;
   }
-  [[nodiscard]] double estimate_F0(void) const
+  [[nodiscard]] double estimate_F0(size_t num_threads = 1) const
   {
+    std::vector<size_t> thread_p0(std::max(size_t(1),num_threads), 0);
+    slices_process(num_threads,
+                   [&thread_p0,this](size_t thd, size_t from, size_t to)
+                   {
+                     thread_p0[thd] += static_cast<size_t>(
+                                         std::count(table.begin() + from,
+                                                    table.begin() + to,
+                                                    CountType(0)));
+                   });
     size_t p0 = 0;
-    for (auto t : table)
+    for (auto this_p0 : thread_p0)
     {
-      if (t == 0)
-      {
-        p0++;
-      }
+      p0 += this_p0;
     }
 
     if (p0 == 0)
@@ -122,20 +255,17 @@ class NtTable
            (uint64_t(1) << (s_value + r_value));
   }
 
-  [[nodiscard]] NtTableResult estimate_all(void) const
+  /* the distribution of the counters is determined with num_threads
+     threads, the following recurrence for the f_n-values is sequential */
+  [[nodiscard]] NtTableResult estimate_all(size_t num_threads = 1) const
   {
-    size_t t_max = 0;
-    if (not table.empty())
-    {
-      t_max = std::ranges::max(table);
-    }
-
-    std::vector<size_t> p(t_max + 1, 0);
-    for (auto t : table)
+    std::vector<size_t> p = counts_distribution(num_threads);
+    size_t t_max = CountTypeMax;
+    while (t_max > 0 and p[t_max] == 0)
     {
-      assert(t <= t_max);
-      p[t]++;
+      t_max--;
     }
+    p.resize(t_max + 1);
 
     if (p[0] == 0)
     {
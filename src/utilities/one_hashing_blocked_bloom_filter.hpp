@@ -6,10 +6,14 @@
 #define ONE_HASHING_BLOCKED_BLOOM_FILTER_HPP
 
 #include "utilities/bitvector.hpp"
+#include "utilities/bloom_filter_file.hpp"
 #include "utilities/bloom_filter_hash_function.hpp"
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 constexpr size_t OneHashingBlockedBloomFilterBlockSize = 512;
@@ -63,11 +67,15 @@ class OneHashingBlockedBloomFilter
       return true;
     }
   };
-  std::vector<Block> blocks;
+  BloomFilterWords<Block> blocks;
+
+  explicit OneHashingBlockedBloomFilter(BloomFilterWords<Block> &&_blocks)
+    : blocks(std::move(_blocks))
+  { }
 
  public:
   explicit OneHashingBlockedBloomFilter(uint64_t num_blocks)
-    : blocks(std::vector<Block>(num_blocks))
+    : blocks(BloomFilterWords<Block>(num_blocks))
   { }
 
   bool insert(uint64_t value)
@@ -89,6 +97,39 @@ class OneHashingBlockedBloomFilter
   {
     return 1;
   }
+
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::
+                              one_hashing_blocked_bloom_filter,
+                            blocks.size() *
+                              OneHashingBlockedBloomFilterBlockSize,
+                            num_hash_functions_get(), 1, 0,
+                            {blocks.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the blocks are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static OneHashingBlockedBloomFilter load(
+                                                   const std::string &filename,
+                                                   bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::one_hashing_blocked_bloom_filter);
+    const size_t num_blocks
+      = file->header_get().num_bits / OneHashingBlockedBloomFilterBlockSize;
+    return OneHashingBlockedBloomFilter(BloomFilterWords<Block>(
+                                          file, 0, num_blocks,
+                                          not memory_map));
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return blocks.is_mapped();
+  }
 };
 
 #endif // ONE_HASHING_BLOCKED_BLOOM_FILTER_HPP
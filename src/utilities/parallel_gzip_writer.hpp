@@ -0,0 +1,202 @@
+#ifndef PARALLEL_GZIP_WRITER_HPP
+#define PARALLEL_GZIP_WRITER_HPP
+
+#include <zlib.h>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <ios>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "threading/thread_pool_unknown_tasks.hpp"
+
+/*
+** Compress the given input into one complete gzip member, i.e. a gzip
+** header, a raw deflate stream and the gzip trailer. As a gzip file may
+** consist of several members, which are decompressed one after the other,
+** the concatenation of the results of this function for consecutive blocks
+** of some content is a valid gzip file of the content.
+*/
+static inline std::string gttl_gzip_member(std::string_view input,
+                                           size_t compression_level)
+{
+  assert(compression_level >= 1 && compression_level <= 9);
+  assert(input.size() <= static_cast<size_t>(UINT_MAX));
+  z_stream strm{};
+  /* 15 is the default window size, adding 16 selects the gzip wrapper */
+  if (deflateInit2(&strm, static_cast<int>(compression_level), Z_DEFLATED,
+                   15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    throw std::runtime_error(": cannot initialize zlib deflate stream");
+  }
+  std::string output(deflateBound(&strm, static_cast<uLong>(input.size())),
+                     '\0');
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-const-cast,
+  //             cppcoreguidelines-pro-type-reinterpret-cast)
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  strm.avail_in = static_cast<uInt>(input.size());
+  strm.next_out = reinterpret_cast<Bytef *>(output.data());
+  // NOLINTEND(cppcoreguidelines-pro-type-const-cast,
+  //           cppcoreguidelines-pro-type-reinterpret-cast)
+  strm.avail_out = static_cast<uInt>(output.size());
+  const int ret = deflate(&strm, Z_FINISH);
+  deflateEnd(&strm);
+  if (ret != Z_STREAM_END)
+  {
+    throw std::runtime_error(": zlib deflate did not complete gzip member");
+  }
+  output.resize(strm.total_out);
+  return output;
+}
+
+/*
+** A pigz-style writer for (GZip) compressed or uncompressed output files.
+** Each content handed over by write() is split into blocks of
+** block_size bytes. Each block is compressed independently into a gzip
+** member by one of the threads of the pool, so that several blocks of the
+** same file as well as blocks of different files are compressed
+** concurrently. The thread finishing the last block of a file writes all
+** members of this file in their original order. The content is moved into
+** the writer, so no copy of it is made.
+** compression_level=0 will result in uncompressed output, .gz file
+** extensions will be automatically added where appropriate, as done in
+** write_to_output_file. For num_threads=1 everything is done by the
+** calling thread. All files are completely written when the destructor
+** returns.
+*/
+class GttlParallelGzipWriter
+{
+  struct OutputFileState
+  {
+    std::string file_name;
+    std::string content;
+    std::vector<std::string> members;
+    std::atomic<size_t> remaining_blocks;
+    OutputFileState(std::string &&_file_name, std::string &&_content,
+                    size_t num_blocks)
+      : file_name(std::move(_file_name))
+      , content(std::move(_content))
+      , members(num_blocks)
+      , remaining_blocks(num_blocks)
+    {}
+  };
+
+  size_t compression_level;
+  size_t num_threads;
+  size_t block_size;
+  ThreadPoolUnknownTasks tp;
+
+  static void write_members(const OutputFileState &state)
+  {
+    FILE *const f_out = std::fopen(state.file_name.c_str(), "wb");
+    if (f_out == nullptr)
+    {
+      throw std::system_error(errno,
+                              std::iostream_category(),
+                              ": Error writing to file: " + state.file_name);
+    }
+    for (const auto &member : state.members)
+    {
+      if (std::fwrite(member.data(), 1, member.size(), f_out)
+          != member.size())
+      {
+        fclose(f_out);
+        throw std::ios_base::failure(": Error writing to file: "
+                                     + state.file_name);
+      }
+    }
+    fclose(f_out);
+  }
+
+  void compress_block(const std::shared_ptr<OutputFileState> &state,
+                      size_t block_num) const
+  {
+    const size_t start = block_num * block_size;
+    const std::string_view block
+      = std::string_view(state->content).substr(start, block_size);
+    state->members[block_num] = gttl_gzip_member(block, compression_level);
+    if (state->remaining_blocks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      state->content.clear();
+      state->content.shrink_to_fit();
+      write_members(*state);
+    }
+  }
+
+  public:
+  static constexpr const size_t default_block_size = size_t(1) << 20;
+
+  GttlParallelGzipWriter(size_t _compression_level,
+                         size_t _num_threads,
+                         size_t _block_size = default_block_size)
+    : compression_level(_compression_level)
+    , num_threads(_num_threads)
+    , block_size(_block_size)
+    , tp(_num_threads > 1 ? _num_threads : 0)
+  {
+    if (compression_level > 9)
+    {
+      throw std::ios_base::failure(
+        ": GZip compression level can not be greater than 9!");
+    }
+    if (block_size == 0 or block_size > static_cast<size_t>(UINT_MAX))
+    {
+      throw std::invalid_argument(
+        ": GZip block size must be positive and at most "
+        + std::to_string(UINT_MAX));
+    }
+    assert(num_threads >= 1);
+  }
+
+  void write(std::string &&file_name, std::string &&content)
+  {
+    if (compression_level == 0)
+    {
+      auto state = std::make_shared<OutputFileState>(std::move(file_name),
+                                                     std::string{},
+                                                     size_t(1));
+      state->members[0] = std::move(content);
+      if (num_threads == 1)
+      {
+        write_members(*state);
+      } else
+      {
+        tp.enqueue([state] { write_members(*state); });
+      }
+      return;
+    }
+    file_name += ".gz";
+    const size_t num_blocks = content.empty()
+                                ? size_t(1)
+                                : (content.size() + block_size - 1)
+                                  / block_size;
+    auto state = std::make_shared<OutputFileState>(std::move(file_name),
+                                                   std::move(content),
+                                                   num_blocks);
+    for (size_t block_num = 0; block_num < num_blocks; block_num++)
+    {
+      if (num_threads == 1)
+      {
+        compress_block(state, block_num);
+      } else
+      {
+        tp.enqueue([this, state, block_num]
+                   { compress_block(state, block_num); });
+      }
+    }
+  }
+
+  [[nodiscard]] size_t size_of_queue(void) const
+  {
+    return tp.size_of_queue();
+  }
+};
+#endif // PARALLEL_GZIP_WRITER_HPP
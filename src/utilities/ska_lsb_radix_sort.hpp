@@ -11,15 +11,14 @@
 #include <string>
 #include <vector>
 #include <tuple>
-#include <thread>
+#include <array>
 #ifndef NDEBUG
 #include <iostream>
 #endif
 #include "utilities/constexpr_for.hpp"
 #include "utilities/buckets.hpp"
 #include "utilities/lsb_radix_sort.hpp"
-#include "utilities/span.hpp"
-#include "utilities/runtime_class.hpp"
+#include "threading/thread_pool_var.hpp"
 
 #ifndef RADIX_SORT8_MAX_SIZEOF_UNIT
 #define RADIX_SORT8_MAX_SIZEOF_UNIT 32
@@ -391,6 +390,186 @@ static const Buckets<Counttype> *radixsort_ska_then_other_generic(
   return buckets;
 }
 
+class PartInfoTab
+{
+  private:
+  std::vector<size_t> end_indexes;
+  public:
+  PartInfoTab(size_t num_elements,size_t num_parts)
+  {
+    if (num_parts > num_elements)
+    {
+      end_indexes.push_back(num_elements);
+    } else
+    {
+      const size_t avg_width = (num_elements + num_parts - 1)/num_parts;
+      for (size_t p = 0; p < num_parts; p++)
+      {
+        end_indexes.push_back(std::min((p+1) * avg_width,num_elements));
+      }
+    }
+  }
+  [[nodiscard]] size_t size(void) const noexcept { return end_indexes.size(); }
+  std::pair<size_t,size_t> operator [](size_t idx) const noexcept
+  {
+    return std::make_pair(idx == 0 ? 0 : end_indexes[idx-1],
+                          idx == 0 ? end_indexes[0]
+                                   : (end_indexes[idx] - end_indexes[idx-1]));
+  }
+};
+
+/* The following functions implement a parallel counting sort of the
+   units by one byte: the array is split into num_threads parts, for each
+   of which a thread counts the keys. From the counts of all parts, the
+   first position of the units of each part in each bucket is computed,
+   so that the threads independently distribute the units of their part
+   to a buffer. Finally the buffer is copied back to the array. */
+
+template<class PartFunc>
+static void run_for_each_part(const PartInfoTab &part_info_tab,
+                              PartFunc &&part_func)
+{
+  gttl_thread_pool_var(part_info_tab.size(),
+                       part_info_tab.size(),
+                       [&](size_t,size_t part_num)
+  {
+    size_t left;
+    size_t width;
+    std::tie(left,width) = part_info_tab[part_num];
+    part_func(part_num,left,width);
+  });
+}
+
+template <typename Counttype,
+          typename basetype,
+          int sizeof_unit,
+          uint64_t (*functor)(int,const basetype *,size_t idx)>
+static Buckets<Counttype> *countingsort_parallel(basetype *array,
+                                                 basetype *buffer,
+                                                 size_t num_units,
+                                                 int key_arg,
+                                                 size_t num_threads)
+{
+  constexpr const size_t num_buckets = size_t(1) << first_pass_msb_bits;
+  using Histogram = std::array<Counttype,num_buckets>;
+  const PartInfoTab part_info_tab(num_units,num_threads);
+  std::vector<Histogram> histograms(part_info_tab.size());
+  run_for_each_part(part_info_tab,[&](size_t part_num,size_t left,
+                                      size_t width)
+  {
+    Histogram &histogram = histograms[part_num];
+    histogram.fill(0);
+    for (size_t idx = left; idx < left + width; idx++)
+    {
+      histogram[functor(key_arg,array,idx)]++;
+    }
+  });
+  size_t count_zero = 0;
+  for (size_t bucket = 0; bucket < num_buckets; bucket++)
+  {
+    bool is_empty = true;
+    for (const auto &histogram : histograms)
+    {
+      if (histogram[bucket] > 0)
+      {
+        is_empty = false;
+        break;
+      }
+    }
+    count_zero += is_empty;
+  }
+  if (count_zero == num_buckets - 1) /* all but one bucket is empty */
+  {
+    return nullptr;
+  }
+  /* transform the counts into the first positions of the units of each
+     part in each bucket */
+  Buckets<Counttype> *buckets = new Buckets<Counttype>(num_buckets);
+  Counttype total = 0;
+  for (size_t bucket = 0; bucket < num_buckets; bucket++)
+  {
+    for (auto &histogram : histograms)
+    {
+      const Counttype count = histogram[bucket];
+      histogram[bucket] = total;
+      total += count;
+    }
+    buckets->set(bucket,total);
+  }
+  assert(static_cast<size_t>(total) == num_units);
+  run_for_each_part(part_info_tab,[&](size_t part_num,size_t left,
+                                      size_t width)
+  {
+    Histogram &offsets = histograms[part_num];
+    for (size_t idx = left; idx < left + width; idx++)
+    {
+      const Counttype offset = offsets[functor(key_arg,array,idx)]++;
+      if constexpr (sizeof_unit == 1)
+      {
+        buffer[offset] = array[idx];
+      } else
+      {
+        memcpy(buffer + sizeof_unit * offset,array + sizeof_unit * idx,
+               sizeof_unit);
+      }
+    }
+  });
+  run_for_each_part(part_info_tab,[&](size_t,size_t left,size_t width)
+  {
+    memcpy(array + sizeof_unit * left,buffer + sizeof_unit * left,
+           sizeof(basetype) * sizeof_unit * width);
+  });
+  return buckets;
+}
+
+/* Applies countingsort_parallel to the bytes beginning with the one at
+   byte_index, until a byte is found for which not all units fall into
+   the same bucket. Returns the buckets and the index of this byte.
+   If all units have the same bytes up to byte_end, nullptr is returned.
+   For sizeof_unit == 1, the bytes are those of the uint64_t values,
+   beginning with the most significant one. buffer must have space for
+   num_units units; its content is undefined afterwards. */
+template<typename Counttype,typename basetype,int sizeof_unit>
+static std::pair<Buckets<Counttype> *,int> msd_countingsort_parallel(
+                                              basetype *array,
+                                              basetype *buffer,
+                                              size_t num_units,
+                                              int byte_index,
+                                              int byte_end,
+                                              [[maybe_unused]]
+                                              bool reversed_byte_order,
+                                              size_t num_threads)
+{
+  Buckets<Counttype> *buckets = nullptr;
+  for (/* Nothing */; byte_index < byte_end; byte_index++)
+  {
+    if constexpr (sizeof_unit == 1)
+    {
+      static_assert(sizeof(basetype) == 8);
+      buckets = countingsort_parallel<Counttype,basetype,1,
+                                      radix_key_uint64<first_pass_msb_bits>>
+                                     (array,buffer,num_units,
+                                      64 - first_pass_msb_bits *
+                                           (byte_index + 1),
+                                      num_threads);
+    } else
+    {
+      static_assert(sizeof(basetype) == 1);
+      buckets = countingsort_parallel<Counttype,basetype,sizeof_unit,
+                                      radix_key_uint8<sizeof_unit>>
+                                     (array,buffer,num_units,
+                                      real_byte_index(reversed_byte_order,
+                                                      byte_index),
+                                      num_threads);
+    }
+    if (buckets != nullptr)
+    {
+      break;
+    }
+  }
+  return {buckets,byte_index};
+}
+
 class LSBuint64Sorter
 {
   private:
@@ -466,17 +645,67 @@ class LSBbytesSorter
   }
 };
 
+/* For num_threads > 1 the first pass distributing the values into
+   buckets is performed by countingsort_parallel and the buckets are
+   then sorted by the threads independently. As the buckets are disjoint,
+   the buffer of countingsort_parallel is also used by the threads for
+   sorting the buckets, so that the sort requires array_len additional
+   uint64_t values. */
 template<typename Counttype>
 static const Buckets<Counttype> *ska_lsb_radix_sort(int num_sort_bits,
                                               uint64_t *array,
-                                              size_t array_len)
+                                              size_t array_len,
+                                              size_t num_threads = 1)
 {
-  LSBuint64Sorter lsb_uint64_sorter(num_sort_bits);
-  return radixsort_ska_then_other_generic<Counttype,uint64_t,1,LSBuint64Sorter>
-                                          (&lsb_uint64_sorter,
-                                           num_sort_bits,
-                                           array,
-                                           array_len);
+  if (num_threads == 1)
+  {
+    LSBuint64Sorter lsb_uint64_sorter(num_sort_bits);
+    return radixsort_ska_then_other_generic<Counttype,uint64_t,1,
+                                            LSBuint64Sorter>
+                                           (&lsb_uint64_sorter,
+                                            num_sort_bits,
+                                            array,
+                                            array_len);
+  }
+  if (array_len < 2)
+  {
+    return nullptr;
+  }
+  const int num_sort_bytes = (num_sort_bits + CHAR_BIT - 1)/CHAR_BIT;
+  uint64_t *const buffer = new uint64_t [array_len];
+  Buckets<Counttype> *buckets;
+  int byte_index;
+  std::tie(buckets,byte_index)
+    = msd_countingsort_parallel<Counttype,uint64_t,1>(array,
+                                                      buffer,
+                                                      array_len,
+                                                      0,
+                                                      num_sort_bytes,
+                                                      false,
+                                                      num_threads);
+  const int bits_already_sorted = CHAR_BIT * (byte_index + 1);
+  if (buckets != nullptr && bits_already_sorted < num_sort_bits)
+  {
+    gttl_thread_pool_var(num_threads,
+                         buckets->size(),
+                         [&](size_t,size_t bucket_num)
+    {
+      const Counttype bucket_start
+        = bucket_num == 0 ? 0 : buckets->reference()[bucket_num - 1];
+      const Counttype bucket_width
+        = buckets->reference()[bucket_num] - bucket_start;
+      if (bucket_width > 1)
+      {
+        lsb_radix_sort(array + bucket_start,
+                       buffer + bucket_start,
+                       bucket_width,
+                       bits_already_sorted,
+                       num_sort_bits - bits_already_sorted);
+      }
+    });
+  }
+  delete[] buffer;
+  return buckets;
 }
 
 template<typename Counttype>
@@ -539,7 +768,8 @@ template<typename Counttype,typename basetype,int sizeof_unit,class SorterClass>
 static void ska_large_lsb_small_radix_sort_generic(SorterClass *sorter_instance,
                                                    int num_sort_bits,
                                                    basetype *array,
-                                                   size_t num_units)
+                                                   size_t num_units,
+                                                   int first_byte_index = 0)
 {
   if (num_units < 2)
   {
@@ -552,7 +782,7 @@ static void ska_large_lsb_small_radix_sort_generic(SorterClass *sorter_instance,
                                int byte_index;
                              };
 
-  std::vector<StackStruct> stack{{size_t(0), num_units, 0}};
+  std::vector<StackStruct> stack{{size_t(0), num_units, first_byte_index}};
   sorter_instance->setup(skarupke_threshold);
   while (not stack.empty())
   {
@@ -621,49 +851,122 @@ static void ska_large_lsb_small_radix_sort_generic(SorterClass *sorter_instance,
   }
 }
 
-class PartInfoTab
+/* The parallel version of ska_large_lsb_small_radix_sort_generic:
+   the units are distributed by countingsort_parallel. Buckets larger
+   than num_units/num_threads are sorted by a recursive call, i.e. again
+   with all threads. The other buckets are sorted independently by the
+   threads of a thread pool, each using
+   ska_large_lsb_small_radix_sort_generic with its own SorterClass
+   instance. The buffer for countingsort_parallel is allocated by the
+   outermost call and the recursive calls use the part of it
+   corresponding to their bucket. So the peak of the additional space
+   is num_units units for this buffer plus the buffers of the
+   SorterClass instances, which have space for one tenth of the units
+   of the small buckets sorted at the same time, i.e. for at most
+   num_units/10 units in total. */
+template<typename Counttype,typename basetype,int sizeof_unit,class SorterClass>
+static void ska_large_lsb_small_radix_sort_threaded(int num_sort_bits,
+                                                    bool reversed_byte_order,
+                                                    basetype *array,
+                                                    size_t num_units,
+                                                    int byte_index,
+                                                    size_t num_threads,
+                                                    basetype *buffer
+                                                      = nullptr)
 {
-  private:
-  std::vector<size_t> end_indexes;
-  public:
-  PartInfoTab(size_t num_elements,size_t num_parts)
+  if (num_units < 2)
   {
-    if (num_parts > num_elements)
+    return;
+  }
+  basetype *const this_buffer
+    = buffer == nullptr ? new basetype [sizeof_unit * num_units] : buffer;
+  const int num_sort_bytes = (num_sort_bits+CHAR_BIT-1)/CHAR_BIT;
+  Buckets<Counttype> *buckets;
+  std::tie(buckets,byte_index)
+    = msd_countingsort_parallel<Counttype,basetype,sizeof_unit>
+                               (array,
+                                this_buffer,
+                                num_units,
+                                byte_index,
+                                num_sort_bytes,
+                                reversed_byte_order,
+                                num_threads);
+  if (buckets == nullptr)
+  {
+    if (buffer == nullptr)
     {
-      end_indexes.push_back(num_elements);
-    } else
+      delete[] this_buffer;
+    }
+    return;
+  }
+  if (byte_index + 1 < num_sort_bytes)
+  {
+    const size_t large_bucket_width = num_units/num_threads;
+    std::vector<std::pair<Counttype,Counttype>> small_buckets{};
+    for (auto &&bck : *buckets)
     {
-      const size_t avg_width = (num_elements + num_parts - 1)/num_parts;
-      for (size_t p = 0; p < num_parts; p++)
+      const Counttype bucket_start = std::get<0>(bck);
+      const Counttype bucket_width = std::get<1>(bck) - bucket_start;
+      if (bucket_width > large_bucket_width)
       {
-        end_indexes.push_back(std::min((p+1) * avg_width,num_elements));
+        ska_large_lsb_small_radix_sort_threaded<Counttype,basetype,
+                                                sizeof_unit,SorterClass>
+                                               (num_sort_bits,
+                                                reversed_byte_order,
+                                                array +
+                                                  sizeof_unit * bucket_start,
+                                                bucket_width,
+                                                byte_index + 1,
+                                                num_threads,
+                                                this_buffer +
+                                                  sizeof_unit * bucket_start);
+      } else
+      {
+        if (bucket_width > 1)
+        {
+          small_buckets.emplace_back(bucket_start,bucket_width);
+        }
       }
     }
-  }
-  [[nodiscard]] size_t size(void) const noexcept { return end_indexes.size(); }
-  std::pair<size_t,size_t> operator [](size_t idx) const noexcept
-  {
-    return std::make_pair(idx == 0 ? 0 : end_indexes[idx-1],
-                          idx == 0 ? end_indexes[0]
-                                   : (end_indexes[idx] - end_indexes[idx-1]));
-  }
-};
-
-#ifndef NDEBUG
-template<class It>
-static inline void check_order(It begin, It end)
-{
-  auto previous = *begin;
-  for(auto it = begin + 1; it != end; ++it)
-  {
-    if (previous > *it)
+    if (not small_buckets.empty())
     {
-      assert(false);
+      gttl_thread_pool_var(num_threads,
+                           small_buckets.size(),
+                           [&](size_t,size_t task_num)
+      {
+        const Counttype bucket_start = std::get<0>(small_buckets[task_num]);
+        const Counttype bucket_width = std::get<1>(small_buckets[task_num]);
+        if constexpr (sizeof_unit == 1)
+        {
+          SorterClass sorter_instance(num_sort_bits);
+          ska_large_lsb_small_radix_sort_generic<Counttype,basetype,
+                                                 sizeof_unit,SorterClass>
+                                                (&sorter_instance,
+                                                 num_sort_bits,
+                                                 array + bucket_start,
+                                                 bucket_width,
+                                                 byte_index + 1);
+        } else
+        {
+          SorterClass sorter_instance(num_sort_bits,reversed_byte_order);
+          ska_large_lsb_small_radix_sort_generic<Counttype,basetype,
+                                                 sizeof_unit,SorterClass>
+                                                (&sorter_instance,
+                                                 num_sort_bits,
+                                                 array +
+                                                   sizeof_unit * bucket_start,
+                                                 bucket_width,
+                                                 byte_index + 1);
+        }
+      });
     }
-    previous = *it;
+  }
+  delete buckets;
+  if (buffer == nullptr)
+  {
+    delete[] this_buffer;
   }
 }
-#endif
 
 static inline void ska_large_lsb_small_radix_sort(int num_sort_bits,
                                                   uint64_t *array,
@@ -681,48 +984,14 @@ static inline void ska_large_lsb_small_radix_sort(int num_sort_bits,
                                            num_units);
   } else
   {
-    PartInfoTab part_info_tab(num_units,num_threads);
-    std::vector<std::thread> threads;
-    threads.reserve(part_info_tab.size());
-    for (size_t thd_num = 0; thd_num < part_info_tab.size(); thd_num++)
-    {
-      threads.emplace_back([&part_info_tab, array,
-                            num_sort_bits, thd_num]
-      {
-        size_t left;
-        size_t width;
-        std::tie(left,width) = part_info_tab[thd_num];
-        LSBuint64Sorter lsb_uint64_sorter(num_sort_bits);
-        ska_large_lsb_small_radix_sort_generic<Counttype,uint64_t,1,
-                                               LSBuint64Sorter>
-                                              (&lsb_uint64_sorter,
-                                               num_sort_bits,
-                                               array + left,
-                                               width);
-      });
-    }
-    for (auto &th : threads)
-    {
-      th.join();
-    }
-    RunTimeClass rt_multi_way_merge{};
-    Span<uint64_t> span(array,num_units);
-    for (size_t idx = 1; idx < part_info_tab.size(); idx++)
-    {
-      size_t left;
-      size_t width;
-      std::tie(left,width) = part_info_tab[idx];
-#ifndef NDEBUG
-      check_order(span.begin(),span.begin() + left);
-      check_order(span.begin() + left, span.begin() + left + width);
-#endif
-      std::inplace_merge(span.begin(),
-                         span.begin() + left,
-                         span.begin() + left + width);
-    }
-    rt_multi_way_merge.show(std::string("merging ") +
-                            std::to_string(part_info_tab.size()) +
-                            std::string(" sorted vectors"));
+    ska_large_lsb_small_radix_sort_threaded<Counttype,uint64_t,1,
+                                            LSBuint64Sorter>
+                                           (num_sort_bits,
+                                            false,
+                                            array,
+                                            num_units,
+                                            0,
+                                            num_threads);
   }
 }
 
@@ -730,7 +999,8 @@ static inline void ska_large_lsb_small_radix_sort(int sizeof_unit,
                                                   int num_sort_bits,
                                                   uint8_t *array,
                                                   size_t num_units,
-                                                  bool reversed_byte_order)
+                                                  bool reversed_byte_order,
+                                                  size_t num_threads = 1)
 {
   using Counttype = size_t;
   assert(sizeof_unit >= 2 and
@@ -740,14 +1010,30 @@ static inline void ska_large_lsb_small_radix_sort(int sizeof_unit,
   {
     if (sizeof_unit == const_expr_idx)
     {
-      LSBbytesSorter<const_expr_idx> lsb_bytes_sorter(num_sort_bits,
-                                                      reversed_byte_order);
-      ska_large_lsb_small_radix_sort_generic<Counttype,uint8_t,const_expr_idx,
-                                             LSBbytesSorter<const_expr_idx>>
-                                            (&lsb_bytes_sorter,
-                                             num_sort_bits,
-                                             array,
-                                             num_units);
+      if (num_threads == 1)
+      {
+        LSBbytesSorter<const_expr_idx> lsb_bytes_sorter(num_sort_bits,
+                                                        reversed_byte_order);
+        ska_large_lsb_small_radix_sort_generic<Counttype,uint8_t,
+                                               const_expr_idx,
+                                               LSBbytesSorter<const_expr_idx>>
+                                              (&lsb_bytes_sorter,
+                                               num_sort_bits,
+                                               array,
+                                               num_units);
+      } else
+      {
+        ska_large_lsb_small_radix_sort_threaded<Counttype,uint8_t,
+                                                const_expr_idx,
+                                                LSBbytesSorter
+                                                  <const_expr_idx>>
+                                               (num_sort_bits,
+                                                reversed_byte_order,
+                                                array,
+                                                num_units,
+                                                0,
+                                                num_threads);
+      }
     }
   });
 }
@@ -0,0 +1,82 @@
+#ifndef SORTED_INTERSECTION_HPP
+#define SORTED_INTERSECTION_HPP
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/* the number of values occurring in both of the sorted arrays a and b,
+   each of which must not contain a value twice */
+static inline size_t sorted_intersection_size_scalar(const uint64_t *a,
+                                                     size_t a_len,
+                                                     const uint64_t *b,
+                                                     size_t b_len)
+{
+  size_t i = 0, j = 0, count = 0;
+  while (i < a_len and j < b_len)
+  {
+    if (a[i] < b[j])
+    {
+      i++;
+    } else
+    {
+      if (a[i] > b[j])
+      {
+        j++;
+      } else
+      {
+        count++;
+        i++;
+        j++;
+      }
+    }
+  }
+  return count;
+}
+
+/* as before, but with AVX2 each block of four values of a is compared to
+   a block of four values of b by comparing it to the four rotations of
+   the block of b. Then the block with the smaller maximum is replaced by
+   the next block of its array, or both, if the maxima are equal. */
+static inline size_t sorted_intersection_size(const uint64_t *a,
+                                              size_t a_len,
+                                              const uint64_t *b,
+                                              size_t b_len)
+{
+  size_t i = 0, j = 0, count = 0;
+#ifdef __AVX2__
+  while (i + 4 <= a_len and j + 4 <= b_len)
+  {
+    const __m256i a_vec
+      = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    const __m256i b_vec
+      = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+    const __m256i cmp0 = _mm256_cmpeq_epi64(a_vec, b_vec);
+    const __m256i cmp1
+      = _mm256_cmpeq_epi64(a_vec, _mm256_permute4x64_epi64(b_vec, 0x39));
+    const __m256i cmp2
+      = _mm256_cmpeq_epi64(a_vec, _mm256_permute4x64_epi64(b_vec, 0x4E));
+    const __m256i cmp3
+      = _mm256_cmpeq_epi64(a_vec, _mm256_permute4x64_epi64(b_vec, 0x93));
+    const __m256i matches = _mm256_or_si256(_mm256_or_si256(cmp0, cmp1),
+                                            _mm256_or_si256(cmp2, cmp3));
+    count += static_cast<size_t>(std::popcount(static_cast<unsigned int>(
+               _mm256_movemask_pd(_mm256_castsi256_pd(matches)))));
+    const uint64_t a_max = a[i + 3];
+    const uint64_t b_max = b[j + 3];
+    if (a_max <= b_max)
+    {
+      i += 4;
+    }
+    if (b_max <= a_max)
+    {
+      j += 4;
+    }
+  }
+#endif
+  return count + sorted_intersection_size_scalar(a + i, a_len - i,
+                                                 b + j, b_len - j);
+}
+#endif
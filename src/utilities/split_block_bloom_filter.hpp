@@ -0,0 +1,291 @@
+#ifndef SPLIT_BLOCK_BLOOM_FILTER_HPP
+#define SPLIT_BLOCK_BLOOM_FILTER_HPP
+
+#include "utilities/bloom_filter_file.hpp"
+#include "utilities/gcc_builtin.hpp"
+#include "utilities/splitmix64.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/* A split block Bloom filter: each value selects a block of 256 bits,
+   which is split into 8 lanes of 32 bits, and sets one bit in each lane.
+   The 8 bit positions are derived from a single 32 bit hash value by
+   multiplying it with 8 odd constants and taking the upper 5 bits of each
+   product. With AVX2 this is done by one vector multiplication and shift,
+   and a value is inserted by one 256 bit OR or looked up by one 256 bit
+   test. If thread_safe is true, the filter can be filled by several
+   threads at the same time, using at most 4 atomic OR operations on the
+   64 bit words of a block. The batch versions of insert and contains
+   first compute the hash values of a chunk of values and prefetch their
+   blocks, before the blocks are accessed. */
+
+constexpr size_t SplitBlockBloomFilterBlockSize = 256;
+
+template <bool thread_safe>
+class SplitBlockBloomFilter
+{
+ private:
+  static constexpr const size_t words_per_block = 4;
+  static constexpr const size_t lanes_per_block = 8;
+  static constexpr const size_t chunk_size = 32;
+  alignas(32) static constexpr const uint32_t salt[lanes_per_block]
+    = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+       0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+  struct alignas(32) Block
+  {
+    uint64_t words[words_per_block];
+  };
+  static_assert(sizeof(Block) * 8 == SplitBlockBloomFilterBlockSize);
+  BloomFilterWords<Block> blocks;
+
+  [[nodiscard]] size_t block_index(uint64_t hash_value) const noexcept
+  {
+    return static_cast<size_t>(((hash_value >> 32) *
+                                static_cast<uint64_t>(blocks.size())) >> 32);
+  }
+
+  /* the bits to set in a block, lane idx is stored in the upper or lower
+     half of word idx/2 */
+  static void block_mask(uint64_t hash_value, uint64_t *mask) noexcept
+  {
+#ifdef __AVX2__
+    const __m256i products
+      = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(
+                                               static_cast<uint32_t>(
+                                                 hash_value))),
+                           _mm256_load_si256(reinterpret_cast<const __m256i *>
+                                               (salt)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask),
+                        _mm256_sllv_epi32(_mm256_set1_epi32(1),
+                                          _mm256_srli_epi32(products, 27)));
+#else
+    const uint32_t key = static_cast<uint32_t>(hash_value);
+    for (size_t idx = 0; idx < words_per_block; idx++)
+    {
+      mask[idx] = (uint64_t(1) << ((key * salt[2 * idx]) >> 27)) |
+                  (uint64_t(1) << (32 + ((key * salt[2 * idx + 1]) >> 27)));
+    }
+#endif
+  }
+
+  bool block_insert(Block *block, uint64_t hash_value)
+  {
+    alignas(32) uint64_t mask[words_per_block];
+    block_mask(hash_value, mask);
+    if constexpr (thread_safe)
+    {
+      bool contained = true;
+      for (size_t idx = 0; idx < words_per_block; idx++)
+      {
+        std::atomic_ref<uint64_t> word(block->words[idx]);
+        /* the atomic operation is only required if a bit is not set */
+        if ((word.load(std::memory_order_relaxed) & mask[idx]) != mask[idx])
+        {
+          contained &= ((word.fetch_or(mask[idx], std::memory_order_relaxed)
+                         & mask[idx]) == mask[idx]);
+        }
+      }
+      return contained;
+    } else
+    {
+#ifdef __AVX2__
+      __m256i *const block_ptr = reinterpret_cast<__m256i *>(block->words);
+      const __m256i mask_vec
+        = _mm256_load_si256(reinterpret_cast<const __m256i *>(mask));
+      const __m256i block_vec = _mm256_load_si256(block_ptr);
+      _mm256_store_si256(block_ptr, _mm256_or_si256(block_vec, mask_vec));
+      return _mm256_testc_si256(block_vec, mask_vec) != 0;
+#else
+      bool contained = true;
+      for (size_t idx = 0; idx < words_per_block; idx++)
+      {
+        contained &= ((block->words[idx] & mask[idx]) == mask[idx]);
+        block->words[idx] |= mask[idx];
+      }
+      return contained;
+#endif
+    }
+  }
+
+  [[nodiscard]] bool block_contains(const Block &block, uint64_t hash_value)
+                                    const
+  {
+    alignas(32) uint64_t mask[words_per_block];
+    block_mask(hash_value, mask);
+    if constexpr (thread_safe)
+    {
+      for (size_t idx = 0; idx < words_per_block; idx++)
+      {
+        const std::atomic_ref<uint64_t> word(const_cast<uint64_t &>
+                                               (block.words[idx]));
+        if ((word.load(std::memory_order_relaxed) & mask[idx]) != mask[idx])
+        {
+          return false;
+        }
+      }
+      return true;
+    } else
+    {
+#ifdef __AVX2__
+      const __m256i block_vec
+        = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.words));
+      return _mm256_testc_si256(block_vec,
+                                _mm256_load_si256(
+                                  reinterpret_cast<const __m256i *>(mask)))
+             != 0;
+#else
+      for (size_t idx = 0; idx < words_per_block; idx++)
+      {
+        if ((block.words[idx] & mask[idx]) != mask[idx])
+        {
+          return false;
+        }
+      }
+      return true;
+#endif
+    }
+  }
+
+  /* computes the hash values and block indexes of the values of a chunk
+     and prefetches the blocks */
+  void chunk_prepare(std::span<const uint64_t> chunk,
+                     std::array<uint64_t,chunk_size> *hash_values,
+                     std::array<size_t,chunk_size> *block_indexes) const
+  {
+    for (size_t idx = 0; idx < chunk.size(); idx++)
+    {
+      /* the lower 32 bits select the bits in the block and the upper
+         32 bits select the block */
+      (*hash_values)[idx] = gttl_splitmix64_finalize(chunk[idx]);
+      (*block_indexes)[idx] = block_index((*hash_values)[idx]);
+      GTTL_PREFETCH(&blocks[(*block_indexes)[idx]]);
+    }
+  }
+
+  explicit SplitBlockBloomFilter(BloomFilterWords<Block> &&_blocks)
+    : blocks(std::move(_blocks))
+  { }
+
+ public:
+  explicit SplitBlockBloomFilter(uint64_t num_blocks)
+    : blocks(BloomFilterWords<Block>(std::max(num_blocks, uint64_t(1))))
+  { }
+
+  // returns true if it is already inserted
+  bool insert(uint64_t value)
+  {
+    const uint64_t hash_value = gttl_splitmix64_finalize(value);
+    return block_insert(&blocks[block_index(hash_value)], hash_value);
+  }
+
+  [[nodiscard]] bool contains(uint64_t value) const
+  {
+    const uint64_t hash_value = gttl_splitmix64_finalize(value);
+    return block_contains(blocks[block_index(hash_value)], hash_value);
+  }
+
+  void insert(std::span<const uint64_t> values)
+  {
+    std::array<uint64_t,chunk_size> hash_values;
+    std::array<size_t,chunk_size> block_indexes;
+    for (size_t offset = 0; offset < values.size(); offset += chunk_size)
+    {
+      const std::span<const uint64_t> chunk
+        = values.subspan(offset, std::min(chunk_size,
+                                          values.size() - offset));
+      chunk_prepare(chunk, &hash_values, &block_indexes);
+      for (size_t idx = 0; idx < chunk.size(); idx++)
+      {
+        block_insert(&blocks[block_indexes[idx]], hash_values[idx]);
+      }
+    }
+  }
+
+  /* sets bit idx % 64 of out_bitmap[idx / 64] if values[idx] is
+     contained and clears it otherwise. out_bitmap must have space for
+     (values.size() + 63)/64 words. Returns the number of values
+     contained. */
+  size_t contains(std::span<const uint64_t> values, uint64_t *out_bitmap)
+                  const
+  {
+    static_assert(64 % chunk_size == 0);
+    std::array<uint64_t,chunk_size> hash_values;
+    std::array<size_t,chunk_size> block_indexes;
+    size_t count = 0;
+    for (size_t offset = 0; offset < values.size(); offset += chunk_size)
+    {
+      const std::span<const uint64_t> chunk
+        = values.subspan(offset, std::min(chunk_size,
+                                          values.size() - offset));
+      chunk_prepare(chunk, &hash_values, &block_indexes);
+      uint64_t bitmap_bits = 0;
+      for (size_t idx = 0; idx < chunk.size(); idx++)
+      {
+        const bool found = block_contains(blocks[block_indexes[idx]],
+                                          hash_values[idx]);
+        bitmap_bits |= static_cast<uint64_t>(found) << idx;
+        count += found;
+      }
+      const size_t shift = offset % 64;
+      if (shift == 0)
+      {
+        out_bitmap[offset / 64] = bitmap_bits;
+      } else
+      {
+        out_bitmap[offset / 64] |= bitmap_bits << shift;
+      }
+    }
+    return count;
+  }
+
+  [[nodiscard]] size_t size_in_bytes(void) const
+  {
+    return blocks.size() * sizeof(Block);
+  }
+
+  [[nodiscard]] size_t num_hash_functions_get(void) const
+  {
+    return lanes_per_block;
+  }
+
+  void serialize(const std::string &filename) const
+  {
+    bloom_filter_file_write(filename,
+                            BloomFilterFileType::split_block_bloom_filter,
+                            blocks.size() * SplitBlockBloomFilterBlockSize,
+                            lanes_per_block, 1, 0, {blocks.bytes()});
+  }
+
+  /* the filter stored in filename by serialize. If memory_map is true,
+     the blocks are not copied to memory, but the filter is read-only and
+     accesses the memory map of the file */
+  [[nodiscard]] static SplitBlockBloomFilter load(const std::string &filename,
+                                                  bool memory_map)
+  {
+    const auto file
+      = std::make_shared<const BloomFilterFile>(
+          filename, BloomFilterFileType::split_block_bloom_filter);
+    const size_t num_blocks
+      = file->header_get().num_bits / SplitBlockBloomFilterBlockSize;
+    return SplitBlockBloomFilter(BloomFilterWords<Block>(file, 0, num_blocks,
+                                                         not memory_map));
+  }
+
+  [[nodiscard]] bool is_memory_mapped(void) const noexcept
+  {
+    return blocks.is_mapped();
+  }
+};
+
+#endif // SPLIT_BLOCK_BLOOM_FILTER_HPP
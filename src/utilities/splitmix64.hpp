@@ -0,0 +1,15 @@
+#ifndef SPLITMIX64_HPP
+#define SPLITMIX64_HPP
+
+#include <cstdint>
+
+/* the finalizer of splitmix64, which maps keys which are not randomly
+   distributed, like integer codes or hash values with few varying bits,
+   to well distributed 64 bit values. It is a bijection. */
+static inline uint64_t gttl_splitmix64_finalize(uint64_t value) noexcept
+{
+  value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+  return value ^ (value >> 31);
+}
+#endif
@@ -9,9 +9,11 @@
 #include <cstdlib>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <cstdint>
 #include <vector>
-#include "utilities/split_string.hpp"
+#include "utilities/field_parser.hpp"
 #include "utilities/popen_reader.hpp"
 
 class DecompressedFile
@@ -84,22 +86,25 @@ class TarReader
       }
       line.push_back(static_cast<char>(cc));
     }
-    std::vector<std::string> line_vector = gttl_split_string(line, ' ');
-    if (line_vector.size() < 6)
+    /* line of tar -tv: permissions, owner, size, date, time, filename */
+    using TarLineParser = GttlFieldParser<' ',false,std::string_view,
+                                          std::string_view,size_t,
+                                          std::string_view,std::string_view,
+                                          std::string_view>;
+    TarLineParser::Tuple line_fields;
+    try
     {
-      throw std::ios_base::failure(
-            std::string("line \"") + line +
-            std::string("\" does not consist of exactly 6 columns"));
+      TarLineParser::parse(line, line_fields);
     }
-    if (std::sscanf(line_vector[2].data(), "%zu", &current_file_size) != 1)
+    catch (const std::runtime_error &err)
     {
       throw std::ios_base::failure(
-              std::string("cannot extract byte number from \"") +
-              line_vector[2] + std::string("\", line=\"") +
-              line + std::string("\""));
+            std::string("cannot parse line \"") + line +
+            std::string("\"") + err.what());
     }
+    current_file_size = std::get<2>(line_fields);
+    current_filename = std::string(std::get<5>(line_fields));
     line.clear();
-    current_filename = std::string(line_vector[5]);
     current_file_pos = 0;
     return true;
   }
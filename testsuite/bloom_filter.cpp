@@ -2,18 +2,23 @@
 ** Developed by Henning Lindemann
  */
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <random>
+#include <span>
 #include <thread>
 #include <unordered_set>
 #include <vector>
 #include "utilities/blocked_bloom_filter.hpp"
 #include "utilities/one_hashing_blocked_bloom_filter.hpp"
 #include "utilities/bloom_filter.hpp"
+#include "utilities/split_block_bloom_filter.hpp"
+#include "utilities/cuckoo_filter.hpp"
 #include "utilities/runtime_class.hpp"
 
 class StdSet
@@ -96,6 +101,52 @@ void benchmark(const char *name, AMD &amd, std::vector<uint64_t> &insert_data,
          amd.num_hash_functions_get());
 }
 
+/* the same as benchmark, but using the batch versions of insert and
+   contains */
+template <class AMD>
+void benchmark_batch(const char *name, AMD &amd,
+                     std::vector<uint64_t> &insert_data,
+                     std::vector<uint64_t> &test_data)
+{
+  std::vector<uint64_t> bitmap((std::max(insert_data.size(),
+                                         test_data.size()) + 63)/64);
+  RunTimeClass rt_insert{};
+  amd.insert(std::span<const uint64_t>(insert_data));
+  const size_t micro_insert = rt_insert.elapsed();
+
+  RunTimeClass rt_check_random{};
+  const size_t false_positives
+    = amd.contains(std::span<const uint64_t>(test_data), bitmap.data());
+  const size_t micro_check_random = rt_check_random.elapsed();
+
+  RunTimeClass rt_check_inserted{};
+  const size_t found_inserted
+    = amd.contains(std::span<const uint64_t>(insert_data), bitmap.data());
+  const size_t micro_check_inserted = rt_check_inserted.elapsed();
+  if (found_inserted != insert_data.size())
+  {
+    fprintf(stderr, "%s: only %zu of %zu inserted elements found\n",
+            name, found_inserted, insert_data.size());
+    exit(EXIT_FAILURE);
+  }
+  const float false_positive_percent =
+      100.0 * (float) false_positives / ((float) test_data.size());
+  const uint64_t size_in_bytes = amd.size_in_bytes();
+  const float bits_per_element = 8.0 * (float) size_in_bytes /
+                                      ((float) insert_data.size());
+  printf("%35s\t 1\t%7zu\t%7zu\t%7zu\t%10zu"
+         "\t%10.5f\t%11" PRIu64 "\t%7.2f\t%2zu\n",
+         name,
+         micro_insert / size_t(1000),
+         micro_check_random / size_t(1000),
+         micro_check_inserted / size_t(1000),
+         false_positives,
+         false_positive_percent,
+         size_in_bytes,
+         bits_per_element,
+         amd.num_hash_functions_get());
+}
+
 template <class AMD>
 void benchmark_threaded(const char *name, AMD &amd,
                         std::vector<uint64_t> &insert_data,
@@ -276,6 +327,26 @@ int main(int /*argc*/, char* /**argv*/[])
     benchmark("one hashing blocked bloom filter", amd, insert_data, test_data);
   }
 
+  for (auto m : multipliers)
+  {
+    SplitBlockBloomFilter<false> amd(
+        insert_data.size() * m / SplitBlockBloomFilterBlockSize);
+    benchmark("split block bloom filter", amd, insert_data, test_data);
+  }
+
+  for (auto m : multipliers)
+  {
+    SplitBlockBloomFilter<false> amd(
+        insert_data.size() * m / SplitBlockBloomFilterBlockSize);
+    benchmark_batch("batch split block bloom filter", amd, insert_data,
+                    test_data);
+  }
+
+  {
+    CuckooFilter<false> amd(insert_data.size());
+    benchmark("cuckoo filter", amd, insert_data, test_data);
+  }
+
   for (auto n : num_hash_functions)
   {
     for (auto m : multipliers)
@@ -323,4 +394,21 @@ int main(int /*argc*/, char* /**argv*/[])
                          insert_data, test_data, t);
     }
   }
+
+  for (auto m : multipliers)
+  {
+    for (auto t : threads)
+    {
+      SplitBlockBloomFilter<true> amd(
+          insert_data.size() * m / SplitBlockBloomFilterBlockSize);
+      benchmark_threaded("ts split block bloom filter", amd, insert_data,
+                         test_data, t);
+    }
+  }
+
+  for (auto t : threads)
+  {
+    CuckooFilter<true> amd(insert_data.size());
+    benchmark_threaded("ts cuckoo filter", amd, insert_data, test_data, t);
+  }
 }
@@ -0,0 +1,223 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include "utilities/runtime_class.hpp"
+#include "utilities/bloom_filter.hpp"
+#include "utilities/blocked_bloom_filter.hpp"
+#include "utilities/one_hashing_blocked_bloom_filter.hpp"
+#include "utilities/split_block_bloom_filter.hpp"
+#include "utilities/interleaved_bloom_filter.hpp"
+
+/* Each filter is filled with random values, written to a file, loaded
+   into memory and memory mapped. The loaded filters must give the same
+   answers as the original filter, for the inserted values and for other
+   random values. Inserting a value into a memory mapped filter must
+   throw an exception. */
+
+static std::vector<uint64_t> random_values(size_t size, uint64_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::vector<uint64_t> values(size);
+  for (auto &value : values)
+  {
+    value = rng();
+  }
+  return values;
+}
+
+/* the answer of a filter for value, which is a bin set for interleaved
+   Bloom filters */
+template<class Filter>
+static auto filter_answer(const Filter &filter, uint64_t value)
+{
+  return filter.contains(value);
+}
+
+template<>
+auto filter_answer(const InterleavedBloomFilter &filter, uint64_t value)
+{
+  /* contains is not const for this filter */
+  return const_cast<InterleavedBloomFilter &>(filter).contains(value);
+}
+
+template<class Filter,class Inserter>
+static void check_loaded(const std::string &name, const Filter &filter,
+                         const std::string &filename,
+                         const std::vector<uint64_t> &inserted,
+                         const std::vector<uint64_t> &others,
+                         Inserter inserter)
+{
+  RunTimeClass rt_serialize{};
+  filter.serialize(filename);
+  rt_serialize.show(std::format("serializing {}", name));
+  for (const bool memory_map : {false, true})
+  {
+    RunTimeClass rt_load{};
+    const Filter loaded = Filter::load(filename, memory_map);
+    rt_load.show(std::format("{} {}", memory_map ? "memory mapping"
+                                                 : "loading", name));
+    if (loaded.is_memory_mapped() != memory_map)
+    {
+      throw std::runtime_error(std::format(": {} is not {}", name,
+                                           memory_map ? "memory mapped"
+                                                      : "in memory"));
+    }
+    for (const auto *values : {&inserted, &others})
+    {
+      for (auto value : *values)
+      {
+        if (filter_answer(loaded, value) != filter_answer(filter, value))
+        {
+          throw std::runtime_error(std::format(": loaded {} differs for "
+                                               "value {}", name, value));
+        }
+      }
+    }
+    if (memory_map)
+    {
+      Filter read_only = Filter::load(filename, true);
+      bool rejected = false;
+      try
+      {
+        inserter(read_only, others[0]);
+      }
+      catch (const std::runtime_error &)
+      {
+        rejected = true;
+      }
+      if (not rejected)
+      {
+        throw std::runtime_error(std::format(": value was inserted into "
+                                             "memory mapped {}", name));
+      }
+    }
+  }
+  printf("%s\tOK\n", name.c_str());
+}
+
+template<class Filter>
+static void check_filter(const std::string &name, Filter &filter,
+                         const std::string &filename,
+                         const std::vector<uint64_t> &inserted,
+                         const std::vector<uint64_t> &others)
+{
+  const auto inserter = [](Filter &this_filter, uint64_t value)
+                        {
+                          this_filter.insert(value);
+                        };
+  for (auto value : inserted)
+  {
+    inserter(filter, value);
+  }
+  check_loaded(name, filter, filename, inserted, others, inserter);
+}
+
+template<class Filter>
+static void check_interleaved_filter(const std::string &name, Filter &filter,
+                                     size_t bins,
+                                     const std::string &filename,
+                                     const std::vector<uint64_t> &inserted,
+                                     const std::vector<uint64_t> &others)
+{
+  const auto inserter = [bins](Filter &this_filter, uint64_t value)
+                        {
+                          this_filter.insert(value % bins, value);
+                        };
+  for (auto value : inserted)
+  {
+    inserter(filter, value);
+  }
+  check_loaded(name, filter, filename, inserted, others, inserter);
+}
+
+static void check_all_filters(const std::string &filename)
+{
+  constexpr const size_t num_values = 100000;
+  const std::vector<uint64_t> inserted = random_values(num_values, 1);
+  const std::vector<uint64_t> others = random_values(num_values, 2);
+  {
+    BloomFilter<false> filter(0.01, num_values);
+    check_filter("BloomFilter<false>", filter, filename, inserted, others);
+  }
+  {
+    BloomFilter<true> filter(0.01, num_values);
+    check_filter("BloomFilter<true>", filter, filename, inserted, others);
+  }
+  {
+    BlockedBloomFilter<false> filter(num_values / 50, 7);
+    check_filter("BlockedBloomFilter<false>", filter, filename, inserted,
+                 others);
+  }
+  {
+    OneHashingBlockedBloomFilter<false> filter(num_values / 50);
+    check_filter("OneHashingBlockedBloomFilter<false>", filter, filename,
+                 inserted, others);
+  }
+  {
+    SplitBlockBloomFilter<false> filter(num_values / 25);
+    check_filter("SplitBlockBloomFilter<false>", filter, filename, inserted,
+                 others);
+  }
+  {
+    SplitBlockBloomFilter<true> filter(num_values / 25);
+    check_filter("SplitBlockBloomFilter<true>", filter, filename, inserted,
+                 others);
+  }
+  {
+    SingleInterleavedBloomFilter<uint64_t> filter(num_values * 4, 3);
+    check_interleaved_filter("SingleInterleavedBloomFilter<uint64_t>",
+                             filter, 64, filename, inserted, others);
+  }
+  {
+    SingleInterleavedBloomFilter<uint8_t> filter(num_values * 4, 3);
+    check_interleaved_filter("SingleInterleavedBloomFilter<uint8_t>",
+                             filter, 8, filename, inserted, others);
+  }
+  {
+    constexpr const size_t bins = 130;
+    InterleavedBloomFilter filter(bins, num_values / 8, 3);
+    check_interleaved_filter("InterleavedBloomFilter", filter, bins,
+                             filename, inserted, others);
+  }
+  bool rejected = false;
+  try
+  {
+    static_cast<void>(BloomFilter<false>::load(filename, true));
+  }
+  catch (const std::runtime_error &)
+  {
+    rejected = true;
+  }
+  if (not rejected)
+  {
+    throw std::runtime_error(": file of InterleavedBloomFilter was loaded "
+                             "as BloomFilter");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <tmpfile>" << '\n';
+    return EXIT_FAILURE;
+  }
+  try
+  {
+    check_all_filters(argv[1]);
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << argv[0] << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <format>
+#include "utilities/cuckoo_filter.hpp"
+
+/* checks the counts of a cuckoo filter after insertions and removals of
+   values with different multiplicities, its load factor when it is full
+   and the concurrent insertion by several threads */
+
+static std::vector<uint64_t> random_values(size_t size, uint64_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::vector<uint64_t> values(size);
+  for (auto &value : values)
+  {
+    value = rng();
+  }
+  return values;
+}
+
+template<bool thread_safe>
+static void check_counts(size_t num_values)
+{
+  CuckooFilter<thread_safe> filter(num_values);
+  const std::vector<uint64_t> values = random_values(num_values, 1);
+  std::unordered_map<uint64_t,uint32_t> multiplicities{};
+  for (size_t idx = 0; idx < values.size(); idx++)
+  {
+    const uint32_t multiplicity = static_cast<uint32_t>(idx % 5) + 1;
+    for (uint32_t count = 0; count < multiplicity; count++)
+    {
+      if (not filter.insert(values[idx]))
+      {
+        throw std::runtime_error(std::format(": cannot insert value {} of "
+                                             "{}", idx, num_values));
+      }
+    }
+    multiplicities[values[idx]] = multiplicity;
+  }
+  size_t overestimated = 0;
+  for (auto value : values)
+  {
+    const uint32_t count = filter.count(value);
+    if (count < multiplicities[value])
+    {
+      throw std::runtime_error(std::format(": count {} is smaller than {}",
+                                           count, multiplicities[value]));
+    }
+    overestimated += count > multiplicities[value];
+  }
+  /* remove all occurrences of every second value */
+  for (size_t idx = 0; idx < values.size(); idx += 2)
+  {
+    for (uint32_t count = 0; count < multiplicities[values[idx]]; count++)
+    {
+      if (not filter.remove(values[idx]))
+      {
+        throw std::runtime_error(std::format(": cannot remove value {}",
+                                             idx));
+      }
+    }
+  }
+  size_t false_positives = 0;
+  for (size_t idx = 0; idx < values.size(); idx++)
+  {
+    if (idx % 2 == 0)
+    {
+      false_positives += filter.contains(values[idx]);
+    } else
+    {
+      if (filter.count(values[idx]) < multiplicities[values[idx]])
+      {
+        throw std::runtime_error(std::format(": value {} was lost by "
+                                             "removing other values", idx));
+      }
+    }
+  }
+  for (auto value : random_values(num_values, 2))
+  {
+    false_positives += filter.contains(value);
+  }
+  printf("# overestimated counts: %zu, false positives: %zu\n",
+         overestimated, false_positives);
+  if (false_positives > num_values / 100)
+  {
+    throw std::runtime_error(std::format(": too many false positives: {}",
+                                         false_positives));
+  }
+}
+
+static void check_load_factor(size_t num_values)
+{
+  CuckooFilter<false> filter(num_values);
+  const size_t slots = filter.size_in_bytes() / sizeof(uint32_t);
+  size_t inserted = 0;
+  for (auto value : random_values(2 * slots, 3))
+  {
+    if (not filter.insert(value))
+    {
+      break;
+    }
+    inserted++;
+  }
+  const double load_factor = static_cast<double>(inserted)
+                             / static_cast<double>(slots);
+  printf("# load factor: %.3f\n", load_factor);
+  if (load_factor < 0.9)
+  {
+    throw std::runtime_error(std::format(": load factor {:.3f} is too "
+                                         "small", load_factor));
+  }
+}
+
+static void check_threads(size_t num_values, size_t num_threads)
+{
+  CuckooFilter<true> filter(num_values);
+  const std::vector<uint64_t> values = random_values(num_values, 4);
+  /* the first half is inserted before the threads insert the second
+     half twice and remove it once, the queries for the first half must
+     always succeed. The counts of a value only depend on the values with
+     the same pair of buckets and fingerprint, so they must coincide with
+     the counts of a filter built by a single thread */
+  CuckooFilter<false> reference(num_values);
+  const size_t half = num_values / 2;
+  for (size_t idx = 0; idx < half; idx++)
+  {
+    filter.insert(values[idx]);
+    reference.insert(values[idx]);
+  }
+  for (size_t idx = half; idx < values.size(); idx++)
+  {
+    reference.insert(values[idx]);
+    reference.insert(values[idx]);
+    reference.remove(values[idx]);
+  }
+  std::vector<std::thread> threads{};
+  std::atomic<size_t> failures = 0;
+  for (size_t thd = 0; thd < num_threads; thd++)
+  {
+    threads.push_back(std::thread([thd, num_threads, half, &filter, &values,
+                                   &failures]()
+    {
+      for (size_t idx = half + thd; idx < values.size(); idx += num_threads)
+      {
+        failures += not filter.insert(values[idx]);
+        failures += not filter.contains(values[idx - half]);
+        failures += not filter.insert(values[idx]);
+        failures += not filter.remove(values[idx]);
+      }
+    }));
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  for (auto value : values)
+  {
+    failures += not filter.contains(value);
+    failures += filter.count(value) != reference.count(value);
+  }
+  if (failures > 0)
+  {
+    throw std::runtime_error(std::format(": {} failures with {} threads",
+                                         failures.load(), num_threads));
+  }
+}
+
+int main(void)
+{
+  try
+  {
+    check_counts<false>(100000);
+    check_counts<true>(100000);
+    check_load_factor(100000);
+    check_threads(200000, 4);
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << "cuckoo_filter.x" << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
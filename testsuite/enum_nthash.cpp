@@ -37,6 +37,7 @@
 #include "utilities/runtime_class.hpp"
 #include "utilities/bytes_unit.hpp"
 #include "sequences/qgrams_hash_nthash.hpp"
+#include "sequences/nthash_lanes.hpp"
 #include "sequences/guess_if_protein_seq.hpp"
 #include "sequences/gttl_multiseq.hpp"
 #ifndef NDEBUG
@@ -57,7 +58,8 @@ class NtHashOptions
   bool help_option,
        bytes_unit_option,
        with_rc_option,
-       show_hash_values;
+       show_hash_values,
+       lanes_option;
   int hashbits;
   size_t kmer_length;
 
@@ -67,6 +69,8 @@ class NtHashOptions
     , help_option(false)
     , bytes_unit_option(false)
     , with_rc_option(false)
+    , show_hash_values(false)
+    , lanes_option(false)
     , hashbits(0)
     , kmer_length(0)
   {};
@@ -90,6 +94,9 @@ class NtHashOptions
        cxxopts::value<bool>(with_rc_option)->default_value("false"))
       ("s,show_hash_values", "show the hash values",
        cxxopts::value<bool>(show_hash_values)->default_value("false"))
+      ("lanes", "compute the hash values of DNA sequences for several "
+                "segments at once using SIMD instructions",
+       cxxopts::value<bool>(lanes_option)->default_value("false"))
      ("h,help", "print usage");
     try
     {
@@ -138,6 +145,10 @@ class NtHashOptions
   {
     return show_hash_values;
   }
+  [[nodiscard]] bool lanes_option_is_set(void) const noexcept
+  {
+    return lanes_option;
+  }
   [[nodiscard]] const std::vector<std::string> &
   inputfiles_get(void) const noexcept
   {
@@ -510,7 +521,26 @@ int main(int argc,char *argv[])
 #endif
       } else
       {
-        if (options.with_rc_option_is_set())
+        if (options.lanes_option_is_set())
+        {
+          if (options.with_rc_option_is_set())
+          {
+            enumerate_nt_hash<QgramNtHashLanesIterator4,true, false>
+                             (inputfile.c_str(),
+                              options.show_hash_values_is_set(),
+                              options.bytes_unit_option_is_set(),
+                              options.kmer_length_get(),
+                              options.hashbits_get());
+          } else
+          {
+            enumerate_nt_hash<QgramNtHashLanesFwdIterator4,false, false>
+                             (inputfile.c_str(),
+                              options.show_hash_values_is_set(),
+                              options.bytes_unit_option_is_set(),
+                              options.kmer_length_get(),
+                              options.hashbits_get());
+          }
+        } else if (options.with_rc_option_is_set())
         {
           enumerate_nt_hash<QgramNtHashIterator4,true, false>
                            (inputfile.c_str(),
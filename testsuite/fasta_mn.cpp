@@ -22,20 +22,22 @@
 #include <string>
 #include <cassert>
 #include <string_view>
+#include <tuple>
 #include <cstdio>
 #include <vector>
 #include "sequences/gttl_fasta_generator.hpp"
+#include "sequences/gttl_fastq_generator.hpp"
+#include "sequences/sequences_chunk_reader.hpp"
 #include "utilities/gttl_mmap.hpp"
 #include "sequences/format_sequence.hpp"
 #include "seq_reader_options.hpp"
 
 template<class Iterator>
 static void process_iterator(Iterator &iterator,
-                             bool statistics,
-                             size_t line_width)
+                             size_t line_width,
+                             size_t *seqnum,
+                             size_t *total_length)
 {
-  size_t seqnum = 0;
-  size_t total_length = 0;
   for (auto &&si : iterator)
   {
     const std::string_view &sequence = si->sequence_get();
@@ -45,17 +47,18 @@ static void process_iterator(Iterator &iterator,
       std::cout << '>' << header << '\n';
       gttl_format_sequence(sequence,line_width);
     }
-    seqnum++;
-    total_length += sequence.size();
-  }
-  if (statistics)
-  {
-    std::cout << "# number of sequences\t" << seqnum << '\n';
-    std::cout << "# total length\t" << total_length << '\n';
-    std::cout << "# mean length\t" << total_length / seqnum << '\n';
+    (*seqnum)++;
+    *total_length += sequence.size();
   }
 }
 
+static void show_statistics(size_t seqnum, size_t total_length)
+{
+  std::cout << "# number of sequences\t" << seqnum << '\n';
+  std::cout << "# total length\t" << total_length << '\n';
+  std::cout << "# mean length\t" << total_length / seqnum << '\n';
+}
+
 int main(int argc,char *argv[])
 {
   SeqReaderOptions options{0,false};
@@ -81,20 +84,49 @@ int main(int argc,char *argv[])
     constexpr const size_t buf_size = size_t{1} << size_t{14};
     for (const auto & inputfile : inputfiles)
     {
-      if (options.mapped_option_is_set())
+      size_t seqnum = 0;
+      size_t total_length = 0;
+      if (options.chunk_size_get() > 0)
+      {
+        GttlSequencesChunkReader chunk_reader(inputfile,
+                                              options.chunk_size_get());
+        std::string chunk{};
+        while (std::get<0>(chunk_reader.next(chunk)))
+        {
+          if (chunk_reader.fasta_format_get())
+          {
+            GttlFastAGenerator<buf_size> gttl_si{std::string_view(chunk)};
+            process_iterator<GttlFastAGenerator<buf_size>>(gttl_si,
+                                                           line_width,
+                                                           &seqnum,
+                                                           &total_length);
+          } else
+          {
+            using FastQGenerator = GttlFastQGenerator<buf_size,false>;
+            FastQGenerator gttl_si(chunk.data(),chunk.size());
+            process_iterator<FastQGenerator>(gttl_si,
+                                             line_width,
+                                             &seqnum,
+                                             &total_length);
+          }
+        }
+      } else if (options.mapped_option_is_set())
       {
         const Gttlmmap<char> mapped_file(inputfile.c_str());
         GttlFastAGenerator<buf_size> gttl_si(std::string_view(
                                                mapped_file.ptr(),
                                                mapped_file.size()));
-        process_iterator<GttlFastAGenerator<buf_size>>(gttl_si,
-                                                       statistics,line_width);
+        process_iterator<GttlFastAGenerator<buf_size>>(gttl_si,line_width,
+                                                       &seqnum,&total_length);
       } else
       {
         GttlFastAGenerator<buf_size> gttl_si(inputfile.c_str());
-        process_iterator<GttlFastAGenerator<buf_size>>(gttl_si,statistics,
-                                                       line_width);
-
+        process_iterator<GttlFastAGenerator<buf_size>>(gttl_si,line_width,
+                                                       &seqnum,&total_length);
+      }
+      if (statistics)
+      {
+        show_statistics(seqnum,total_length);
       }
     }
   }
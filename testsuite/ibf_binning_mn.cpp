@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <format>
+#include "utilities/cxxopts.hpp"
+#include "utilities/runtime_class.hpp"
+#include "utilities/interleaved_bloom_filter.hpp"
+#include "threading/thread_pool_var.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/multiseq_factory.hpp"
+#include "options_main.hpp"
+
+class IBFBinningOptions
+{
+ private:
+  std::string inputfile,
+              queryfile,
+              output_file,
+              index_file;
+  size_t num_parts,
+         qgram_length,
+         errors,
+         num_threads;
+  double false_positive_rate;
+  bool help_option;
+
+ public:
+  IBFBinningOptions(void)
+    : num_parts(0)
+    , qgram_length(0)
+    , errors(0)
+    , num_threads(1)
+    , false_positive_rate(0.05)
+    , help_option(false)
+  {}
+
+  void parse(int argc, char **argv)
+  {
+    cxxopts::Options options(argv[0],"split the sequences of a file into "
+                                     "parts, store the q-grams of each part "
+                                     "in a bin of an interleaved Bloom "
+                                     "filter and output the bins containing "
+                                     "the q-grams of query sequences");
+    options.set_width(80);
+    options.custom_help(std::string("[options] [filename]"));
+    options.set_tab_expansion();
+    options.add_options()
+      ("p,num_parts", "specify the number of parts, i.e. bins",
+       cxxopts::value<size_t>(num_parts)->default_value("16"))
+      ("k,qgram_length", "specify q-gram length, at most 32",
+       cxxopts::value<size_t>(qgram_length)->default_value("19"))
+      ("f,false_positive_rate", "specify the false positive rate of the "
+                                "Bloom filters of the bins",
+       cxxopts::value<double>(false_positive_rate)->default_value("0.05"))
+      ("e,errors", "specify the number of errors allowed in a match of a "
+                   "query, which determines the minimum number of q-grams "
+                   "a bin must contain by the q-gram lemma",
+       cxxopts::value<size_t>(errors)->default_value("0"))
+      ("q,query", "specify the file of the query sequences; if not given, "
+                  "the sequences of each part are queried and are "
+                  "required to be found in the bin of the part",
+       cxxopts::value<std::string>(queryfile)->default_value(""))
+      ("t,num_threads", "specify number of threads",
+       cxxopts::value<size_t>(num_threads)->default_value("1"))
+      ("o,output", "write the interleaved Bloom filter to the given file",
+       cxxopts::value<std::string>(output_file)->default_value(""))
+      ("i,index", "memory map the interleaved Bloom filter from the given "
+                  "file written with option -o, instead of constructing it "
+                  "from an input file; requires option -q",
+       cxxopts::value<std::string>(index_file)->default_value(""))
+      ("h,help", "print usage");
+    try
+    {
+      auto result = options.parse(argc, argv);
+      if (result.contains("help"))
+      {
+        help_option = true;
+        options_usage(options);
+        return;
+      }
+      const std::vector<std::string>& unmatched_args = result.unmatched();
+      if (index_file.empty())
+      {
+        if (unmatched_args.size() != 1)
+        {
+          throw cxxopts::exceptions::exception("exactly one input file is "
+                                               "required");
+        }
+        inputfile = unmatched_args[0];
+      } else
+      {
+        if (not unmatched_args.empty() or queryfile.empty())
+        {
+          throw cxxopts::exceptions::exception("option -i,--index requires "
+                                               "option -q,--query and no "
+                                               "input file");
+        }
+      }
+      if (num_parts == 0)
+      {
+        throw cxxopts::exceptions::exception("option -p,--num_parts "
+                                             "requires positive argument");
+      }
+      if (num_threads == 0)
+      {
+        throw cxxopts::exceptions::exception("option -t,--num_threads "
+                                             "requires positive argument");
+      }
+    }
+    catch (const cxxopts::exceptions::exception &e)
+    {
+      options_usage(options);
+      throw std::invalid_argument(e.what());
+    }
+  }
+  [[nodiscard]] const std::string &inputfile_get(void) const noexcept
+  {
+    return inputfile;
+  }
+  [[nodiscard]] const std::string &queryfile_get(void) const noexcept
+  {
+    return queryfile;
+  }
+  [[nodiscard]] const std::string &output_file_get(void) const noexcept
+  {
+    return output_file;
+  }
+  [[nodiscard]] const std::string &index_file_get(void) const noexcept
+  {
+    return index_file;
+  }
+  [[nodiscard]] size_t num_parts_get(void) const noexcept
+  {
+    return num_parts;
+  }
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+  [[nodiscard]] size_t errors_get(void) const noexcept
+  {
+    return errors;
+  }
+  [[nodiscard]] size_t num_threads_get(void) const noexcept
+  {
+    return num_threads;
+  }
+  [[nodiscard]] double false_positive_rate_get(void) const noexcept
+  {
+    return false_positive_rate;
+  }
+  [[nodiscard]] bool help_option_is_set(void) const noexcept
+  {
+    return help_option;
+  }
+};
+
+struct IBFQuery
+{
+  const char *sequence;
+  size_t seqlen,
+         part; /* the part of the query, if it is from the input file */
+  size_t qgrams_number;
+  std::vector<size_t> bins;
+};
+
+static void ibf_binning(const IBFBinningOptions &options)
+{
+  constexpr const bool store_header = false;
+  constexpr const bool store_sequence = true;
+  constexpr const bool short_header = false;
+  RunTimeClass rt_construct{};
+  const bool from_index = not options.index_file_get().empty();
+  const GttlMultiseqFactory *const multiseq_factory
+    = from_index ? nullptr
+                 : new GttlMultiseqFactory(options.inputfile_get(),
+                                           options.num_parts_get(),
+                                           0, 0, UINT8_MAX, store_header,
+                                           short_header);
+  const InterleavedBloomFilter2 ibf
+    = from_index ? InterleavedBloomFilter2::load(options.index_file_get(),
+                                                 true)
+                 : InterleavedBloomFilter2(multiseq_factory,
+                                           options.false_positive_rate_get(),
+                                           options.qgram_length_get(),
+                                           options.num_threads_get());
+  rt_construct.show(std::format("{} interleaved Bloom filter with {} bins "
+                                "of {} bits and {} hash functions",
+                                from_index ? "memory mapping"
+                                           : "constructing",
+                                ibf.bins_get(), ibf.num_bits_get(),
+                                ibf.num_hash_functions_get()));
+  if (not options.output_file_get().empty())
+  {
+    RunTimeClass rt_output{};
+    ibf.serialize(options.output_file_get());
+    rt_output.show(std::format("writing interleaved Bloom filter to {}",
+                               options.output_file_get()));
+  }
+  RunTimeClass rt_query{};
+  const bool self_query = options.queryfile_get().empty();
+  const GttlMultiseq *const query_multiseq
+    = self_query ? nullptr
+                 : new GttlMultiseq(options.queryfile_get(), store_header,
+                                    store_sequence, UINT8_MAX, false);
+  std::vector<IBFQuery> queries{};
+  if (self_query)
+  {
+    for (size_t part = 0; part < multiseq_factory->size(); part++)
+    {
+      const GttlMultiseq *const multiseq = multiseq_factory->at(part);
+      for (size_t seqnum = 0; seqnum < multiseq->sequences_number_get();
+           seqnum++)
+      {
+        queries.push_back({multiseq->sequence_ptr_get(seqnum),
+                           multiseq->sequence_length_get(seqnum),
+                           part, 0, {}});
+      }
+    }
+  } else
+  {
+    for (size_t seqnum = 0; seqnum < query_multiseq->sequences_number_get();
+         seqnum++)
+    {
+      queries.push_back({query_multiseq->sequence_ptr_get(seqnum),
+                         query_multiseq->sequence_length_get(seqnum),
+                         0, 0, {}});
+    }
+  }
+  std::vector<InterleavedBloomFilter2::CountingAgent> agents{};
+  for (size_t thd = 0; thd < options.num_threads_get(); thd++)
+  {
+    agents.emplace_back(&ibf);
+  }
+  gttl_thread_pool_var(options.num_threads_get(),
+                       queries.size(),
+                       [&ibf, &options, &agents, &queries] (size_t thd,
+                                                            size_t query_idx)
+                       {
+                         IBFQuery &query = queries[query_idx];
+                         agents[thd].bulk_count(query.sequence,
+                                                query.seqlen);
+                         query.qgrams_number
+                           = agents[thd].qgrams_number_get();
+                         query.bins
+                           = agents[thd].bins_select(
+                               InterleavedBloomFilter2::qgram_lemma_threshold(
+                                 query.qgrams_number,
+                                 ibf.qgram_length_get(),
+                                 options.errors_get()));
+                       });
+  rt_query.show(std::format("querying {} sequences using {} threads",
+                            queries.size(), options.num_threads_get()));
+  printf("# fields: query, number of q-grams, bins\n");
+  for (size_t query_idx = 0; query_idx < queries.size(); query_idx++)
+  {
+    const IBFQuery &query = queries[query_idx];
+    if (self_query and query.qgrams_number > 0 and
+        not std::ranges::binary_search(query.bins, query.part))
+    {
+      throw std::runtime_error(std::format(": sequence {} is not found in "
+                                           "bin {} of its part",
+                                           query_idx, query.part));
+    }
+    printf("%zu\t%zu\t", query_idx, query.qgrams_number);
+    for (size_t idx = 0; idx < query.bins.size(); idx++)
+    {
+      printf("%s%zu", idx == 0 ? "" : ",", query.bins[idx]);
+    }
+    printf("\n");
+  }
+  delete query_multiseq;
+  delete multiseq_factory;
+}
+
+int main(int argc, char *argv[])
+{
+  return options_main<IBFBinningOptions>(argc, argv, ibf_binning);
+}
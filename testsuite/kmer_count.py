@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+# count the k-mers of DNA sequences in a FASTA file, for verifying the
+# output of kmer_counter_mn.x -d
+
+import sys, re, argparse
+from collections import Counter
+
+def parse_arguments():
+  p = argparse.ArgumentParser(description='count k-mers exactly')
+  p.add_argument('-c','--canonical',action='store_true',default=False,
+                 help='count canonical k-mers')
+  p.add_argument('kmer_length',type=int,help='specify k-mer length')
+  p.add_argument('inputfile',type=str,help='specify FASTA file')
+  return p.parse_args()
+
+def sequences(inputfile):
+  seq = list()
+  with open(inputfile) as stream:
+    for line in stream:
+      if line.startswith('>'):
+        if seq:
+          yield ''.join(seq)
+        seq = list()
+      else:
+        seq.append(line.rstrip())
+  if seq:
+    yield ''.join(seq)
+
+rank = {'A': 0, 'C': 1, 'G': 2, 'T': 3, 'U': 3}
+
+args = parse_arguments()
+k = args.kmer_length
+counts = Counter()
+for seq in sequences(args.inputfile):
+  for nuc_range in re.findall(r'[ACGTUacgtu]+',seq):
+    codes = [rank[cc.upper()] for cc in nuc_range]
+    for i in range(len(codes) - k + 1):
+      fwd = 0
+      rc = 0
+      for j in range(k):
+        fwd = 4 * fwd + codes[i + j]
+        rc = 4 * rc + 3 - codes[i + k - 1 - j]
+      counts[min(fwd,rc) if args.canonical else fwd] += 1
+for code in sorted(counts):
+  print('{}\t{}'.format(code,counts[code]))
@@ -0,0 +1,253 @@
+#include <cinttypes>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include "utilities/cxxopts.hpp"
+#include "utilities/runtime_class.hpp"
+#include "utilities/concurrent_count_table.hpp"
+#include "utilities/nttable.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/kmer_counter.hpp"
+#include "sequences/qgrams_hash_nthash.hpp"
+#include "sequences/ntcard.hpp"
+#include "options_main.hpp"
+
+class KmerCounterOptions
+{
+ private:
+  std::vector<std::string> inputfiles;
+  size_t qgram_length,
+         num_threads,
+         max_count,
+         r_value,
+         expected_keys;
+  bool canonical_option,
+       dump_option,
+       help_option;
+
+ public:
+  KmerCounterOptions(void)
+    : qgram_length(0)
+    , num_threads(1)
+    , max_count(0)
+    , r_value(0)
+    , expected_keys(0)
+    , canonical_option(false)
+    , dump_option(false)
+    , help_option(false)
+  {}
+
+  void parse(int argc, char **argv)
+  {
+    cxxopts::Options options(argv[0],"count the k-mers of DNA sequences "
+                                     "exactly");
+    options.set_width(80);
+    options.custom_help(std::string("[options] filename0 [filename1 ...]"));
+    options.set_tab_expansion();
+    options.add_options()
+      ("k,kmer_length", "specify k-mer length, at most 31",
+       cxxopts::value<size_t>(qgram_length)->default_value("21"))
+      ("t,num_threads", "specify number of threads",
+       cxxopts::value<size_t>(num_threads)->default_value("1"))
+      ("c,canonical", "count canonical k-mers",
+       cxxopts::value<bool>(canonical_option)->default_value("false"))
+      ("d,dump", "output the integer code and the count of all k-mers "
+                 "in ascending order of the codes",
+       cxxopts::value<bool>(dump_option)->default_value("false"))
+      ("histogram", "output the number of k-mers occurring c times, for "
+                    "all c from 1 to the given maximum count",
+       cxxopts::value<size_t>(max_count)->default_value("0"))
+      ("ntcard", "compare the number of distinct k-mers and the number "
+                 "of k-mers occurring once with the estimates of ntCard "
+                 "for the first input file, using a table of 2^r "
+                 "counters, where r is the argument of this option; "
+                 "cannot be combined with option -c,--canonical",
+       cxxopts::value<size_t>(r_value)->default_value("0"))
+      ("expected_keys", "specify the number of distinct k-mers for which "
+                        "the table is initially sized; if 0, then this "
+                        "number is estimated from the sequences",
+       cxxopts::value<size_t>(expected_keys)->default_value("0"))
+      ("h,help", "print usage");
+    try
+    {
+      auto result = options.parse(argc, argv);
+      if (result.contains("help"))
+      {
+        help_option = true;
+        options_usage(options);
+        return;
+      }
+      for (const auto &unmatched_arg : result.unmatched())
+      {
+        inputfiles.push_back(unmatched_arg);
+      }
+      if (inputfiles.empty())
+      {
+        throw cxxopts::exceptions::exception("not enough input files");
+      }
+      if (num_threads == 0)
+      {
+        throw cxxopts::exceptions::exception("option -t,--num_threads "
+                                             "requires positive argument");
+      }
+      if (r_value > 0 and canonical_option)
+      {
+        throw cxxopts::exceptions::exception("option --ntcard cannot be "
+                                             "combined with option "
+                                             "-c,--canonical");
+      }
+    }
+    catch (const cxxopts::exceptions::exception &e)
+    {
+      options_usage(options);
+      throw std::invalid_argument(e.what());
+    }
+  }
+  [[nodiscard]] const std::vector<std::string> &inputfiles_get(void)
+                                                   const noexcept
+  {
+    return inputfiles;
+  }
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+  [[nodiscard]] size_t num_threads_get(void) const noexcept
+  {
+    return num_threads;
+  }
+  [[nodiscard]] size_t max_count_get(void) const noexcept
+  {
+    return max_count;
+  }
+  [[nodiscard]] size_t r_value_get(void) const noexcept
+  {
+    return r_value;
+  }
+  [[nodiscard]] size_t expected_keys_get(void) const noexcept
+  {
+    return expected_keys;
+  }
+  [[nodiscard]] bool canonical_option_is_set(void) const noexcept
+  {
+    return canonical_option;
+  }
+  [[nodiscard]] bool dump_option_is_set(void) const noexcept
+  {
+    return dump_option;
+  }
+  [[nodiscard]] bool help_option_is_set(void) const noexcept
+  {
+    return help_option;
+  }
+};
+
+static void ntcard_compare(const KmerCounterOptions &options,
+                           const GttlConcurrentCountTable &table)
+{
+  static constexpr const uint8_t undefined_rank = 0;
+  /* the nthash values of the k-mers with wildcards are not added, as
+     for the exact counts */
+  constexpr const bool split_at_wildcard = true;
+  const NtTable nt_table
+    = ntcard_enumerate<split_at_wildcard,
+                       QgramNtHashFwdIteratorGeneric<undefined_rank>,
+                       QgramNtHashFwdIteratorGenericNoTransform
+                         <undefined_rank>,
+                       NtTable,
+                       false>(options.inputfiles_get()[0],
+                              options.qgram_length_get(),
+                              0,
+                              options.r_value_get(),
+                              1);
+  const NtTableResult nt_table_result = nt_table.estimate_all();
+  const std::vector<size_t> counts_histogram = table.histogram(2);
+  const double exact_F0 = static_cast<double>(table.size());
+  const double exact_f1 = static_cast<double>(counts_histogram[1]);
+  printf("# F0 exact\t%.0f\n",exact_F0);
+  printf("# F0 ntcard\t%.0f\n",nt_table_result.F0_get());
+  printf("F0 relative error\t%.4f\n",
+         std::abs(nt_table_result.F0_get() - exact_F0)/exact_F0);
+  printf("# f1 exact\t%.0f\n",exact_f1);
+  printf("# f1 ntcard\t%.0f\n",nt_table_result.f_n_at(1));
+  printf("f1 relative error\t%.4f\n",
+         std::abs(nt_table_result.f_n_at(1) - exact_f1)/exact_f1);
+}
+
+static void count_kmers(const KmerCounterOptions &options)
+{
+  RunTimeClass rt_create_multiseq{};
+  constexpr const bool store_header = false;
+  constexpr const bool store_sequence = true;
+  const GttlMultiseq multiseq(options.inputfiles_get(),
+                              store_header,
+                              store_sequence,
+                              UINT8_MAX,
+                              false);
+  rt_create_multiseq.show("reading input files and creating multiseq");
+  size_t expected_keys = options.expected_keys_get();
+  if (expected_keys == 0)
+  {
+    RunTimeClass rt_estimate{};
+    /* some more keys than estimated, as the estimate has a relative
+       standard error of about 1% */
+    expected_keys
+      = (options.canonical_option_is_set()
+           ? kmer_counter_distinct_estimate<true>(multiseq,
+                                                  options.qgram_length_get(),
+                                                  options.num_threads_get())
+           : kmer_counter_distinct_estimate<false>
+                                           (multiseq,
+                                            options.qgram_length_get(),
+                                            options.num_threads_get()))
+        * 21 / 20;
+    rt_estimate.show("estimating the number of distinct k-mers");
+    printf("# estimated distinct k-mers\t%zu\n",expected_keys);
+  }
+  RunTimeClass rt_count{};
+  GttlConcurrentCountTable table(expected_keys);
+  if (options.canonical_option_is_set())
+  {
+    kmer_counter_fill<true>(multiseq, options.qgram_length_get(),
+                            options.num_threads_get(), &table);
+  } else
+  {
+    kmer_counter_fill<false>(multiseq, options.qgram_length_get(),
+                             options.num_threads_get(), &table);
+  }
+  rt_count.show(std::format("counting k-mers with {} threads",
+                            options.num_threads_get()));
+  printf("# distinct k-mers\t%zu\n",table.size());
+  printf("# k-mers in overflow table\t%zu\n",table.overflow_size_get());
+  printf("# capacity of table\t%zu\n",table.capacity_get());
+  if (options.dump_option_is_set())
+  {
+    for (auto &[code, count] : table.sorted_dump())
+    {
+      printf("%" PRIu64 "\t%" PRIu64 "\n",code,count);
+    }
+  }
+  if (options.max_count_get() > 0)
+  {
+    const std::vector<size_t> counts_histogram
+      = table.histogram(options.max_count_get());
+    for (size_t count = 1; count < counts_histogram.size(); count++)
+    {
+      printf("%zu\t%zu\n",count,counts_histogram[count]);
+    }
+  }
+  if (options.r_value_get() > 0)
+  {
+    ntcard_compare(options, table);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  return options_main<KmerCounterOptions>(argc, argv, count_kmers);
+}
@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+# compute the number of shared and of all distinct q-grams of all pairs of
+# protein sequences in a FASTA file, for verifying the output of
+# minhash_mn.x --scale 1, which keeps all hash values
+
+import argparse
+from itertools import combinations
+
+def parse_arguments():
+  p = argparse.ArgumentParser(description='compare q-gram sets exactly')
+  p.add_argument('qgram_length',type=int,help='specify q-gram length')
+  p.add_argument('inputfile',type=str,help='specify FASTA file')
+  return p.parse_args()
+
+def sequences(inputfile):
+  seq = list()
+  with open(inputfile) as stream:
+    for line in stream:
+      if line.startswith('>'):
+        if seq:
+          yield ''.join(seq)
+        seq = list()
+      else:
+        seq.append(line.rstrip())
+  if seq:
+    yield ''.join(seq)
+
+args = parse_arguments()
+q = args.qgram_length
+qgram_sets = list()
+for seq in sequences(args.inputfile):
+  qgram_sets.append({seq[i:i+q] for i in range(len(seq) - q + 1)})
+for (i, a), (j, b) in combinations(enumerate(qgram_sets), 2):
+  print('{}\t{}\t{}\t{}'.format(i, j, len(a & b), len(a | b)))
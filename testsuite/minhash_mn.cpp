@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include "utilities/cxxopts.hpp"
+#include "utilities/runtime_class.hpp"
+#include "utilities/matrix_partition.hpp"
+#include "utilities/all_vs_all2.hpp"
+#include "threading/thread_pool_var.hpp"
+#include "sequences/gttl_multiseq.hpp"
+#include "sequences/guess_if_protein_seq.hpp"
+#include "sequences/minhash_sketch.hpp"
+#include "options_main.hpp"
+
+class MinHashOptions
+{
+ private:
+  std::vector<std::string> inputfiles;
+  std::string queryfile;
+  size_t qgram_length,
+         sketch_size,
+         scale,
+         num_threads;
+  double max_distance;
+  bool pairs_option,
+       per_file_option,
+       help_option;
+
+ public:
+  MinHashOptions(void)
+    : qgram_length(0)
+    , sketch_size(0)
+    , scale(0)
+    , num_threads(1)
+    , max_distance(1.0)
+    , pairs_option(false)
+    , per_file_option(false)
+    , help_option(false)
+  {}
+
+  void parse(int argc, char **argv)
+  {
+    cxxopts::Options options(argv[0],"estimate the Jaccard index and the "
+                                     "Mash distance of all pairs of "
+                                     "sequences from MinHash sketches");
+    options.set_width(80);
+    options.custom_help(std::string("[options] filename0 [filename1 ...]"));
+    options.set_tab_expansion();
+    options.add_options()
+      ("k,qgram_length", "specify q-gram length, at most 32 for DNA "
+                         "sequences",
+       cxxopts::value<size_t>(qgram_length)->default_value("21"))
+      ("s,sketch_size", "specify the number of hash values of bottom-k "
+                        "sketches",
+       cxxopts::value<size_t>(sketch_size)->default_value("1000"))
+      ("scale", "compute FracMinHash sketches keeping the hash values up "
+                "to 2^64 divided by the argument of this option, instead "
+                "of bottom-k sketches",
+       cxxopts::value<size_t>(scale)->default_value("0"))
+      ("q,query", "compare the sequences of the input files to those of "
+                  "the given file, instead of all pairs of sequences of "
+                  "the input files",
+       cxxopts::value<std::string>(queryfile)->default_value(""))
+      ("t,num_threads", "specify number of threads",
+       cxxopts::value<size_t>(num_threads)->default_value("1"))
+      ("d,max_distance", "only output pairs with a Mash distance of at "
+                         "most the given value",
+       cxxopts::value<double>(max_distance)->default_value("1.0"))
+      ("p,pairs", "only output the sequence numbers of the pairs, as "
+                  "required by option -r of sw_all_against_all.x",
+       cxxopts::value<bool>(pairs_option)->default_value("false"))
+      ("per_file", "compute one sketch for all sequences of a file and "
+                   "compare the files",
+       cxxopts::value<bool>(per_file_option)->default_value("false"))
+      ("h,help", "print usage");
+    try
+    {
+      auto result = options.parse(argc, argv);
+      if (result.contains("help"))
+      {
+        help_option = true;
+        options_usage(options);
+        return;
+      }
+      for (const auto &unmatched_arg : result.unmatched())
+      {
+        inputfiles.push_back(unmatched_arg);
+      }
+      if (inputfiles.empty())
+      {
+        throw cxxopts::exceptions::exception("not enough input files");
+      }
+      if (num_threads == 0)
+      {
+        throw cxxopts::exceptions::exception("option -t,--num_threads "
+                                             "requires positive argument");
+      }
+      if (per_file_option and pairs_option)
+      {
+        throw cxxopts::exceptions::exception("option --per_file cannot be "
+                                             "combined with option "
+                                             "-p,--pairs");
+      }
+    }
+    catch (const cxxopts::exceptions::exception &e)
+    {
+      options_usage(options);
+      throw std::invalid_argument(e.what());
+    }
+  }
+  [[nodiscard]] const std::vector<std::string> &inputfiles_get(void)
+                                                   const noexcept
+  {
+    return inputfiles;
+  }
+  [[nodiscard]] const std::string &queryfile_get(void) const noexcept
+  {
+    return queryfile;
+  }
+  [[nodiscard]] size_t qgram_length_get(void) const noexcept
+  {
+    return qgram_length;
+  }
+  [[nodiscard]] size_t sketch_size_get(void) const noexcept
+  {
+    return sketch_size;
+  }
+  [[nodiscard]] size_t scale_get(void) const noexcept
+  {
+    return scale;
+  }
+  [[nodiscard]] size_t num_threads_get(void) const noexcept
+  {
+    return num_threads;
+  }
+  [[nodiscard]] double max_distance_get(void) const noexcept
+  {
+    return max_distance;
+  }
+  [[nodiscard]] bool pairs_option_is_set(void) const noexcept
+  {
+    return pairs_option;
+  }
+  [[nodiscard]] bool per_file_option_is_set(void) const noexcept
+  {
+    return per_file_option;
+  }
+  [[nodiscard]] bool help_option_is_set(void) const noexcept
+  {
+    return help_option;
+  }
+};
+
+static std::vector<MinHashSketch> sketches_of_files(
+                                    const MinHashOptions &options,
+                                    const MinHashSketcher &sketcher,
+                                    const std::vector<std::string> &files)
+{
+  constexpr const bool store_header = false;
+  constexpr const bool store_sequence = true;
+  if (not options.per_file_option_is_set())
+  {
+    const GttlMultiseq multiseq(files, store_header, store_sequence,
+                                UINT8_MAX, false);
+    return sketcher.sketches(multiseq, options.num_threads_get());
+  }
+  std::vector<MinHashSketch> file_sketches{};
+  for (auto &file : files)
+  {
+    const GttlMultiseq multiseq(file, store_header, store_sequence,
+                                UINT8_MAX, false);
+    file_sketches.push_back(sketcher.merge(
+                              sketcher.sketches(multiseq,
+                                                options.num_threads_get())));
+  }
+  return file_sketches;
+}
+
+static void compare_sketches(const MinHashOptions &options)
+{
+  RunTimeClass rt_sketch{};
+  const bool is_protein = guess_if_protein_file(options.inputfiles_get());
+  const MinHashSketcher sketcher(options.qgram_length_get(),
+                                 options.sketch_size_get(),
+                                 options.scale_get(),
+                                 is_protein);
+  const std::vector<MinHashSketch> references
+    = sketches_of_files(options, sketcher, options.inputfiles_get());
+  const bool same_container = options.queryfile_get().empty();
+  const std::vector<MinHashSketch> queries
+    = same_container ? std::vector<MinHashSketch>{}
+                     : sketches_of_files(options, sketcher,
+                                         {options.queryfile_get()});
+  const std::vector<MinHashSketch> &query_sketches
+    = same_container ? references : queries;
+  rt_sketch.show(std::format("computing {} sketches with {} threads",
+                             references.size() +
+                             (same_container ? 0 : queries.size()),
+                             options.num_threads_get()));
+  if (references.empty() or query_sketches.empty())
+  {
+    return;
+  }
+  RunTimeClass rt_compare{};
+  std::vector<MinHashComparator *> comparator_vector{};
+  for (size_t thd = 0; thd < options.num_threads_get(); thd++)
+  {
+    comparator_vector.push_back(new MinHashComparator(
+                                      sketcher.sketch_size_get(),
+                                      sketcher.qgram_length_get(),
+                                      options.max_distance_get()));
+  }
+  const size_t cutlen = std::max(size_t(1),
+                                 std::max(references.size(),
+                                          query_sketches.size())/10);
+  const MatrixPartition mp = same_container
+                               ? MatrixPartition(cutlen, references.size())
+                               : MatrixPartition(cutlen, references.size(),
+                                                 query_sketches.size());
+  gttl_thread_pool_var(options.num_threads_get(),
+                       mp.size(),
+                       all_against_all_compare_pairs<MinHashComparator,
+                                                     std::vector<
+                                                       MinHashSketch>>,
+                       references,
+                       query_sketches,
+                       same_container,
+                       mp,
+                       comparator_vector);
+  std::vector<MinHashComparator::Result> results{};
+  for (auto comparator : comparator_vector)
+  {
+    results.insert(results.end(), comparator->results_get().begin(),
+                   comparator->results_get().end());
+    delete comparator;
+  }
+  std::ranges::sort(results,
+                    [](const MinHashComparator::Result &a,
+                       const MinHashComparator::Result &b)
+                    {
+                      return a.ref_idx < b.ref_idx or
+                             (a.ref_idx == b.ref_idx and
+                              a.query_idx < b.query_idx);
+                    });
+  rt_compare.show(std::format("comparing sketches with {} threads",
+                              options.num_threads_get()));
+  if (options.pairs_option_is_set())
+  {
+    for (auto &result : results)
+    {
+      printf("%zu\t%zu\n",result.ref_idx,result.query_idx);
+    }
+  } else
+  {
+    printf("# fields: reference, query, shared, union, jaccard, "
+           "mash distance\n");
+    for (auto &result : results)
+    {
+      printf("%zu\t%zu\t%zu\t%zu\t%.6f\t%.6f\n",
+             result.ref_idx,
+             result.query_idx,
+             result.distance.shared,
+             result.distance.union_size,
+             result.distance.jaccard,
+             result.distance.mash_distance);
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  return options_main<MinHashOptions>(argc, argv, compare_sketches);
+}
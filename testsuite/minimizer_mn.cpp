@@ -14,6 +14,7 @@
   ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <climits>
@@ -27,10 +28,14 @@
 #include <tuple>
 #include <vector>
 #include <format>
+#include <unistd.h>
 
 #include "sequences/gttl_multiseq.hpp"
 #include "sequences/qgrams_hash_nthash.hpp"
 #include "sequences/hashed_qgrams.hpp"
+#include "sequences/hashed_qgrams_external.hpp"
+#include "sequences/hashed_qgrams_index.hpp"
+#include "utilities/gttl_mmap.hpp"
 #include "utilities/runtime_class.hpp"
 #include "utilities/constexpr_for.hpp"
 #include "minimizer_opt.hpp"
@@ -52,6 +57,329 @@ std::pair<int,int> determine_hash_bits(int sequences_bits,
                       requested_hash_bits));
 }
 
+template<int sizeof_unit,class HashIterator,class SamplingPolicy>
+static void hashed_qgrams_external_run(const MinimizerOptions &options,
+                                       const GttlMultiseq &multiseq,
+                                       int hash_bits,
+                                       std::vector<std::string> *log_vector)
+{
+  const std::string file_prefix = std::format("minimizer_mn.{}", getpid());
+  const std::string sorted_file = file_prefix + ".sorted";
+  RunTimeClass rt_external_sort{};
+  HashedQgramsExternalSorter<sizeof_unit>
+    sorter(GttlBitPacker<sizeof_unit,3>({hash_bits,
+                                         multiseq.sequences_number_bits_get(),
+                                         multiseq.sequences_length_bits_get()}),
+           hash_bits,
+           options.external_sort_memory_get() * (size_t(1) << 20),
+           file_prefix,
+           options.number_of_threads_get(),
+           options.external_merge_runs_get());
+  (void) hashed_qgrams_external_collect<sizeof_unit,HashIterator,
+                                        SamplingPolicy>
+                                 (multiseq,
+                                  options.qgram_length_get(),
+                                  options.window_size_get(),
+                                  hash_bits,
+                                  options.at_constant_distance_option_is_set(),
+                                  &sorter);
+  const size_t number_of_hashed_qgrams = sorter.size();
+  const size_t number_of_runs = sorter.runs_number_get();
+  const bool with_index = not options.index_file_get().empty();
+  size_t removed;
+  if (with_index)
+  {
+    HashedQgramsIndexWriter<sizeof_unit>
+      index_writer(options.index_file_get(),
+                   sorter.packer_get(),
+                   hash_bits,
+                   multiseq.sequences_number_bits_get(),
+                   multiseq.sequences_length_bits_get(),
+                   options.qgram_length_get(),
+                   options.window_size_get(),
+                   HashIterator::handle_both_strands,
+                   number_of_hashed_qgrams);
+    removed = sorter.merge(options.max_replicates_get(),
+                           [&index_writer](const BytesUnit<sizeof_unit,3>
+                                             &hashed_qgram)
+                           {
+                             index_writer.append(hashed_qgram);
+                           });
+    index_writer.finish();
+  } else
+  {
+    removed = sorter.merge(sorted_file, options.max_replicates_get());
+  }
+  log_vector->push_back(rt_external_sort.to_string(
+                          std::format("sort {} hashed kmers in external "
+                                      "memory, removed {}",
+                                      number_of_hashed_qgrams,
+                                      removed)));
+  log_vector->push_back(std::format("number of sorted runs\t{}",
+                                    number_of_runs));
+  log_vector->push_back(std::format("number of hashed kmers\t{}",
+                                    number_of_hashed_qgrams - removed));
+  if (not with_index and
+      (HashIterator::handle_both_strands or options.show_mode_get() != 0))
+  {
+    printf("# Hash\tSeqNr\tStart\n");
+    if (number_of_hashed_qgrams > removed) /* empty files cannot be mapped */
+    {
+      const Gttlmmap<BytesUnit<sizeof_unit,3>>
+        sorted_hashed_qgrams(sorted_file.c_str());
+      const auto &packer = sorter.packer_get();
+      for (size_t idx = 0; idx < sorted_hashed_qgrams.size(); idx++)
+      {
+        const BytesUnit<sizeof_unit,3> &hashed_qgram
+          = sorted_hashed_qgrams.ptr()[idx];
+        printf("%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+               hashed_qgram.template decode_at<0>(packer),
+               hashed_qgram.template decode_at<1>(packer),
+               hashed_qgram.template decode_at<2>(packer));
+      }
+    }
+  }
+  (void) std::remove(sorted_file.c_str());
+}
+
+template<int sizeof_unit,class HashIterator,class SamplingPolicy>
+static void hashed_qgrams_run(const MinimizerOptions &options,
+                              const GttlMultiseq &multiseq,
+                              int hash_bits,
+                              std::vector<std::string> *log_vector)
+{
+  if (options.external_sort_memory_get() > 0)
+  {
+    hashed_qgrams_external_run<sizeof_unit,HashIterator,SamplingPolicy>
+                              (options, multiseq, hash_bits, log_vector);
+    return;
+  }
+  using HashedQgrams = HashedQgramsGeneric<sizeof_unit,HashIterator,
+                                           SamplingPolicy>;
+  const HashedQgrams hqg(multiseq,
+                         options.number_of_threads_get(),
+                         options.qgram_length_get(),
+                         options.window_size_get(),
+                         hash_bits,
+                         options.sort_by_hash_value_option_is_set(),
+                         options.at_constant_distance_option_is_set(),
+                         options.max_replicates_get(),
+                         log_vector);
+  if (not options.index_file_get().empty())
+  {
+    RunTimeClass rt_write_index{};
+    const GttlBitPacker<sizeof_unit,3>
+      hashed_qgram_packer({hash_bits,
+                           multiseq.sequences_number_bits_get(),
+                           multiseq.sequences_length_bits_get()});
+    HashedQgramsIndexWriter<sizeof_unit>
+      index_writer(options.index_file_get(),
+                   hashed_qgram_packer,
+                   hash_bits,
+                   multiseq.sequences_number_bits_get(),
+                   multiseq.sequences_length_bits_get(),
+                   options.qgram_length_get(),
+                   options.window_size_get(),
+                   HashIterator::handle_both_strands,
+                   hqg.size());
+    for (size_t idx = 0; idx < hqg.size(); idx++)
+    {
+      const uint64_t seqnum = hqg.sequence_number_get(idx);
+      const uint64_t startpos = hqg.startpos_get(idx);
+      index_writer.append(BytesUnit<sizeof_unit,3>(hashed_qgram_packer,
+                                                   {hqg.hash_value_get(idx),
+                                                    seqnum,
+                                                    startpos}));
+    }
+    index_writer.finish();
+    log_vector->push_back(rt_write_index.to_string(
+                            std::format("write index of {} hashed kmers",
+                                        hqg.size())));
+    return;
+  }
+  if constexpr (HashIterator::handle_both_strands)
+  {
+    RunTimeClass rt_output_hashed_qgrams{};
+    hqg.show();
+    log_vector->push_back(rt_output_hashed_qgrams
+                          .to_string("output of hashed kmers"));
+  } else
+  {
+    if (options.show_mode_get() != 0)
+    {
+      RunTimeClass rt_output_hashed_qgrams{};
+      if (options.show_mode_get() == 1)
+      {
+        hqg.show();
+      } else
+      {
+        if (options.show_mode_get() == 2)
+        {
+          for (auto &&dhqg : hqg)
+          {
+            printf("%" PRIu64 "\t%zu\t%zu\n",
+                   dhqg.hash_value,
+                   dhqg.sequence_number,
+                   dhqg.startpos);
+          }
+        } else
+        {
+          assert(options.show_mode_get() == 3);
+          auto count_runs = hqg.hash_value_run_statistics();
+          for (auto &[r,c] : count_runs)
+          {
+            printf("%zu\t%zu\n",r,c);
+          }
+        }
+      }
+      log_vector->push_back(rt_output_hashed_qgrams
+                            .to_string("output of hashed kmers"));
+    }
+  }
+}
+
+template<int sizeof_unit,class HashIterator>
+static void hashed_qgrams_sampling_dispatch(const MinimizerOptions &options,
+                                            const GttlMultiseq &multiseq,
+                                            int hash_bits,
+                                            std::vector<std::string>
+                                              *log_vector)
+{
+  const std::string &sampling = options.sampling_get();
+  if (sampling == "closed_syncmer")
+  {
+    hashed_qgrams_run<sizeof_unit,HashIterator,ClosedSyncmerSampling>
+                     (options, multiseq, hash_bits, log_vector);
+  } else
+  {
+    if (sampling == "open_syncmer")
+    {
+      hashed_qgrams_run<sizeof_unit,HashIterator,OpenSyncmerSampling>
+                       (options, multiseq, hash_bits, log_vector);
+    } else
+    {
+      if (sampling == "mod_minimizer")
+      {
+        hashed_qgrams_run<sizeof_unit,HashIterator,ModMinimizerSampling>
+                         (options, multiseq, hash_bits, log_vector);
+      } else
+      {
+        assert(sampling == "minimizer");
+        hashed_qgrams_run<sizeof_unit,HashIterator,MinimizerSampling>
+                         (options, multiseq, hash_bits, log_vector);
+      }
+    }
+  }
+}
+
+/* looks up all kmers of all sequences in multiseq in the index and
+   reports for each sequence the number of kmers, the number of kmers
+   found and the number of their occurrences in the index */
+template<int sizeof_unit,class HashIterator>
+static void hashed_qgrams_index_query(const HashedQgramsIndex<sizeof_unit>
+                                        &index,
+                                      const GttlMultiseq &multiseq,
+                                      std::vector<std::string> *log_vector)
+{
+  RunTimeClass rt_query_index{};
+  const size_t qgram_length = index.qgram_length_get();
+  const uint64_t hash_mask
+    = gttl_bits2maxvalue<uint64_t>(index.hashbits_get());
+  std::vector<uint64_t> hash_values{};
+  size_t total_kmers = 0, total_found = 0;
+  printf("# Query\tkmers\tfound\tmatches\n");
+  for (size_t seqnum = 0; seqnum < multiseq.sequences_number_get(); seqnum++)
+  {
+    const char *const sequence = multiseq.sequence_ptr_get(seqnum);
+    const NucleotideRanger ranger(sequence,
+                                  multiseq.sequence_length_get(seqnum));
+    hash_values.clear();
+    for (auto const &&range : ranger)
+    {
+      const size_t this_length = std::get<1>(range);
+      if (this_length < qgram_length)
+      {
+        continue;
+      }
+      HashIterator qgiter(qgram_length, sequence + std::get<0>(range),
+                          this_length);
+      for (auto const &&code_pair : qgiter)
+      {
+        if constexpr (HashIterator::handle_both_strands)
+        {
+          hash_values.push_back(std::min(std::get<0>(code_pair) & hash_mask,
+                                         std::get<1>(code_pair) & hash_mask));
+        } else
+        {
+          hash_values.push_back(std::get<0>(code_pair) & hash_mask);
+        }
+      }
+    }
+    size_t found = 0, matches = 0;
+    index.lookup_batch(hash_values.data(), hash_values.size(),
+                       [&found,&matches]
+                       (size_t, const HashedQgramsIndexMatches<sizeof_unit>
+                                  &this_matches)
+                       {
+                         if (not this_matches.empty())
+                         {
+                           found++;
+                           matches += this_matches.size();
+                         }
+                       });
+    printf("%zu\t%zu\t%zu\t%zu\n",seqnum,hash_values.size(),found,matches);
+    total_kmers += hash_values.size();
+    total_found += found;
+  }
+  log_vector->push_back(rt_query_index.to_string(
+                          std::format("look up {} kmers in index, found {}",
+                                      total_kmers, total_found)));
+}
+
+static void run_query_index(const MinimizerOptions &options)
+{
+  const std::string &indexfile = options.query_index_file_get();
+  const HashedQgramsIndexHeader header
+    = hashed_qgrams_index_header_read(indexfile);
+  RunTimeClass rt_create_multiseq{};
+  constexpr const bool store_header = true;
+  constexpr const bool store_sequence = true;
+  constexpr const uint8_t padding_char = UINT8_MAX;
+  const GttlMultiseq multiseq(options.inputfiles_get(), /* CONSTRUCTOR*/
+                              store_header,
+                              store_sequence,
+                              padding_char,
+                              false);
+  rt_create_multiseq.show("reading input files and creating multiseq");
+  std::vector<std::string> log_vector;
+  constexpr_for<8,9+1,1>([&](auto sizeof_unit_hashed_qgram)
+  {
+    if (sizeof_unit_hashed_qgram == header.sizeof_unit)
+    {
+      RunTimeClass rt_map_index{};
+      const HashedQgramsIndex<sizeof_unit_hashed_qgram> index(indexfile);
+      log_vector.push_back(rt_map_index.to_string(
+                             std::format("map index of {} hashed kmers",
+                                         index.size())));
+      if (index.handle_both_strands_get())
+      {
+        hashed_qgrams_index_query<sizeof_unit_hashed_qgram,
+                                  QgramNtHashIterator4>
+                                 (index, multiseq, &log_vector);
+      } else
+      {
+        hashed_qgrams_index_query<sizeof_unit_hashed_qgram,
+                                  QgramNtHashFwdIterator4>
+                                 (index, multiseq, &log_vector);
+      }
+    }
+  });
+  for (auto &msg : log_vector)
+  {
+    printf("# %s\n",msg.c_str());
+  }
+}
+
 void run_nt_minimizer(const MinimizerOptions &options)
 {
   RunTimeClass rt_create_multiseq{};
@@ -76,71 +404,23 @@ void run_nt_minimizer(const MinimizerOptions &options)
                           options.hash_bits_get());
   assert(var_sizeof_unit_hashed_qgram == 8 or
          var_sizeof_unit_hashed_qgram == 9);
-   constexpr_for<8,9+1,1>([&](auto sizeof_unit_hashed_qgram)
-   {
-     if (sizeof_unit_hashed_qgram == var_sizeof_unit_hashed_qgram)
-     {
-       std::vector<std::string> log_vector;
-       if (options.canonical_option_is_set())
-       {
-        using HashedQgrams = HashedQgramsGeneric<sizeof_unit_hashed_qgram,
-                                                 QgramNtHashIterator4>;
-        const HashedQgrams hqg(multiseq,
-                               options.number_of_threads_get(),
-                               options.qgram_length_get(),
-                               options.window_size_get(),
-                               hash_bits,
-                               options.sort_by_hash_value_option_is_set(),
-                               options.at_constant_distance_option_is_set(),
-                               options.max_replicates_get(),
-                               &log_vector);
-        RunTimeClass rt_output_hashed_qgrams{};
-        hqg.show();
-        log_vector.push_back(rt_output_hashed_qgrams
-                             .to_string("output of hashed kmers"));
+  constexpr_for<8,9+1,1>([&](auto sizeof_unit_hashed_qgram)
+  {
+    if (sizeof_unit_hashed_qgram == var_sizeof_unit_hashed_qgram)
+    {
+      std::vector<std::string> log_vector;
+      if (options.canonical_option_is_set())
+      {
+        hashed_qgrams_sampling_dispatch<sizeof_unit_hashed_qgram,
+                                        QgramNtHashIterator4>
+                                       (options, multiseq, hash_bits,
+                                        &log_vector);
       } else
       {
-        using HashedQgrams = HashedQgramsGeneric<sizeof_unit_hashed_qgram,
-                                                 QgramNtHashFwdIterator4>;
-        const HashedQgrams hqg(multiseq,
-                               options.number_of_threads_get(),
-                               options.qgram_length_get(),
-                               options.window_size_get(),
-                               hash_bits,
-                               options.sort_by_hash_value_option_is_set(),
-                               options.at_constant_distance_option_is_set(),
-                               options.max_replicates_get(),
-                               &log_vector);
-        if (options.show_mode_get() != 0)
-        {
-          RunTimeClass rt_output_hashed_qgrams{};
-          if (options.show_mode_get() == 1)
-          {
-            hqg.show();
-          } else
-          {
-            if (options.show_mode_get() == 2)
-            {
-              for (auto &&dhqg : hqg)
-              {
-                printf("%" PRIu64 "\t%zu\t%zu\n",
-                       dhqg.hash_value,
-                       dhqg.sequence_number,
-                       dhqg.startpos);
-              }
-            } else
-            {
-              assert(options.show_mode_get() == 3);
-              auto count_runs = hqg.hash_value_run_statistics();
-              for (auto &[r,c] : count_runs)
-              {
-                printf("%zu\t%zu\n",r,c);
-              }
-            }
-          }
-          log_vector.push_back(rt_output_hashed_qgrams
-                               .to_string("output of hashed kmers"));
-        }
+        hashed_qgrams_sampling_dispatch<sizeof_unit_hashed_qgram,
+                                        QgramNtHashFwdIterator4>
+                                       (options, multiseq, hash_bits,
+                                        &log_vector);
       }
       for (auto &msg : log_vector)
       {
@@ -170,7 +450,13 @@ int main(int argc, char *argv[])
   }
   try
   {
-    run_nt_minimizer(options);
+    if (options.query_index_file_get().empty())
+    {
+      run_nt_minimizer(options);
+    } else
+    {
+      run_query_index(options);
+    }
   }
   catch (const std::exception &err)
   {
@@ -24,6 +24,11 @@ MinimizerOptions::MinimizerOptions(void)
   , at_constant_distance_option(false)
   , sort_by_hash_value_option(false)
   , help_option(false)
+  , sampling("minimizer")
+  , external_sort_memory(0)
+  , external_merge_runs(128)
+  , index_file("")
+  , query_index_file("")
   { }
 
 void MinimizerOptions::parse(int argc, char **argv)
@@ -71,9 +76,39 @@ void MinimizerOptions::parse(int argc, char **argv)
      cxxopts::value<bool>(at_constant_distance_option)
               ->default_value("false"))
 
+    ("sampling", "specify how to sample the hashed qgrams: minimizer, "
+                 "closed_syncmer, open_syncmer or mod_minimizer; for "
+                 "syncmers the window size is the number of s-mers of a "
+                 "k-mer, i.e. s = k - w + 1",
+     cxxopts::value<std::string>(sampling)->default_value("minimizer"))
+
     ("s,sort_by_hash_value", "sort the hashed qgrams in ascending order of "
                              "their hash value",
      cxxopts::value<bool>(sort_by_hash_value_option)->default_value("false"))
+
+    ("external_sort", "sort the hashed qgrams in external memory, using a "
+                      "buffer of at most the given number of MB; the "
+                      "sorted runs are written to files in the current "
+                      "directory; requires option -s,--sort_by_hash_value",
+     cxxopts::value<size_t>(external_sort_memory)->default_value("0"))
+
+    ("external_merge_runs", "maximum number of sorted runs merged at once "
+                            "when sorting in external memory; more runs "
+                            "are merged in several passes; must be at "
+                            "least 2",
+     cxxopts::value<size_t>(external_merge_runs)->default_value("128"))
+
+    ("index", "write the sorted hashed qgrams to the given index file, "
+              "which can be memory mapped for fast lookups; requires "
+              "option -s,--sort_by_hash_value",
+     cxxopts::value<std::string>(index_file)->default_value(""))
+
+    ("query_index", "look up all k-mers of the sequences in the input "
+                    "files in the given index file and report the "
+                    "number of k-mers found; the k-mer length, the "
+                    "number of hash bits and if canonical k-mers are "
+                    "used is taken from the index",
+     cxxopts::value<std::string>(query_index_file)->default_value(""))
     ("h,help", "print usage");
   try
   {
@@ -118,6 +153,49 @@ void MinimizerOptions::parse(int argc, char **argv)
                               "to also use option -s,--sort_by_hash_value"));
       }
     }
+    if (sampling != "minimizer" and sampling != "closed_syncmer" and
+        sampling != "open_syncmer" and sampling != "mod_minimizer")
+    {
+      throw cxxopts::exceptions::exception(
+                std::format("illegal argument \"{}\" to option --sampling",
+                            sampling));
+    }
+    if (sampling != "minimizer" and at_constant_distance_option)
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("option --sampling cannot be combined with "
+                            "option -d,--constant_distance"));
+    }
+    if (external_sort_memory > 0 and not sort_by_hash_value_option)
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("option --external_sort requires "
+                            "to also use option -s,--sort_by_hash_value"));
+    }
+    if (external_merge_runs < 2)
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("argument to option --external_merge_runs "
+                            "must be at least 2"));
+    }
+    if (external_sort_memory > 0 and show_mode == 3)
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("option --external_sort cannot be combined "
+                            "with option --show_mode 3"));
+    }
+    if (not index_file.empty() and not sort_by_hash_value_option)
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("option --index requires "
+                            "to also use option -s,--sort_by_hash_value"));
+    }
+    if (not index_file.empty() and not query_index_file.empty())
+    {
+      throw cxxopts::exceptions::exception(
+                std::string("option --index cannot be combined "
+                            "with option --query_index"));
+    }
     if (max_replicates > 0 and not sort_by_hash_value_option)
     {
       throw cxxopts::exceptions::exception(
@@ -158,6 +236,27 @@ size_t MinimizerOptions::max_replicates_get(void) const noexcept
   return max_replicates;
 }
 
+size_t MinimizerOptions::external_sort_memory_get(void) const noexcept
+{
+  return external_sort_memory;
+}
+
+size_t MinimizerOptions::external_merge_runs_get(void) const noexcept
+{
+  return external_merge_runs;
+}
+
+const std::string &MinimizerOptions::index_file_get(void) const noexcept
+{
+  return index_file;
+}
+
+const std::string &MinimizerOptions::query_index_file_get(void)
+  const noexcept
+{
+  return query_index_file;
+}
+
 int MinimizerOptions::hash_bits_get(void) const noexcept
 {
   return hash_bits;
@@ -183,6 +282,11 @@ int MinimizerOptions::show_mode_get(void) const noexcept
   return show_mode;
 }
 
+const std::string &MinimizerOptions::sampling_get(void) const noexcept
+{
+  return sampling;
+}
+
 bool MinimizerOptions::help_option_is_set(void) const noexcept
 {
   return help_option;
@@ -18,6 +18,11 @@ class MinimizerOptions
   bool sort_by_hash_value_option;
   bool help_option;
   int show_mode;
+  std::string sampling;
+  size_t external_sort_memory,
+         external_merge_runs;
+  std::string index_file;
+  std::string query_index_file;
   public:
   MinimizerOptions(void);
   void parse(int argc, char **argv);
@@ -31,7 +36,13 @@ class MinimizerOptions
   [[nodiscard]] bool at_constant_distance_option_is_set(void) const noexcept;
   [[nodiscard]] bool sort_by_hash_value_option_is_set(void) const noexcept;
   [[nodiscard]] int show_mode_get(void) const noexcept;
+  [[nodiscard]] const std::string &sampling_get(void) const noexcept;
   [[nodiscard]] size_t max_replicates_get(void) const noexcept;
+  [[nodiscard]] size_t external_sort_memory_get(void) const noexcept;
+  [[nodiscard]] size_t external_merge_runs_get(void) const noexcept;
+  [[nodiscard]] const std::string &index_file_get(void) const noexcept;
+  [[nodiscard]] const std::string &query_index_file_get(void)
+                                     const noexcept;
   [[nodiscard]] bool help_option_is_set(void) const noexcept;
 };
 #endif
@@ -1,3 +1,4 @@
+#include <cassert>
 #include <cstddef>
 #include <cstdlib>
 #include <cstdint>
@@ -6,6 +7,7 @@
 #include <stdexcept>
 #include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <format>
 #include "sequences/gttl_multiseq.hpp"
@@ -26,6 +28,7 @@ class MultiseqOptions
   bool help_option;
   bool protein_option;
   bool zipped_option;
+  bool binned_quality_option;
   bool rankdist_option;
   bool short_header_option;
   bool sorted_by_header_option;
@@ -42,6 +45,7 @@ class MultiseqOptions
    : help_option(false)
    , protein_option(false)
    , zipped_option(false)
+   , binned_quality_option(false)
    , rankdist_option(false)
    , short_header_option(false)
    , sorted_by_header_option(false)
@@ -85,6 +89,10 @@ class MultiseqOptions
                     "file and sequences at odd indexes are "
                     "from the second file",
         cxxopts::value<bool>(zipped_option)->default_value("false"))
+       ("q,binned_quality", "with option -z/--zipped: store the binned "
+                            "qualities and output all reads in fastq "
+                            "format with the binned qualities",
+        cxxopts::value<bool>(binned_quality_option)->default_value("false"))
        ("r,rankdist", "output distribution of ranks of "
                       "transformed sequences",
         cxxopts::value<bool>(rankdist_option)->default_value("false"))
@@ -131,6 +139,11 @@ class MultiseqOptions
         throw std::invalid_argument("option -z/--zipped requires exactly "
                                     "two files");
       }
+      if (binned_quality_option and not zipped_option)
+      {
+        throw std::invalid_argument("option -q/--binned_quality requires to "
+                                    "use option -z/--zipped");
+      }
       if (sorted_by_header_option and width_arg == -1)
       {
         throw std::invalid_argument("option --sorted_by_header requires to "
@@ -203,6 +216,10 @@ class MultiseqOptions
   {
     return zipped_option;
   }
+  [[nodiscard]] bool binned_quality_option_is_set(void) const noexcept
+  {
+    return binned_quality_option;
+  }
   [[nodiscard]] bool rankdist_option_is_set(void) const noexcept
   {
     return rankdist_option;
@@ -317,7 +334,8 @@ int main(int argc, char *argv[])
     constexpr const bool store_header = true;
     const bool store_sequence = options.width_option_get() >= 0 or
                                 options.rankdist_option_is_set() or
-                                options.short_header_option_is_set();
+                                options.short_header_option_is_set() or
+                                options.binned_quality_option_is_set();
     const uint8_t padding_char = UINT8_MAX;
     if (options.zipped_option_is_set() && store_sequence)
     {
@@ -325,7 +343,8 @@ int main(int argc, char *argv[])
                                   inputfiles[1],
                                   store_header,
                                   store_sequence,
-                                  padding_char);
+                                  padding_char,
+                                  options.binned_quality_option_is_set());
     } else
     {
       constexpr const bool with_reverse_complement = false;
@@ -352,6 +371,25 @@ int main(int argc, char *argv[])
   }
   rt_multiseq.show("create GttlMultiseq");
 
+  if (options.binned_quality_option_is_set())
+  {
+    const GttlQualityStore *quality_store = multiseq->quality_store_get();
+    assert(quality_store != nullptr and
+           quality_store->size() == multiseq->sequences_number_get());
+    std::string quality{};
+    for (size_t seqnum = 0; seqnum < multiseq->sequences_number_get();
+         seqnum++)
+    {
+      quality.clear();
+      quality_store->decode(seqnum, &quality);
+      std::cout << '@' << multiseq->header_get(seqnum) << '\n'
+                << std::string_view(multiseq->sequence_ptr_get(seqnum),
+                                    multiseq->sequence_length_get(seqnum))
+                << "\n+\n"
+                << quality << '\n';
+    }
+  }
+
   if (options.width_option_get() >= 0)
   {
     const size_t width = static_cast<size_t>(options.width_option_get());
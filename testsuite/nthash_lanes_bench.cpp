@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sequences/qgrams_hash_nthash.hpp"
+#include "sequences/nthash_lanes.hpp"
+
+/* Compares the throughput of the scalar and the multi-lane computation of
+   the canonical ntHash values of random DNA sequences of the given length
+   via the block interface fill, as used by the consumers of the hash
+   values. The checksums of both methods must coincide. */
+
+static std::vector<std::string> random_sequences(size_t total_length,
+                                                 size_t sequence_length)
+{
+  std::mt19937_64 rng(1);
+  std::vector<std::string> sequences{};
+  for (size_t length = 0; length < total_length; length += sequence_length)
+  {
+    std::string sequence(sequence_length, 'A');
+    for (auto &cc : sequence)
+    {
+      cc = "ACGT"[rng() % 4];
+    }
+    sequences.push_back(sequence);
+  }
+  return sequences;
+}
+
+template<class HashIterator>
+static uint64_t canonical_checksum(const std::vector<std::string> &sequences,
+                                   size_t qgram_length)
+{
+  std::array<uint64_t,256> fwd_hash_values;
+  std::array<uint64_t,256> rc_hash_values;
+  uint64_t checksum = 0;
+  for (auto &sequence : sequences)
+  {
+    HashIterator qgiter(qgram_length, sequence.data(), sequence.size());
+    while (true)
+    {
+      const size_t count = qgiter.fill(fwd_hash_values.data(),
+                                       rc_hash_values.data(),
+                                       fwd_hash_values.size());
+      if (count == 0)
+      {
+        break;
+      }
+      for (size_t idx = 0; idx < count; idx++)
+      {
+        checksum ^= std::min(fwd_hash_values[idx], rc_hash_values[idx]);
+      }
+    }
+  }
+  return checksum;
+}
+
+template<class HashIterator>
+static uint64_t timed_checksum(const char *method,
+                               const std::vector<std::string> &sequences,
+                               size_t qgram_length,
+                               size_t total_length)
+{
+  const auto start = std::chrono::high_resolution_clock::now();
+  const uint64_t checksum
+    = canonical_checksum<HashIterator>(sequences, qgram_length);
+  const double seconds
+    = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()
+                                    - start).count();
+  printf("%s\t%zu\t%zu\t%.1f\n", method, sequences.front().size(),
+         qgram_length,
+         static_cast<double>(total_length) / 1.0e6 / seconds);
+  return checksum;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t total_length, sequence_length, qgram_length;
+  if (argc != 4 or
+      std::sscanf(argv[1], "%zu", &total_length) != 1 or
+      std::sscanf(argv[2], "%zu", &sequence_length) != 1 or
+      std::sscanf(argv[3], "%zu", &qgram_length) != 1 or
+      sequence_length < qgram_length or qgram_length == 0 or
+      qgram_length > 32)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " <total_length> <sequence_length> <qgram_length>\n";
+    return EXIT_FAILURE;
+  }
+  try
+  {
+    const std::vector<std::string> sequences
+      = random_sequences(total_length, sequence_length);
+    printf("# fields: method, sequence length, q-gram length, "
+           "Mbp per second\n");
+    const uint64_t scalar_checksum
+      = timed_checksum<QgramNtHashIterator4>("scalar", sequences,
+                                             qgram_length, total_length);
+    const uint64_t lanes_checksum
+      = timed_checksum<QgramNtHashLanesIterator4>(
+          std::format("lanes{}",
+                      GttlNtHashLanes<>::lanes_get()).c_str(),
+          sequences, qgram_length, total_length);
+    if (scalar_checksum != lanes_checksum)
+    {
+      throw std::runtime_error(": checksums of scalar and lanes differ");
+    }
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << argv[0] << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "utilities/nttable.hpp"
+
+/* Compares the time to merge tables of 2^r counters of ntCard by the
+   scalar loop with a comparison per counter, by the saturating SIMD
+   additions of NtTable::merge for one table after the other and by the
+   merge of all tables with the given number of threads. The estimates
+   of both merges of NtTable must coincide. */
+
+static constexpr const size_t count_max
+  = static_cast<size_t>(std::numeric_limits<uint16_t>::max());
+
+static double elapsed_ms(std::chrono::high_resolution_clock::time_point
+                           start)
+{
+  return std::chrono::duration<double,std::milli>
+                              (std::chrono::high_resolution_clock::now()
+                               - start).count();
+}
+
+static void estimates_compare(const NtTable &table0, const NtTable &table1)
+{
+  const NtTableResult result0 = table0.estimate_all();
+  const NtTableResult result1 = table1.estimate_all();
+  if (result0.F0_get() != result1.F0_get() or
+      result0.F1_get() != result1.F1_get() or
+      result0.t_max_get() != result1.t_max_get())
+  {
+    throw std::runtime_error(": estimates of the merged tables differ");
+  }
+  for (size_t idx = 1; idx <= result0.t_max_get(); idx++)
+  {
+    if (result0.f_n_at(idx) != result1.f_n_at(idx))
+    {
+      throw std::runtime_error(": estimates of the merged tables differ");
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  size_t r, num_tables, num_threads;
+  if (argc != 4 or
+      std::sscanf(argv[1], "%zu", &r) != 1 or
+      std::sscanf(argv[2], "%zu", &num_tables) != 1 or
+      std::sscanf(argv[3], "%zu", &num_threads) != 1 or
+      r == 0 or r > 32 or num_tables < 2 or num_threads == 0)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " <r> <number of tables> <number of threads>\n";
+    return EXIT_FAILURE;
+  }
+  try
+  {
+    /* with s = 0 all hash values are counted */
+    static constexpr const size_t s = 0;
+    const uint64_t r_mask = (~uint64_t(0)) >> (64 - r);
+    std::vector<NtTable> tables(num_tables, NtTable(s, r));
+    std::vector<std::vector<uint16_t>> counts(num_tables,
+                                              std::vector<uint16_t>
+                                                (size_t(1) << r, 0));
+    std::mt19937_64 rng(1);
+    for (size_t idx = 0; idx < num_tables; idx++)
+    {
+      for (size_t num = 0; num < (size_t(1) << r); num++)
+      {
+        const uint64_t hash = rng();
+        tables[idx].add_hash(hash);
+        counts[idx][hash & r_mask]
+          += (counts[idx][hash & r_mask] < count_max);
+      }
+    }
+    printf("# fields: method, r, number of tables, threads, ms\n");
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint16_t> &scalar_merged = counts[0];
+    for (size_t idx = 1; idx < num_tables; idx++)
+    {
+      for (size_t cidx = 0; cidx < scalar_merged.size(); cidx++)
+      {
+        if (scalar_merged[cidx] < count_max - counts[idx][cidx])
+        {
+          scalar_merged[cidx] += counts[idx][cidx];
+        } else
+        {
+          scalar_merged[cidx] = count_max;
+        }
+      }
+    }
+    printf("scalar\t%zu\t%zu\t1\t%.1f\n", r, num_tables, elapsed_ms(start));
+    size_t sum_counts = 0;
+    for (auto count : scalar_merged)
+    {
+      sum_counts += count;
+    }
+    printf("# sum of merged counts\t%zu\n", sum_counts);
+
+    NtTable serial_merged(tables[0]);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t idx = 1; idx < num_tables; idx++)
+    {
+      serial_merged.merge(tables[idx]);
+    }
+    printf("simd\t%zu\t%zu\t1\t%.1f\n", r, num_tables, elapsed_ms(start));
+
+    NtTable parallel_merged(tables[0]);
+    std::vector<const NtTable *> others{};
+    for (size_t idx = 1; idx < num_tables; idx++)
+    {
+      others.push_back(&tables[idx]);
+    }
+    start = std::chrono::high_resolution_clock::now();
+    parallel_merged.merge(others, num_threads);
+    printf("simd_slices\t%zu\t%zu\t%zu\t%.1f\n", r, num_tables, num_threads,
+           elapsed_ms(start));
+    estimates_compare(serial_merged, parallel_merged);
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << argv[0] << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#ifndef OPTIONS_MAIN_HPP
+#define OPTIONS_MAIN_HPP
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include "utilities/cxxopts.hpp"
+
+/* The parts common to the main functions of the test programs whose
+   options are parsed by a class Options with a method parse, which
+   shows the usage by options_usage and throws std::invalid_argument for
+   illegal options, and a method help_option_is_set. */
+
+static inline void options_usage(const cxxopts::Options &options)
+{
+  std::cerr << options.help() << '\n';
+}
+
+/* parses the options and calls run(options) unless the help option was
+   used. Errors are reported with the program name as prefix. Returns the
+   exit code of the program. */
+template<class Options,class Runner>
+static int options_main(int argc, char *argv[], Runner run)
+{
+  Options options{};
+  try
+  {
+    options.parse(argc, argv);
+  }
+  catch (const std::invalid_argument &err)
+  {
+    std::cerr << argv[0] << ": " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  if (options.help_option_is_set())
+  {
+    return EXIT_SUCCESS;
+  }
+  try
+  {
+    run(options);
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << argv[0] << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+#endif
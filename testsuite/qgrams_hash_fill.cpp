@@ -0,0 +1,102 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <format>
+#include "sequences/qgrams_hash_nthash.hpp"
+
+/* checks that the canonical ntHash values delivered by the block
+   interface fill coincide with those delivered by the iterator, for
+   sequences of characters and for sequences of ranks */
+
+template<class HashIterator,typename SequenceBaseType>
+static void check_fill(const std::vector<uint64_t> &expected_fwd,
+                       const std::vector<uint64_t> &expected_rc,
+                       const SequenceBaseType *sequence,
+                       size_t seqlen,
+                       size_t qgram_length,
+                       size_t block_size)
+{
+  HashIterator qgiter(qgram_length, sequence, seqlen);
+  std::vector<uint64_t> fwd_hash_values(block_size),
+                        rc_hash_values(block_size);
+  size_t pos = 0;
+  while (true)
+  {
+    const size_t count = qgiter.fill(fwd_hash_values.data(),
+                                     rc_hash_values.data(), block_size);
+    if (count == 0)
+    {
+      break;
+    }
+    for (size_t idx = 0; idx < count; idx++)
+    {
+      if (pos + idx >= expected_fwd.size() or
+          fwd_hash_values[idx] != expected_fwd[pos + idx] or
+          rc_hash_values[idx] != expected_rc[pos + idx])
+      {
+        throw std::runtime_error(std::format(": q={}, block size {}: "
+                                             "fill differs at position {}",
+                                             qgram_length, block_size,
+                                             pos + idx));
+      }
+    }
+    pos += count;
+  }
+  if (pos != expected_fwd.size())
+  {
+    throw std::runtime_error(std::format(": q={}, block size {}: fill "
+                                         "delivers {} instead of {} values",
+                                         qgram_length, block_size, pos,
+                                         expected_fwd.size()));
+  }
+}
+
+int main(void)
+{
+  static constexpr const uint8_t undefined_rank = 4;
+  try
+  {
+    std::mt19937_64 rng(1);
+    for (size_t seqlen : {1, 8, 1000, 100000})
+    {
+      std::string sequence(seqlen, 'A');
+      std::vector<uint8_t> ranks(seqlen);
+      for (size_t idx = 0; idx < seqlen; idx++)
+      {
+        ranks[idx] = static_cast<uint8_t>(rng() % 4);
+        sequence[idx] = "ACGT"[ranks[idx]];
+      }
+      for (size_t qgram_length : {8, 21, 32})
+      {
+        std::vector<uint64_t> expected_fwd{}, expected_rc{};
+        QgramNtHashIterator4 qgiter(qgram_length, sequence.data(), seqlen);
+        for (auto const &&code_pair : qgiter)
+        {
+          expected_fwd.push_back(std::get<0>(code_pair));
+          expected_rc.push_back(std::get<1>(code_pair));
+        }
+        for (size_t block_size : {1, 7, 256})
+        {
+          check_fill<QgramNtHashIterator4>(expected_fwd, expected_rc,
+                                           sequence.data(), seqlen,
+                                           qgram_length, block_size);
+          check_fill<QgramNtHashIteratorGenericNoTransform<undefined_rank>>
+                    (expected_fwd, expected_rc, ranks.data(), seqlen,
+                     qgram_length, block_size);
+        }
+      }
+    }
+  }
+  catch (const std::exception &err)
+  {
+    std::cerr << "qgrams_hash_fill.x" << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -51,6 +51,14 @@ void SeqReaderOptions::parse(int argc, char **argv)
       cxxopts::value<bool>(mapped_option)->default_value("false"))
      ("s,statistics", "output statistics",
       cxxopts::value<bool>(statistics_option)->default_value("false"));
+  if (not for_fastq)
+  {
+    options.add_options()
+       ("c,chunk_size", "read the input in chunks of complete entries of "
+                        "about the given size, as done for input from "
+                        "pipes; then the input may also be in fastq format",
+        cxxopts::value<size_t>(chunk_size)->default_value("0"));
+  }
   if (for_fastq)
   {
     options.add_options()
@@ -185,6 +193,11 @@ size_t SeqReaderOptions::split_size_get(void) const noexcept
   return split_size;
 }
 
+size_t SeqReaderOptions::chunk_size_get(void) const noexcept
+{
+  return chunk_size;
+}
+
 size_t SeqReaderOptions::num_threads_get(void) const noexcept
 {
   return num_threads;
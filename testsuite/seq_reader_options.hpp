@@ -25,6 +25,7 @@ class SeqReaderOptions
   std::string encoding_type;
   size_t num_threads = 0,
          split_size = 0,
+         chunk_size = 0,
          line_width = 0,
          max_input_files;
   bool for_fastq;
@@ -42,6 +43,7 @@ class SeqReaderOptions
   [[nodiscard]] bool paired_option_is_set(void) const noexcept;
   [[nodiscard]] std::string encoding_type_get(void) const noexcept;
   [[nodiscard]] size_t split_size_get(void) const noexcept;
+  [[nodiscard]] size_t chunk_size_get(void) const noexcept;
   [[nodiscard]] size_t num_threads_get(void) const noexcept;
   [[nodiscard]] size_t line_width_get(void) const noexcept;
   [[nodiscard]] const std::vector<std::string> &
@@ -31,7 +31,9 @@ class SortKeyValuePairsOptions
  private:
   size_t number_of_values;
   size_t num_threads;
-  bool help_option;
+  unsigned int seed;
+  bool help_option,
+       low_byte_keys_option;
   char data_type_option;
   int sort_mode;
   std::string sort_mode_option;
@@ -40,6 +42,8 @@ class SortKeyValuePairsOptions
   SortKeyValuePairsOptions()
     : number_of_values(0)
     , num_threads(size_t(1))
+    , seed(0)
+    , low_byte_keys_option(false)
     , data_type_option('i')
     , sort_mode(0)
     , sort_mode_option("lsb-radix")
@@ -67,6 +71,14 @@ class SortKeyValuePairsOptions
        ("t,num_threads",
         "specify the number of threads",
         cxxopts::value<size_t>(num_threads)->default_value("1"))
+       ("s,seed",
+        "specify the seed of the random number generator, 0 means that "
+        "the seed is derived from the system",
+        cxxopts::value<unsigned int>(seed)->default_value("0"))
+       ("l,low_byte_keys",
+        "for data type p generate keys which, in groups of a few keys, "
+        "only differ in their least significant byte",
+        cxxopts::value<bool>(low_byte_keys_option)->default_value("false"))
        ("h,help", "print usage");
     try
     {
@@ -108,14 +120,14 @@ class SortKeyValuePairsOptions
         throw std::invalid_argument("argument to option -d/--data_type must be "
                                     "i, p, or t");
       }
+      if (low_byte_keys_option and data_type_option != 'p')
+      {
+        throw std::invalid_argument("option -l/--low_byte_keys can only be "
+                                    "used for data type p");
+      }
       if (sort_mode_option == std::string("lsb-radix"))
       {
         sort_mode = 0;
-        if (data_type_option != 'i' && num_threads != size_t(1))
-        {
-          throw std::invalid_argument("option -t/--num_threads can only be "
-                                      "used for data_type i");
-        }
       } else
       {
         if (num_threads != size_t(1))
@@ -154,6 +166,14 @@ class SortKeyValuePairsOptions
   {
     return num_threads;
   }
+  [[nodiscard]] unsigned int seed_get(void) const noexcept
+  {
+    return seed;
+  }
+  [[nodiscard]] bool low_byte_keys_option_is_set(void) const noexcept
+  {
+    return low_byte_keys_option;
+  }
   [[nodiscard]] char data_type_option_get(void) const noexcept
   {
     return data_type_option;
@@ -275,6 +295,21 @@ static inline void show_values(It begin, It end)
 
 using ThisKeyValuePair = KeyValuePair<double, size_t>;
 
+/* a double with the bytes of 1.0, except for the lower 12 bits of the two
+   most significant bytes of the mantissa and the least significant byte,
+   which are taken from random_bits. Hence the keys are distributed over
+   4096 buckets by the most significant bytes and then only differ in
+   their least significant byte. */
+static double low_byte_key(uint64_t random_bits)
+{
+  const uint64_t key_bits = UINT64_C(0x3FF0000000000000) |
+                            ((random_bits & UINT64_C(0xFFF00)) << 32) |
+                            (random_bits & UINT64_C(0xFF));
+  double key;
+  memcpy(&key,&key_bits,sizeof key);
+  return key;
+}
+
 template<class T>
 static void sort_values(unsigned int seed,
                         const char *progname,
@@ -283,7 +318,8 @@ static void sort_values(unsigned int seed,
                         size_t number_of_values,
                         double max_random,
                         int num_sort_bits,
-                        size_t num_threads)
+                        size_t num_threads,
+                        bool low_byte_keys = false)
 {
   std::vector<T> values;
   values.reserve(number_of_values);
@@ -294,7 +330,9 @@ static void sort_values(unsigned int seed,
     const double r = urd_gen.get();
     if constexpr (std::is_same_v<T, ThisKeyValuePair>)
     {
-      values.push_back(T(r,idx));
+      values.push_back(T(low_byte_keys ? low_byte_key(static_cast<uint64_t>(r))
+                                       : r,
+                         idx));
     } else
     {
       if constexpr (std::is_same_v<T, Key2ValuePair>)
@@ -337,7 +375,8 @@ static void sort_values(unsigned int seed,
                                      num_sort_bits,
                                      reinterpret_cast<uint8_t *>(values.data()),
                                      values.size(),
-                                     reversed_byte_order);
+                                     reversed_byte_order,
+                                     num_threads);
     } else
     {
       if constexpr (std::is_same_v<T, Key2ValuePair>)
@@ -349,7 +388,8 @@ static void sort_values(unsigned int seed,
                                        reinterpret_cast<uint8_t *>
                                                        (values.data()),
                                        values.size(),
-                                       false);
+                                       false,
+                                       num_threads);
       } else
       {
         static_assert(sizeof(T) == sizeof(uint64_t));
@@ -434,15 +474,18 @@ int main(int argc, char *argv[])
   }
   const bool show = false;
   const int sort_mode = options.sort_mode_get();
-  const unsigned int seed = 0; /* use some fixed value > 0 for a fixed seed */
+  const unsigned int seed = options.seed_get();
   if (options.data_type_option_get() == 'p')
   {
     static constexpr const int num_sort_bits
       = static_cast<int>(CHAR_BIT * sizeof(double));
+    const bool low_byte_keys = options.low_byte_keys_option_is_set();
     sort_values<ThisKeyValuePair>(seed,argv[0],show,sort_mode,
                               options.number_of_values_get(),
-                              DBL_MAX,num_sort_bits,
-                              size_t(1));
+                              low_byte_keys ? double(1 << 20) : DBL_MAX,
+                              num_sort_bits,
+                              options.num_threads_get(),
+                              low_byte_keys);
   } else
   {
     if (options.data_type_option_get() == 't')
@@ -452,7 +495,7 @@ int main(int argc, char *argv[])
       sort_values<Key2ValuePair>(seed,argv[0],show,sort_mode,
                                  options.number_of_values_get(),
                                  DBL_MAX,num_sort_bits,
-                                 size_t(1));
+                                 options.num_threads_get());
     } else
     {
       assert(options.data_type_option_get() == 'i');
@@ -1,3 +1,4 @@
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
@@ -7,6 +8,7 @@
 #include "sequences/gttl_fasta_generator.hpp"
 #include "sequences/gttl_fastq_generator.hpp"
 #include "sequences/split_files.hpp"
+#include "utilities/parallel_gzip_writer.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -34,12 +36,35 @@ int main(int argc, char *argv[])
       cxxopts::value<size_t>()->default_value("6"))(
       "t,threads",
       "The number of threads to run for GZip compression and file output",
-      cxxopts::value<size_t>()->default_value("1"));
+      cxxopts::value<size_t>()->default_value("1"))(
+      "b,gzip_block_size",
+      "The number of bytes of each block compressed independently",
+      cxxopts::value<size_t>()->default_value(
+        std::to_string(GttlParallelGzipWriter::default_block_size)));
 
   options.parse_positional({"file"});
   options.positional_help("<input file>");
 
-  auto result = options.parse(argc, argv);
+  cxxopts::ParseResult result;
+  size_t gzip_block_size;
+  try
+  {
+    result = options.parse(argc, argv);
+    gzip_block_size = result["gzip_block_size"].as<size_t>();
+    /* each block is handed over to zlib in one call, whose length
+       argument is an unsigned int */
+    if (gzip_block_size == 0 or gzip_block_size > size_t(UINT_MAX))
+    {
+      throw cxxopts::exceptions::exception(
+              "option -b,--gzip_block_size must be positive and at most "
+              + std::to_string(UINT_MAX));
+    }
+  }
+  catch (const cxxopts::exceptions::exception &err)
+  {
+    std::cerr << argv[0] << ": " << err.what() << '\n';
+    exit(EXIT_FAILURE);
+  }
 
   const size_t num_threads = result["threads"].as<size_t>();
 
@@ -112,21 +137,21 @@ int main(int argc, char *argv[])
     {
       split_into_num_files(fasta_gen, output_basename, num_parts,
                            result["compression_level"].as<size_t>(),
-                           num_threads);
+                           num_threads, gzip_block_size);
       return EXIT_SUCCESS;
     }
     if (len_parts != 0)
     {
       split_into_parts_length(fasta_gen, output_basename, len_parts,
                               result["compression_level"].as<size_t>(),
-                              num_threads);
+                              num_threads, 2, gzip_block_size);
       return EXIT_SUCCESS;
     }
     if (num_sequences != 0)
     {
       split_into_num_sequences(fasta_gen, output_basename, num_sequences,
                                result["compression_level"].as<size_t>(),
-                               num_threads);
+                               num_threads, gzip_block_size);
       return EXIT_SUCCESS;
     }
   } else
@@ -138,21 +163,21 @@ int main(int argc, char *argv[])
       {
         split_into_num_files(fastq_gen, output_basename, num_parts,
                              result["compression_level"].as<size_t>(),
-                             num_threads);
+                             num_threads, gzip_block_size);
         return EXIT_SUCCESS;
       }
       if (len_parts != 0)
       {
         split_into_parts_length(fastq_gen, output_basename, len_parts,
                                 result["compression_level"].as<size_t>(),
-                                num_threads);
+                                num_threads, 2, gzip_block_size);
         return EXIT_SUCCESS;
       }
       if (num_sequences != 0)
       {
         split_into_num_sequences(fastq_gen, output_basename, num_sequences,
                                  result["compression_level"].as<size_t>(),
-                                 num_threads);
+                                 num_threads, gzip_block_size);
         return EXIT_SUCCESS;
       }
     }
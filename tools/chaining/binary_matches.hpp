@@ -0,0 +1,395 @@
+#ifndef BINARY_MATCHES_HPP
+#define BINARY_MATCHES_HPP
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <ios>
+#include <string>
+#include <vector>
+#include "utilities/gttl_mmap.hpp"
+#include "utilities/mathsupport.hpp"
+#include "stored_match.hpp"
+
+/* Binary format for matches as processed by chaining.x:
+
+   - a header of 32 bytes consisting of
+     - the magic string GTTLBMF followed by a 0-byte (8 bytes),
+     - the format version (uint32_t),
+     - the number of bits for each of the five components
+       primary_startpos, primary_len, secondary_startpos, secondary_len and
+       weight of a match (5 bytes),
+     - the number of bytes per match (1 byte),
+     - two reserved 0-bytes,
+     - the number of matches (uint64_t),
+     - four reserved 0-bytes,
+   - the matches, each stored in the given number of bytes, in which the
+     five components are stored as consecutive bit groups of the given
+     sizes, starting with the least significant bits,
+   - 8 padding 0-bytes, so that each component can be extracted by
+     one unaligned 8 byte load.
+
+   The number of bits per component is determined from the maximum values,
+   so the matches of most files require between 8 and 14 bytes, while
+   the text format requires about 30 bytes per match. Integers are stored
+   in the byte order of the machine.
+*/
+
+class GttlBinaryMatchLayout
+{
+  public:
+  static constexpr const size_t num_components = 5;
+  static constexpr const size_t header_size = 32;
+  static constexpr const size_t padding_size = sizeof(uint64_t);
+  static constexpr const uint32_t version = 1;
+  static constexpr const char magic[8] = "GTTLBMF";
+
+  private:
+  std::array<uint8_t,num_components> bits;
+  std::array<size_t,num_components> bit_offsets;
+  std::array<uint64_t,num_components> masks;
+  size_t record_size;
+
+  public:
+  explicit GttlBinaryMatchLayout(const std::array<uint8_t,num_components>
+                                   &_bits)
+    : bits(_bits)
+    , bit_offsets({})
+    , masks({})
+    , record_size(0)
+  {
+    size_t offset = 0;
+    for (size_t idx = 0; idx < num_components; idx++)
+    {
+      assert(bits[idx] <= 32);
+      bit_offsets[idx] = offset;
+      masks[idx] = gttl_bits2maxvalue<uint64_t>(bits[idx]);
+      offset += bits[idx];
+    }
+    record_size = std::max(size_t(1),(offset + CHAR_BIT - 1)/CHAR_BIT);
+  }
+
+  /* the layout required to store components with the given maximum
+     values */
+  static GttlBinaryMatchLayout from_max_values(
+                                 const std::array<uint64_t,num_components>
+                                   &max_values)
+  {
+    std::array<uint8_t,num_components> bits{};
+    for (size_t idx = 0; idx < num_components; idx++)
+    {
+      assert(max_values[idx] <= UINT32_MAX);
+      bits[idx] = static_cast<uint8_t>(std::bit_width(max_values[idx]));
+    }
+    return GttlBinaryMatchLayout(bits);
+  }
+
+  [[nodiscard]] size_t record_size_get(void) const noexcept
+  {
+    return record_size;
+  }
+
+  [[nodiscard]] const std::array<uint8_t,num_components> &bits_get(void)
+    const noexcept
+  {
+    return bits;
+  }
+
+  /* add value as component idx to the zero-initialized record. The record
+     must be followed by at least 7 accessible bytes */
+  void encode(uint8_t *record, size_t idx, uint64_t value) const noexcept
+  {
+    assert(value <= masks[idx]);
+    uint8_t *const ptr = record + bit_offsets[idx]/CHAR_BIT;
+    uint64_t word;
+    std::memcpy(&word, ptr, sizeof word);
+    word |= value << (bit_offsets[idx] % CHAR_BIT);
+    std::memcpy(ptr, &word, sizeof word);
+  }
+
+  [[nodiscard]] uint64_t decode(const uint8_t *record, size_t idx)
+    const noexcept
+  {
+    uint64_t word;
+    std::memcpy(&word, record + bit_offsets[idx]/CHAR_BIT, sizeof word);
+    return (word >> (bit_offsets[idx] % CHAR_BIT)) & masks[idx];
+  }
+
+  void header_encode(uint8_t *header, uint64_t num_matches) const noexcept
+  {
+    std::memset(header, 0, header_size);
+    std::memcpy(header, &magic[0], sizeof magic);
+    std::memcpy(header + 8, &version, sizeof version);
+    std::memcpy(header + 12, bits.data(), num_components);
+    header[12 + num_components] = static_cast<uint8_t>(record_size);
+    std::memcpy(header + 20, &num_matches, sizeof num_matches);
+  }
+
+  /* returns true iff the header begins with the magic string */
+  static bool has_magic(const uint8_t *header, size_t size) noexcept
+  {
+    return size >= sizeof magic and
+           std::memcmp(header, &magic[0], sizeof magic) == 0;
+  }
+};
+
+/* Writes matches in the binary format. As the layout of a match depends on
+   the maximum values of the components, these must be known in advance.
+   The number of matches is written into the header when the file
+   is closed by finish, which reports errors by an exception. If finish
+   was not called, the destructor completes the file, ignoring errors. */
+
+class GttlBinaryMatchWriter
+{
+  using Layout = GttlBinaryMatchLayout;
+  static constexpr const size_t records_per_buffer = size_t(1) << 12;
+  std::string outputfile;
+  Layout layout;
+  FILE *out_fp;
+  std::vector<uint8_t> buffer;
+  size_t buffer_records;
+  uint64_t num_matches;
+  bool finish_called;
+
+  void write_bytes(const uint8_t *bytes, size_t size)
+  {
+    if (std::fwrite(bytes, sizeof(uint8_t), size, out_fp) != size)
+    {
+      throw std::ios_base::failure(std::format(": cannot write {} bytes to "
+                                               "file \"{}\"",
+                                               size, outputfile));
+    }
+  }
+
+  void flush(void)
+  {
+    write_bytes(buffer.data(), buffer_records * layout.record_size_get());
+    std::fill(buffer.begin(), buffer.end(), 0);
+    buffer_records = 0;
+  }
+
+  public:
+  GttlBinaryMatchWriter(const std::string &_outputfile,
+                        const Layout &_layout)
+    : outputfile(_outputfile)
+    , layout(_layout)
+    , out_fp(std::fopen(_outputfile.c_str(), "wb"))
+    , buffer(records_per_buffer * _layout.record_size_get()
+             + Layout::padding_size, 0)
+    , buffer_records(0)
+    , num_matches(0)
+    , finish_called(false)
+  {
+    if (out_fp == nullptr)
+    {
+      throw std::ios_base::failure(std::format(": cannot create file \"{}\"",
+                                               outputfile));
+    }
+    std::array<uint8_t,Layout::header_size> header{};
+    layout.header_encode(header.data(), 0);
+    write_bytes(header.data(), header.size());
+  }
+
+  GttlBinaryMatchWriter(const GttlBinaryMatchWriter&) = delete;
+  GttlBinaryMatchWriter& operator=(const GttlBinaryMatchWriter&) = delete;
+
+  void append(const GttlStoredMatch &match)
+  {
+    if (buffer_records == records_per_buffer)
+    {
+      flush();
+    }
+    uint8_t *const record = buffer.data()
+                            + buffer_records * layout.record_size_get();
+    layout.encode(record, 0, match.primary_startpos_get());
+    layout.encode(record, 1, match.primary_len_get());
+    layout.encode(record, 2, match.secondary_startpos_get());
+    layout.encode(record, 3, match.secondary_len_get());
+    layout.encode(record, 4, match.weight_get());
+    buffer_records++;
+    num_matches++;
+  }
+
+  /* writes the buffered matches, the padding and the header with the
+     number of matches and closes the file */
+  void finish(void)
+  {
+    assert(not finish_called);
+    finish_called = true;
+    flush();
+    const std::array<uint8_t,Layout::padding_size> padding{};
+    write_bytes(padding.data(), padding.size());
+    std::array<uint8_t,Layout::header_size> header{};
+    layout.header_encode(header.data(), num_matches);
+    if (std::fseek(out_fp, 0, SEEK_SET) != 0)
+    {
+      throw std::ios_base::failure(std::format(": cannot seek to the header "
+                                               "of file \"{}\"",
+                                               outputfile));
+    }
+    write_bytes(header.data(), header.size());
+    FILE *const closed_fp = out_fp;
+    out_fp = nullptr;
+    if (std::fclose(closed_fp) != 0)
+    {
+      throw std::ios_base::failure(std::format(": cannot close file \"{}\"",
+                                               outputfile));
+    }
+  }
+
+  ~GttlBinaryMatchWriter(void)
+  {
+    if (not finish_called)
+    {
+      try
+      {
+        finish();
+      }
+      catch (const std::ios_base::failure &)
+      {
+        /* the destructor must not throw, errors are only reported by an
+           explicit call of finish */
+      }
+    }
+    if (out_fp != nullptr)
+    {
+      std::fclose(out_fp);
+    }
+  }
+};
+
+/* Write the given vector of matches in binary format, with the layout
+   determined from the maximum values of the components */
+static inline void gttl_binary_matches_write(
+                                 const std::string &outputfile,
+                                 const std::vector<GttlStoredMatch> &matches)
+{
+  std::array<uint64_t,GttlBinaryMatchLayout::num_components> max_values{};
+  for (const auto &match : matches)
+  {
+    max_values[0] = std::max<uint64_t>(max_values[0],
+                                       match.primary_startpos_get());
+    max_values[1] = std::max<uint64_t>(max_values[1],match.primary_len_get());
+    max_values[2] = std::max<uint64_t>(max_values[2],
+                                       match.secondary_startpos_get());
+    max_values[3] = std::max<uint64_t>(max_values[3],
+                                       match.secondary_len_get());
+    max_values[4] = std::max<uint64_t>(max_values[4],match.weight_get());
+  }
+  GttlBinaryMatchWriter writer(outputfile,
+                               GttlBinaryMatchLayout::from_max_values(
+                                 max_values));
+  for (const auto &match : matches)
+  {
+    writer.append(match);
+  }
+  writer.finish();
+}
+
+/* Memory maps a file in binary match format. The matches are decoded on
+   access by operator [], so that the object can be passed to a
+   Chain instead of a vector of matches without copying the matches. */
+
+class GttlBinaryMatchReader
+{
+  using Layout = GttlBinaryMatchLayout;
+  Gttlmmap<uint8_t> mapped_file;
+  Layout layout;
+  const uint8_t *records;
+  size_t num_matches;
+
+  static Layout layout_from_header(const Gttlmmap<uint8_t> &mapped,
+                                   const char *inputfile)
+  {
+    const uint8_t *const header = mapped.ptr();
+    if (mapped.size() < Layout::header_size + Layout::padding_size or
+        not Layout::has_magic(header, mapped.size()))
+    {
+      throw std::ios_base::failure(std::format(": file \"{}\" is not in "
+                                               "binary match format",
+                                               inputfile));
+    }
+    uint32_t version;
+    std::memcpy(&version, header + 8, sizeof version);
+    if (version != Layout::version)
+    {
+      throw std::ios_base::failure(std::format(": file \"{}\" has binary "
+                                               "match format version {}, "
+                                               "but {} is expected",
+                                               inputfile, version,
+                                               Layout::version));
+    }
+    std::array<uint8_t,Layout::num_components> bits{};
+    std::memcpy(bits.data(), header + 12, bits.size());
+    if (std::ranges::any_of(bits, [](uint8_t b) { return b > 32; }))
+    {
+      throw std::ios_base::failure(std::format(": file \"{}\" has corrupt "
+                                               "header",inputfile));
+    }
+    return Layout(bits);
+  }
+
+  public:
+  explicit GttlBinaryMatchReader(const char *inputfile)
+    : mapped_file(inputfile)
+    , layout(layout_from_header(mapped_file, inputfile))
+    , records(mapped_file.ptr() + Layout::header_size)
+    , num_matches(0)
+  {
+    uint64_t stored_num_matches;
+    std::memcpy(&stored_num_matches, mapped_file.ptr() + 20,
+                sizeof stored_num_matches);
+    num_matches = static_cast<size_t>(stored_num_matches);
+    if (mapped_file.ptr()[12 + Layout::num_components]
+          != layout.record_size_get() or
+        mapped_file.size() != Layout::header_size
+                              + num_matches * layout.record_size_get()
+                              + Layout::padding_size)
+    {
+      throw std::ios_base::failure(std::format(": file \"{}\" has {} bytes, "
+                                               "which is inconsistent with "
+                                               "the header",
+                                               inputfile, mapped_file.size()));
+    }
+  }
+
+  /* returns true iff the file begins with the magic string of the
+     binary match format */
+  static bool is_binary_match_file(const char *inputfile)
+  {
+    FILE *const in_fp = std::fopen(inputfile, "rb");
+    if (in_fp == nullptr)
+    {
+      return false;
+    }
+    std::array<uint8_t,sizeof Layout::magic> bytes{};
+    const size_t bytes_read = std::fread(bytes.data(), sizeof(uint8_t),
+                                         bytes.size(), in_fp);
+    std::fclose(in_fp);
+    return Layout::has_magic(bytes.data(), bytes_read);
+  }
+
+  [[nodiscard]] size_t size(void) const noexcept
+  {
+    return num_matches;
+  }
+
+  [[nodiscard]] GttlStoredMatch operator [](size_t idx) const noexcept
+  {
+    assert(idx < num_matches);
+    const uint8_t *const record = records + idx * layout.record_size_get();
+    return GttlStoredMatch(layout.decode(record, 0),
+                           layout.decode(record, 1),
+                           layout.decode(record, 2),
+                           layout.decode(record, 3),
+                           0,
+                           layout.decode(record, 4));
+  }
+};
+#endif
@@ -5,12 +5,61 @@
 #include <string>
 #include <vector>
 #include "utilities/constexpr_for.hpp"
-#include "utilities/gttl_line_generator.hpp"
-#include "utilities/split_string.hpp"
+#include "utilities/field_parser.hpp"
 #include "stored_match.hpp"
+#include "binary_matches.hpp"
 #include "chaining.hpp"
 #include "chaining_opt.hpp"
 
+static std::vector<GttlStoredMatch> text_file2matches(
+                                       const std::string &inputfile)
+{
+  std::vector<GttlStoredMatch> matches{};
+  using MatchLineParser = GttlFieldParser<' ',true,size_t,size_t,size_t,
+                                          size_t,size_t>;
+  GttlFieldsBatchReader<MatchLineParser> reader(inputfile.c_str());
+  while (true)
+  {
+    const auto &batch = reader.next_batch();
+    if (batch.empty())
+    {
+      break;
+    }
+    for (const auto &[start1, end1, start2, end2, weight] : batch)
+    {
+      matches.emplace_back(start1, end1 - start1 + 1,
+                           start2, end2 - start2 + 1,
+                           0,
+                           weight);
+    }
+  }
+  return matches;
+}
+
+/* Matches is either a std::vector<GttlStoredMatch> or a
+   GttlBinaryMatchReader */
+template<class Matches>
+static void chain_matches(const Matches &matches, bool local_option,
+                          bool silent_option)
+{
+  constexpr_for<0,1+1,1>([&](auto compile_time_local_option)
+  {
+    if (compile_time_local_option == local_option)
+    {
+      const Chain<GttlStoredMatch, compile_time_local_option> chaining(matches);
+      std::cout << "# chain: length " << chaining.size()
+                << " score " << chaining.score() << '\n';
+      if (not silent_option)
+      {
+        for (auto idx : chaining)
+        {
+          std::cout << idx << " " << matches[idx].to_string() << '\n';
+        }
+      }
+    }
+  });
+}
+
 int main(int argc, char *argv[])
 {
   ChainingOptions options;
@@ -28,28 +77,31 @@ int main(int argc, char *argv[])
     return EXIT_SUCCESS;
   }
 
-  constexpr const int buf_size = 1U << 14U;
   const std::string inputfile = options.inputfile_get();
   const bool local_option = options.local_option_is_set();
   const bool silent_option = options.silent_option_is_set();
-  std::vector<GttlStoredMatch> matches{};
   try
   {
-    GttlLineGenerator<buf_size> gttl_lg(inputfile.c_str());
-    for(const auto& line : gttl_lg)
+    if (GttlBinaryMatchReader::is_binary_match_file(inputfile.c_str()))
     {
-      std::vector<std::string> vec = gttl_split_string(line, ' ');
-      if (vec.size() != 5)
+      /* the matches are decoded from the memory mapped file on demand */
+      const GttlBinaryMatchReader matches(inputfile.c_str());
+      if (not options.binary_outputfile_get().empty())
       {
-        throw std::runtime_error(": line has " + std::to_string(vec.size())
-                                 + " columns, but 5 are expected");
+        throw std::invalid_argument(": input file is already in binary "
+                                    "match format");
       }
-      matches.emplace_back(std::stoul(vec[0]),
-                           std::stoul(vec[1])-std::stoul(vec[0])+1,
-                           std::stoul(vec[2]),
-                           std::stoul(vec[3])-std::stoul(vec[2])+1,
-                           0,
-                           std::stoul(vec[4]));
+      chain_matches(matches, local_option, silent_option);
+    } else
+    {
+      const std::vector<GttlStoredMatch> matches
+        = text_file2matches(inputfile);
+      if (not options.binary_outputfile_get().empty())
+      {
+        gttl_binary_matches_write(options.binary_outputfile_get(), matches);
+        return EXIT_SUCCESS;
+      }
+      chain_matches(matches, local_option, silent_option);
     }
   }
   catch (const std::exception &err)
@@ -57,22 +109,5 @@ int main(int argc, char *argv[])
     std::cerr << argv[0] << ": " << err.what() << '\n';
     return EXIT_FAILURE;
   }
-
-  constexpr_for<0,1+1,1>([&](auto compile_time_local_option)
-  {
-    if (compile_time_local_option == local_option)
-    {
-      const Chain<GttlStoredMatch, compile_time_local_option> chaining(matches);
-      std::cout << "# chain: length " << chaining.size()
-                << " score " << chaining.score() << '\n';
-      if (not silent_option)
-      {
-        for (auto idx : chaining)
-        {
-          std::cout << idx << " " << matches[idx].to_string() << '\n';
-        }
-      }
-    }
-  });
   return EXIT_SUCCESS;
 }
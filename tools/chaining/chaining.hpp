@@ -27,15 +27,16 @@ class Chain
     {}
   };
 
+  template <class Elements>
   class CmpIds
   {
     private:
-    const std::vector<ElementClass> &elements;
+    const Elements &elements;
     const std::vector<uint32_t> &scores;
 
     public:
     using is_transparent = std::true_type;
-    CmpIds(const std::vector<ElementClass> &_elements,
+    CmpIds(const Elements &_elements,
            const std::vector<uint32_t> &_scores)
       : elements(_elements)
       , scores(_scores)
@@ -106,13 +107,18 @@ class Chain
   };
 
   public:
-  explicit Chain(const std::vector<ElementClass> &elements)
+  /* Elements is a random access container of ElementClass objects,
+     supporting size() and operator []. Besides std::vector<ElementClass>,
+     this may be a view decoding elements stored elsewhere, e.g. in a memory
+     mapped file. */
+  template <class Elements = std::vector<ElementClass>>
+  explicit Chain(const Elements &elements)
   : precursors(elements.size(), undef)
   , scores(elements.size(), 0)
   {
     // BST of element ids
-    const CmpIds cmp_ids(elements, scores);
-    std::set<size_t, CmpIds> status(cmp_ids);
+    const CmpIds<Elements> cmp_ids(elements, scores);
+    std::set<size_t, CmpIds<Elements>> status(cmp_ids);
 
     auto prio = [&] (const size_t id)
                     { return scores[id] - elements[id].gap_score(); };
@@ -7,6 +7,7 @@
 
 ChainingOptions::ChainingOptions(void)
   : inputfiles({})
+  , binary_outputfile({})
   , help_option(false)
   , local_option(false)
   , silent_option(false)
@@ -67,6 +68,9 @@ void ChainingOptions::parse(int argc, char **argv)
     ("s,silent", "do not output the chains but only report their lengths and "
                  "scores",
      cxxopts::value<bool>(silent_option)->default_value("false"))
+    ("b,binary_output", "store the matches in binary match format in the "
+                        "given file and exit, without computing a chain",
+     cxxopts::value<std::string>(binary_outputfile)->default_value(""))
     ("h,help", "print usage");
   try
   {
@@ -116,3 +120,8 @@ const std::string &ChainingOptions::inputfile_get(void)
 {
   return inputfiles[0];
 }
+const std::string &ChainingOptions::binary_outputfile_get(void)
+  const noexcept
+{
+  return binary_outputfile;
+}
@@ -7,6 +7,7 @@ class ChainingOptions
 {
   private:
   std::vector<std::string> inputfiles;
+  std::string binary_outputfile;
   bool help_option,
        local_option,
        silent_option;
@@ -18,5 +19,6 @@ class ChainingOptions
   [[nodiscard]] bool local_option_is_set(void) const noexcept;
   [[nodiscard]] bool silent_option_is_set(void) const noexcept;
   [[nodiscard]] const std::string &inputfile_get(void) const noexcept;
+  [[nodiscard]] const std::string &binary_outputfile_get(void) const noexcept;
 };
 #endif
@@ -1,11 +1,14 @@
 #include <algorithm>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <exception>
+#include <memory>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <format>
 #include "sequences/guess_if_protein_seq.hpp"
 #include "sequences/qgrams_hash_nthash.hpp"
@@ -13,101 +16,194 @@
 #include "utilities/runtime_class.hpp"
 #include "utilities/nttable.hpp"
 #include "utilities/binary_nttable.hpp"
+#include "utilities/hyperloglog_table.hpp"
+#include "utilities/count_min_table.hpp"
 #include "sequences/ntcard.hpp"
+#include "sequences/sequences_chunk_reader.hpp"
 #include "ntcard_opt.hpp"
 
+template<bool split_at_wildcard,class TableClass>
+static TableClass table_enumerate(const NtcardOptions &options,
+                                  bool is_protein,
+                                  size_t qgram_length,
+                                  const TableClass &empty_table,
+                                  GttlSequencesChunkReader *chunk_reader)
+{
+  static constexpr const uint8_t undefined_rank = 0;
+  if (is_protein)
+  {
+    return ntcard_enumerate<split_at_wildcard,
+                            QgramNtHashAAFwdIteratorGeneric<undefined_rank>,
+                            QgramNtHashAAFwdIteratorGenericNoTransform<
+                                                               undefined_rank>,
+                            TableClass,
+                            true>(options.inputfile_get(),
+                                  qgram_length,
+                                  empty_table,
+                                  options.num_threads_get(),
+                                  chunk_reader);
+  }
+  return ntcard_enumerate<split_at_wildcard,
+                          QgramNtHashFwdIteratorGeneric<undefined_rank>,
+                          QgramNtHashFwdIteratorGenericNoTransform<
+                                                             undefined_rank>,
+                          TableClass,
+                          false>(options.inputfile_get(),
+                                 qgram_length,
+                                 empty_table,
+                                 options.num_threads_get(),
+                                 chunk_reader);
+}
+
+/* fills a copy of empty_table for each qgram length in a single pass
+   over the input and calls show_table for each of them */
+template<bool split_at_wildcard,class TableClass,class ShowFunc>
+static void tables_enumerate_show(const NtcardOptions &options,
+                                  bool is_protein,
+                                  const TableClass &empty_table,
+                                  GttlSequencesChunkReader *chunk_reader,
+                                  ShowFunc show_table)
+{
+  const std::vector<size_t> &qgram_lengths = options.qgram_lengths_get();
+  if (qgram_lengths.size() == 1)
+  {
+    const TableClass table
+      = table_enumerate<split_at_wildcard>(options,
+                                           is_protein,
+                                           qgram_lengths[0],
+                                           empty_table,
+                                           chunk_reader);
+    show_table(table);
+  } else
+  {
+    using MultiTable = NtCardMultiTable<TableClass>;
+    const MultiTable empty_multi_table(qgram_lengths, empty_table);
+    const MultiTable multi_table
+      = table_enumerate<split_at_wildcard>(options,
+                                           is_protein,
+                                           empty_multi_table
+                                             .min_qgram_length_get(),
+                                           empty_multi_table,
+                                           chunk_reader);
+    for (size_t idx = 0; idx < multi_table.size(); idx++)
+    {
+      printf("# qgram_length\t%zu\n",multi_table.qgram_length_get(idx));
+      show_table(multi_table.table_get(idx));
+    }
+  }
+}
+
 template<bool split_at_wildcard>
 static void estimate_F_values(const NtcardOptions &options)
 {
-  static constexpr const uint8_t undefined_rank = 0;
+  /* input which can only be read once is read in chunks, and the
+     format is determined from the beginning of the input */
+  std::unique_ptr<GttlSequencesChunkReader> chunk_reader{};
+  if (gttl_is_stream_input(options.inputfile_get()))
+  {
+    chunk_reader = std::make_unique<GttlSequencesChunkReader>
+                                   (options.inputfile_get());
+  }
   const bool is_protein =
-    gttl_likely_fasta_format(options.inputfile_get())
-      ? guess_if_protein_file(options.inputfile_get().c_str())
-      : false;
+    chunk_reader != nullptr
+      ? (chunk_reader->fasta_format_get() and
+         guess_if_protein_fasta_prefix(chunk_reader->pending_get()))
+      : (gttl_likely_fasta_format(options.inputfile_get())
+           ? guess_if_protein_file(options.inputfile_get().c_str())
+           : false);
 
-  if (options.binary_option_is_set())
+  if (options.hll_precision_get() > 0)
   {
-    const BinaryNtTable table = is_protein ?
-                 ntcard_enumerate<split_at_wildcard,
-                                  QgramNtHashAAFwdIteratorGeneric<
-                                                               undefined_rank>,
-                                  QgramNtHashAAFwdIteratorGenericNoTransform<
-                                                               undefined_rank>,
-                                  BinaryNtTable,
-                                  true>(options.inputfile_get(),
-                                        options.qgram_length_get(),
-                                        options.s_get(),
-                                        options.r_get(),
-                                        options.num_threads_get()) :
-                 ntcard_enumerate<split_at_wildcard,
-                                  QgramNtHashFwdIteratorGeneric<
-                                                               undefined_rank>,
-                                  QgramNtHashFwdIteratorGenericNoTransform<
-                                                               undefined_rank>,
-                                  BinaryNtTable,
-                                  false>(options.inputfile_get(),
-                                         options.qgram_length_get(),
-                                         options.s_get(),
-                                         options.r_get(),
-                                         options.num_threads_get());
-    RunTimeClass rt_estimate{};
-    const double F0 = table.estimate_F0();
-    printf("F0\t%.0f\n", F0);
-    printf("F1 (count)\t%zu\n",table.F1_count_get());
-    printf("sequences_number\t%zu\n",table.sequences_number_get());
-    rt_estimate.show("binary.estimate");
-  } else
+    tables_enumerate_show<split_at_wildcard>
+                         (options, is_protein,
+                          HyperLogLogTable(options.hll_precision_get()),
+                          chunk_reader.get(),
+                          [](const HyperLogLogTable &table)
+    {
+      RunTimeClass rt_estimate{};
+      printf("F0\t%.0f\n", table.estimate_F0());
+      printf("F1 (count)\t%zu\n",table.F1_count_get());
+      printf("sequences_number\t%zu\n",table.sequences_number_get());
+      rt_estimate.show("hll.estimate");
+    });
+    return;
+  }
+  if (options.count_min_width_bits_get() > 0)
   {
-    const NtTable table = is_protein ?
-                 ntcard_enumerate<split_at_wildcard,
-                                  QgramNtHashAAFwdIteratorGeneric<
-                                                               undefined_rank>,
-                                  QgramNtHashAAFwdIteratorGenericNoTransform<
-                                                               undefined_rank>,
-                                  NtTable,
-                                  true>(options.inputfile_get(),
-                                        options.qgram_length_get(),
-                                        options.s_get(),
-                                        options.r_get(),
-                                        options.num_threads_get()) :
-                 ntcard_enumerate<split_at_wildcard,
-                                  QgramNtHashFwdIteratorGeneric<
-                                                               undefined_rank>,
-                                  QgramNtHashFwdIteratorGenericNoTransform<
-                                                               undefined_rank>,
-                                  NtTable,
-                                  false>(options.inputfile_get(),
-                                         options.qgram_length_get(),
-                                         options.s_get(),
-                                         options.r_get(),
-                                         options.num_threads_get());
-    RunTimeClass rt_estimate{};
-    if (options.fast_option_is_set())
+    static constexpr const size_t count_min_depth = 4;
+    tables_enumerate_show<split_at_wildcard>
+                         (options, is_protein,
+                          CountMinTable(count_min_depth,
+                                        options.count_min_width_bits_get(),
+                                        options.heavy_hitters_number_get()),
+                          chunk_reader.get(),
+                          [](const CountMinTable &table)
     {
+      RunTimeClass rt_estimate{};
+      for (auto &[hash, count] : table.heavy_hitters_get())
+      {
+        printf("heavy_hitter\t%016" PRIx64 "\t%" PRIu32 "\n", hash, count);
+      }
       printf("F0\t%.0f\n", table.estimate_F0());
       printf("F1 (count)\t%zu\n",table.F1_count_get());
-    } else
+      printf("sequences_number\t%zu\n",table.sequences_number_get());
+      rt_estimate.show("count_min.estimate");
+    });
+    return;
+  }
+  if (options.binary_option_is_set())
+  {
+    tables_enumerate_show<split_at_wildcard>
+                         (options, is_protein,
+                          BinaryNtTable(options.s_get(), options.r_get()),
+                          chunk_reader.get(),
+                          [](const BinaryNtTable &table)
     {
-      const NtTableResult nt_table_result = table.estimate_all();
-      if (options.show_f_option_is_set())
+      RunTimeClass rt_estimate{};
+      const double F0 = table.estimate_F0();
+      printf("F0\t%.0f\n", F0);
+      printf("F1 (count)\t%zu\n",table.F1_count_get());
+      printf("sequences_number\t%zu\n",table.sequences_number_get());
+      rt_estimate.show("binary.estimate");
+    });
+  } else
+  {
+    tables_enumerate_show<split_at_wildcard>
+                         (options, is_protein,
+                          NtTable(options.s_get(), options.r_get()),
+                          chunk_reader.get(),
+                          [&options](const NtTable &table)
+    {
+      RunTimeClass rt_estimate{};
+      if (options.fast_option_is_set())
       {
-        const size_t this_max = std::min(nt_table_result.t_max_get(),
-                                         size_t(999));
-        for (size_t idx = 1; idx <= this_max; idx++)
+        printf("F0\t%.0f\n",
+               table.estimate_F0(options.num_threads_get()));
+        printf("F1 (count)\t%zu\n",table.F1_count_get());
+      } else
+      {
+        const NtTableResult nt_table_result
+          = table.estimate_all(options.num_threads_get());
+        if (options.show_f_option_is_set())
         {
-          const double this_f_value = nt_table_result.f_n_at(idx);
-          printf("f_%zu:\t%f\t%zu\n",
-                  idx, this_f_value,
-                  static_cast<size_t>(std::abs(this_f_value)));
+          const size_t this_max = std::min(nt_table_result.t_max_get(),
+                                           size_t(999));
+          for (size_t idx = 1; idx <= this_max; idx++)
+          {
+            const double this_f_value = nt_table_result.f_n_at(idx);
+            printf("f_%zu:\t%f\t%zu\n",
+                    idx, this_f_value,
+                    static_cast<size_t>(std::abs(this_f_value)));
+          }
         }
+        printf("F0\t%.0f\n",nt_table_result.F0_get());
+        printf("F1 (estimate)\t%.0f\n",nt_table_result.F1_get());
+        printf("F1 (count)\t%zu\n",nt_table_result.F1_count_get());
       }
-      printf("F0\t%.0f\n",nt_table_result.F0_get());
-      printf("F1 (estimate)\t%.0f\n",nt_table_result.F1_get());
-      printf("F1 (count)\t%zu\n",nt_table_result.F1_count_get());
-    }
-    printf("sequences_number\t%zu\n",table.sequences_number_get());
-    rt_estimate.show(options.fast_option_is_set() ? "fast.estimate"
-                                                  : "estimate");
+      printf("sequences_number\t%zu\n",table.sequences_number_get());
+      rt_estimate.show(options.fast_option_is_set() ? "fast.estimate"
+                                                    : "estimate");
+    });
   }
 }
 
@@ -143,8 +239,14 @@ int main(int argc, char **argv)
     std::cerr << argv[0] << ": " << err.what() << '\n';
     return EXIT_FAILURE;
   }
+  const char table_char = options.hll_precision_get() > 0
+                            ? 'h'
+                            : (options.count_min_width_bits_get() > 0
+                                 ? 'c'
+                                 : (options.binary_option_is_set() ? 'b'
+                                                                   : 'n'));
   rt_all.show(std::format("ntcard.all\t{}\t{}\t\t{}",
-                          options.binary_option_is_set() ? 'b' : 'n',
+                          table_char,
                           options.num_threads_get(),
                           options.inputfile_get()));
   return EXIT_SUCCESS;
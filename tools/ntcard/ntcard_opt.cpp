@@ -3,7 +3,9 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <format>
 #include "utilities/cxxopts.hpp"
+#include "utilities/split_string.hpp"
 #include "ntcard_opt.hpp"
 
 static void usage(const cxxopts::Options& options)
@@ -13,15 +15,87 @@ static void usage(const cxxopts::Options& options)
 
 NtcardOptions::NtcardOptions() = default;
 
+static size_t qgram_length_parse(const std::string &arg)
+{
+  size_t pos = 0;
+  size_t value = 0;
+  try
+  {
+    value = std::stoul(arg, &pos);
+  }
+  catch (const std::exception &)
+  {
+    pos = 0;
+  }
+  if (pos == 0 or pos != arg.size() or value == 0)
+  {
+    throw cxxopts::exceptions::exception(
+            std::format("illegal qgram length \"{}\" in argument of option "
+                        "-m,--multiple_qgram_lengths", arg));
+  }
+  return value;
+}
+
+/* parses a comma separated list of qgram lengths or ranges of the form
+   first:last or first:last:step */
+static std::vector<size_t> qgram_lengths_parse(const std::string &arg)
+{
+  std::vector<size_t> qgram_lengths{};
+  for (auto &item : gttl_split_string(arg, ','))
+  {
+    const std::vector<std::string> range = gttl_split_string(item, ':');
+    if (range.size() == 1)
+    {
+      qgram_lengths.push_back(qgram_length_parse(range[0]));
+    } else
+    {
+      if (range.size() > 3)
+      {
+        throw cxxopts::exceptions::exception(
+                std::format("illegal range \"{}\" in argument of option "
+                            "-m,--multiple_qgram_lengths", item));
+      }
+      const size_t first = qgram_length_parse(range[0]);
+      const size_t last = qgram_length_parse(range[1]);
+      const size_t step = range.size() == 3 ? qgram_length_parse(range[2])
+                                            : 1;
+      if (first > last)
+      {
+        throw cxxopts::exceptions::exception(
+                std::format("illegal range \"{}\" in argument of option "
+                            "-m,--multiple_qgram_lengths: first length {} "
+                            "is larger than last length {}", item, first,
+                            last));
+      }
+      for (size_t this_length = first; this_length <= last;
+           this_length += step)
+      {
+        qgram_lengths.push_back(this_length);
+      }
+    }
+  }
+  return qgram_lengths;
+}
+
 void NtcardOptions::parse(int argc, char** argv)
 {
+  std::string qgram_lengths_arg;
   cxxopts::Options options(argv[0], "");
   options.set_width(80);
-  options.custom_help(std::string("[options] inputfile"));
+  options.custom_help(std::string("[options] inputfile (- for stdin)"));
   options.set_tab_expansion();
   options.add_options()
      ("q,qgram_length", "specify qgram_length",
       cxxopts::value<size_t>(qgram_length)->default_value("32"))
+     ("m,multiple_qgram_lengths", "estimate the values for several qgram "
+                                  "lengths in a single pass over the "
+                                  "input, specified by a comma separated "
+                                  "list of lengths or ranges first:last or "
+                                  "first:last:step, e.g. 21:101:10; each "
+                                  "thread uses one table per length; "
+                                  "cannot be combined with option "
+                                  "-q,--qgram_length",
+      cxxopts::value<std::string>(qgram_lengths_arg)->default_value(""))
      ("s", "specify s", cxxopts::value<size_t>(s)->default_value("7"))
      ("r", "specify r", cxxopts::value<size_t>(r)->default_value("27"))
      ("l,long", "Show histogram.",
@@ -32,6 +106,16 @@ void NtcardOptions::parse(int argc, char** argv)
       cxxopts::value<bool>(fast_option)->default_value("false"))
      ("b,binary", "Use binary NtTable.",
       cxxopts::value<bool>(binary_option)->default_value("false"))
+     ("hll", "Estimate F0 with a HyperLogLog sketch of 2^p registers of "
+             "one byte, where p is the argument of this option, e.g. 14.",
+      cxxopts::value<size_t>(hll_precision)->default_value("0"))
+     ("count_min", "Use a count-min sketch with rows of 2^w counters, "
+                   "where w is the argument of this option, e.g. 20, and "
+                   "show the most frequent hash values.",
+      cxxopts::value<size_t>(count_min_width_bits)->default_value("0"))
+     ("heavy_hitters", "Number of most frequent hash values shown for "
+                       "option --count_min.",
+      cxxopts::value<size_t>(heavy_hitters_number)->default_value("10"))
      ("t,threads", "Number of threads to use.",
       cxxopts::value<size_t>(num_threads)->default_value("1"))
      ("h,help", "print usage");
@@ -55,6 +139,40 @@ void NtcardOptions::parse(int argc, char** argv)
         throw cxxopts::exceptions::exception("superfluous input file");
       }
       inputfile = unmatched_args[0];
+      if (static_cast<int>(binary_option) + static_cast<int>(hll_precision > 0)
+          + static_cast<int>(count_min_width_bits > 0) > 1)
+      {
+        throw cxxopts::exceptions::exception(
+                "the options -b,--binary, --hll and --count_min exclude "
+                "each other");
+      }
+      if ((hll_precision > 0 or count_min_width_bits > 0) and
+          result.count("s") + result.count("r") > 0)
+      {
+        throw cxxopts::exceptions::exception(
+                "the options -s and -r only apply to the tables of "
+                "ntCard and cannot be combined with option --hll or "
+                "--count_min");
+      }
+      if (not qgram_lengths_arg.empty() and result.count("qgram_length") > 0)
+      {
+        throw cxxopts::exceptions::exception(
+                "option -m,--multiple_qgram_lengths cannot be combined "
+                "with option -q,--qgram_length");
+      }
+      if (qgram_lengths_arg.empty())
+      {
+        qgram_lengths.push_back(qgram_length);
+      } else
+      {
+        qgram_lengths = qgram_lengths_parse(qgram_lengths_arg);
+        if (qgram_lengths.empty())
+        {
+          throw cxxopts::exceptions::exception(
+                  "option -m,--multiple_qgram_lengths requires at least "
+                  "one qgram length");
+        }
+      }
     }
   }
   catch (const cxxopts::exceptions::exception& e)
@@ -78,10 +196,31 @@ size_t NtcardOptions::qgram_length_get(void) const noexcept
   return qgram_length;
 }
 
+const std::vector<size_t> &NtcardOptions::qgram_lengths_get(void)
+  const noexcept
+{
+  return qgram_lengths;
+}
+
 size_t NtcardOptions::s_get(void) const noexcept { return s; }
 
 size_t NtcardOptions::r_get(void) const noexcept { return r; }
 
+size_t NtcardOptions::hll_precision_get(void) const noexcept
+{
+  return hll_precision;
+}
+
+size_t NtcardOptions::count_min_width_bits_get(void) const noexcept
+{
+  return count_min_width_bits;
+}
+
+size_t NtcardOptions::heavy_hitters_number_get(void) const noexcept
+{
+  return heavy_hitters_number;
+}
+
 bool NtcardOptions::show_f_option_is_set(void) const noexcept
 {
   return show_f_option;
@@ -2,14 +2,19 @@
 #define NTCARD_OPT_HPP
 #include <cstddef>
 #include <string>
+#include <vector>
 
 class NtcardOptions
 {
   private:
     std::string inputfile;
     size_t qgram_length;
+    std::vector<size_t> qgram_lengths;
     size_t s;
     size_t r;
+    size_t hll_precision;
+    size_t count_min_width_bits;
+    size_t heavy_hitters_number;
     bool show_f_option;
     bool fast_option;
     bool binary_option;
@@ -22,8 +27,13 @@ class NtcardOptions
     void parse(int argc, char **argv);
     [[nodiscard]] const std::string &inputfile_get(void) const noexcept;
     [[nodiscard]] size_t qgram_length_get(void) const noexcept;
+    [[nodiscard]] const std::vector<size_t> &qgram_lengths_get(void)
+                                               const noexcept;
     [[nodiscard]] size_t s_get(void) const noexcept;
     [[nodiscard]] size_t r_get(void) const noexcept;
+    [[nodiscard]] size_t hll_precision_get(void) const noexcept;
+    [[nodiscard]] size_t count_min_width_bits_get(void) const noexcept;
+    [[nodiscard]] size_t heavy_hitters_number_get(void) const noexcept;
     [[nodiscard]] bool show_f_option_is_set(void) const noexcept;
     [[nodiscard]] bool fast_option_is_set(void) const noexcept;
     [[nodiscard]] bool binary_option_is_set(void) const noexcept;
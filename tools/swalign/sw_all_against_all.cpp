@@ -15,6 +15,7 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+#include <charconv>
 #include <cstdint>
 #include <exception>
 #include <stdexcept>
@@ -29,13 +30,12 @@
 #include <utility>
 #include <algorithm>
 #include <iostream>
-#include <cinttypes>
+#include <system_error>
 #include <vector>
 #include "utilities/matrix_partition.hpp"
 #include "utilities/runtime_class.hpp"
 #include "utilities/all_vs_all2.hpp"
-#include "utilities/gttl_line_generator.hpp"
-#include "utilities/split_string.hpp"
+#include "utilities/field_parser.hpp"
 #include "utilities/string_of_digits.hpp"
 #include "threading/thread_pool_var.hpp"
 #include "sequences/gttl_multiseq.hpp"
@@ -49,18 +49,18 @@
 class Restrict2Pairs
 {
   using HeaderID2idx = std::unordered_map<std::string,uint32_t>;
-  uint32_t convert_header(HeaderID2idx &header_id2idx,const std::string &s)
+  uint32_t convert_header(HeaderID2idx &header_id2idx,std::string_view s)
     const
   {
     if (string_of_digits(s))
     {
-      uint32_t number;
-      [[maybe_unused]] const int ret =
-                                   std::sscanf(s.c_str(), "%" PRIu32, &number);
-      assert(ret == 1);
+      uint32_t number = 0;
+      [[maybe_unused]] const auto ret
+        = std::from_chars(s.data(), s.data() + s.size(), number);
+      assert(ret.ec == std::errc());
       return number;
     }
-    return header_id2idx[s];
+    return header_id2idx[std::string(s)];
   }
   struct HashPair
   {
@@ -96,16 +96,20 @@ class Restrict2Pairs
                                      const char *inputfile) const
   {
     SetOfPairs local_pairs{};
-    constexpr const int buf_size = 1 << 14;
-    GttlLineGenerator<buf_size> gttl_lg(inputfile);
-    for (const auto& line : gttl_lg)
+    using PairLineParser = GttlFieldParser<'\t',false,std::string_view,
+                                           std::string_view>;
+    GttlFieldsBatchReader<PairLineParser> reader(inputfile);
+    while (true)
     {
-      if (not line.empty() and line[0] != '#')
+      const auto &batch = reader.next_batch();
+      if (batch.empty())
       {
-        std::vector<std::string> vec = gttl_split_string(line, '\t');
-        assert(vec.size() >= 2);
-        const uint32_t i = convert_header(db_header_id2idx,vec[0]);
-        const uint32_t j = convert_header(query_header_id2idx,vec[1]);
+        break;
+      }
+      for (const auto &[db_id, query_id] : batch)
+      {
+        const uint32_t i = convert_header(db_header_id2idx,db_id);
+        const uint32_t j = convert_header(query_header_id2idx,query_id);
         local_pairs.insert(std::make_pair(i,j));
       }
     }
@@ -57,55 +57,88 @@ int main(int argc, char *argv[])
   size_t qgram_length_max = 0;
   try
   {
-    if (options.qgram_length_max_get() > 0)
+    const size_t alphabetsize = guessed_protein_sequences ? size_t{20}
+                                                          : size_t{4};
+    const int buf_size = size_t{1} << size_t{14};
+    if (options.single_pass_option_is_set())
     {
-      qgram_length_max = options.qgram_length_max_get();
+      /* the sequences are read only once and the length of the unwords
+         is bounded by their total length instead of the file sizes */
+      RunTimeClass rt_unwords_finder{};
+      GttlFastAGenerator<buf_size> gttl_si(&inputfiles);
+      std::vector<std::string> sequences{};
+      size_t sequences_length = 0;
+      for (const auto *si : gttl_si)
+      {
+        sequences.emplace_back(si->sequence_get());
+        sequences_length += sequences.back().size();
+      }
+      qgram_length_max
+        = options.qgram_length_max_get() > 0
+            ? options.qgram_length_max_get()
+            : estimate_qgram_length_max(
+                options.ignore_reverse_complement_option_is_set()
+                  ? sequences_length
+                  : 2 * sequences_length,
+                alphabetsize);
+      unwords = unwords_single_pass_finder(
+                  guessed_protein_sequences,
+                  !options.ignore_reverse_complement_option_is_set(),
+                  qgram_length_max,
+                  sequences,
+                  options.num_threads_get(),
+                  options.chunk_length_get());
+      rt_unwords_finder.show(std::format("total with {} threads",
+                                         options.num_threads_get()));
     } else
     {
-      const size_t alphabetsize = guessed_protein_sequences ? size_t{20}
-                                                            : size_t{4};
-      size_t upperbound_sequence_length;
-      if (options.ignore_reverse_complement_option_is_set())
+      if (options.qgram_length_max_get() > 0)
       {
-        assert(!guessed_protein_sequences);
-        upperbound_sequence_length = gttl_file_size(inputfiles);
+        qgram_length_max = options.qgram_length_max_get();
       } else
       {
-        upperbound_sequence_length = 2 * gttl_file_size(inputfiles);
+        size_t upperbound_sequence_length;
+        if (options.ignore_reverse_complement_option_is_set())
+        {
+          assert(!guessed_protein_sequences);
+          upperbound_sequence_length = gttl_file_size(inputfiles);
+        } else
+        {
+          upperbound_sequence_length = 2 * gttl_file_size(inputfiles);
+        }
+        qgram_length_max = estimate_qgram_length_max(upperbound_sequence_length,
+                                                     alphabetsize);
       }
-      qgram_length_max = estimate_qgram_length_max(upperbound_sequence_length,
-                                                   alphabetsize);
-    }
-    RunTimeClass rt_unwords_finder{};
-    const int buf_size = size_t{1} << size_t{14};
-    GttlFastAGenerator<buf_size> gttl_si(&inputfiles);
-    if (options.store_sequences_option_is_set())
-    {
-      RunTimeClass rt_sequence_storing{};
-      std::vector<GttlFastAEntry<buf_size>> sequences{};
-      for (const auto *si : gttl_si)
+      RunTimeClass rt_unwords_finder{};
+      GttlFastAGenerator<buf_size> gttl_si(&inputfiles);
+      if (options.store_sequences_option_is_set())
+      {
+        RunTimeClass rt_sequence_storing{};
+        std::vector<GttlFastAEntry<buf_size>> sequences{};
+        for (const auto *si : gttl_si)
+        {
+          sequences.emplace_back(std::string(""),
+                                 std::string(si->sequence_get()));
+        }
+        rt_sequence_storing.show(std::format("storing {} sequences",
+                                             sequences.size()));
+        unwords = unwords_finder<std::vector<GttlFastAEntry<buf_size>>>
+                                (guessed_protein_sequences,
+                                 !options
+                                   .ignore_reverse_complement_option_is_set(),
+                                 qgram_length_max,
+                                 sequences);
+      } else
       {
-        sequences.emplace_back(std::string(""),
-                               std::string(si->sequence_get()));
+        unwords = unwords_finder<GttlFastAGenerator<buf_size>>
+                                (guessed_protein_sequences,
+                                 !options
+                                   .ignore_reverse_complement_option_is_set(),
+                                 qgram_length_max,
+                                 gttl_si);
       }
-      rt_sequence_storing.show(std::format("storing {} sequences",
-                                           sequences.size()));
-      unwords = unwords_finder<std::vector<GttlFastAEntry<buf_size>>>
-                              (guessed_protein_sequences,
-                               !options
-                                 .ignore_reverse_complement_option_is_set(),
-                               qgram_length_max,
-                               sequences);
-    } else
-    {
-      unwords = unwords_finder<GttlFastAGenerator<buf_size>>
-                              (guessed_protein_sequences,
-                               !options
-                                 .ignore_reverse_complement_option_is_set(),
-                               qgram_length_max,
-                               gttl_si);
+      rt_unwords_finder.show("total");
     }
-    rt_unwords_finder.show("total");
   }
   catch (const std::exception &err)
   {
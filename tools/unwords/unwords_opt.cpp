@@ -9,9 +9,12 @@
 UnwordsOptions::UnwordsOptions(void)
   : inputfiles({})
   , qgram_length_max(0)
+  , num_threads(1)
+  , chunk_length(size_t{1} << 20)
   , help_option(false)
   , ignore_reverse_complement_option(false)
   , store_sequences_option(false)
+  , single_pass_option(false)
 {}
 
 void UnwordsOptions::parse(int argc, char **argv)
@@ -33,6 +36,20 @@ void UnwordsOptions::parse(int argc, char **argv)
                           "and again",
      cxxopts::value<bool>(store_sequences_option)->default_value("false"))
 
+    ("p,single_pass", "store the sequences and determine the unwords of "
+                      "all lengths in one pass over the sequences, "
+                      "instead of a binary search over the lengths",
+     cxxopts::value<bool>(single_pass_option)->default_value("false"))
+
+    ("t,num_threads", "specify the number of threads; only used with "
+                      "option -p,--single_pass",
+     cxxopts::value<size_t>(num_threads)->default_value("1"))
+
+    ("chunk_length", "specify the number of positions of the sequences "
+                     "distributed as one task over the threads; only "
+                     "used with option -p,--single_pass",
+     cxxopts::value<size_t>(chunk_length)->default_value("1048576"))
+
     ("h,help", "print usage");
   try
   {
@@ -52,6 +69,26 @@ void UnwordsOptions::parse(int argc, char **argv)
     {
       throw cxxopts::exceptions::exception("not enough inputfiles");
     }
+    if (num_threads == 0)
+    {
+      throw cxxopts::exceptions::exception("argument to option "
+                                           "-t/--num_threads must be "
+                                           "positive");
+    }
+    if (not single_pass_option and
+        (result.count("num_threads") > 0 or
+         result.count("chunk_length") > 0))
+    {
+      throw cxxopts::exceptions::exception("options -t/--num_threads and "
+                                           "--chunk_length require option "
+                                           "-p/--single_pass");
+    }
+    if (chunk_length == 0)
+    {
+      throw cxxopts::exceptions::exception("argument to option "
+                                           "--chunk_length must be "
+                                           "positive");
+    }
   }
   catch (const cxxopts::exceptions::exception &e)
   {
@@ -79,11 +116,26 @@ bool UnwordsOptions::store_sequences_option_is_set(void) const noexcept
   return store_sequences_option;
 }
 
+bool UnwordsOptions::single_pass_option_is_set(void) const noexcept
+{
+  return single_pass_option;
+}
+
 size_t UnwordsOptions::qgram_length_max_get(void) const noexcept
 {
   return qgram_length_max;
 }
 
+size_t UnwordsOptions::num_threads_get(void) const noexcept
+{
+  return num_threads;
+}
+
+size_t UnwordsOptions::chunk_length_get(void) const noexcept
+{
+  return chunk_length;
+}
+
 const std::vector<std::string> &UnwordsOptions::inputfiles_get(void)
   const noexcept
 {
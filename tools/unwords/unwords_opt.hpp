@@ -8,10 +8,13 @@ class UnwordsOptions
 {
   private:
   std::vector<std::string> inputfiles;
-  size_t qgram_length_max;
+  size_t qgram_length_max,
+         num_threads,
+         chunk_length;
   bool help_option,
        ignore_reverse_complement_option,
-       store_sequences_option;
+       store_sequences_option,
+       single_pass_option;
 
   public:
   UnwordsOptions(void);
@@ -20,7 +23,10 @@ class UnwordsOptions
   [[nodiscard]] bool
   ignore_reverse_complement_option_is_set(void) const noexcept;
   [[nodiscard]] bool store_sequences_option_is_set(void) const noexcept;
+  [[nodiscard]] bool single_pass_option_is_set(void) const noexcept;
   [[nodiscard]] size_t qgram_length_max_get(void) const noexcept;
+  [[nodiscard]] size_t num_threads_get(void) const noexcept;
+  [[nodiscard]] size_t chunk_length_get(void) const noexcept;
   [[nodiscard]] const std::vector<std::string> &
   inputfiles_get(void) const noexcept;
 };